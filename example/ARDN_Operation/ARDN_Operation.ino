@@ -71,12 +71,18 @@
 
 #include "JointPositionUnion.h"
 
+#include "JointPositionDelta.h"
+
+#include "JointState32.h"
+
 #include "SUPER.h"
 
 #include "BusConfig.h"
 
 #include "Robko01.h"
 
+#include "Settings.h"
+
 //#include "DebugPort.h"
 
 #include "OperationsCodes.h"
@@ -136,6 +142,30 @@ int SafetyStopFlag_g;
  */
 JointPositionUnion CurrentPositions_g;
 
+/**
+ * @brief Delta encoder of the position telemetry.
+ * 
+ */
+JointPositionDelta TelemetryDelta_g;
+
+/**
+ * @brief Delta decoder of the absolute move commands.
+ * 
+ */
+JointPositionDelta CommandDelta_g;
+
+/**
+ * @brief Curent joint state, 32 bit version.
+ * 
+ */
+JointState32Union CurrentState32_g;
+
+/**
+ * @brief Motors enabled by the accepted commands, the next slot executes them.
+ * 
+ */
+bool MotorsEnabled_g;
+
 #pragma endregion
 
 /**
@@ -168,6 +198,31 @@ void setup()
 
 	// Initialize the robot controller.
 	Robko01.init(&config);
+	MotorsEnabled_g = Robko01.motors_enabled();
+
+	// Settings of the last start, the defaults without a valid record.
+	RobotLimits_t LimitsL;
+	Settings.load(LimitsL);
+
+	// Every joint at its own limits, zero fields keep the defaults.
+	for (uint8_t axis = 0; axis < AXIS_COUNT; axis++)
+	{
+		Robko01.set_axis_limits(axis, LimitsL.Axis[axis]);
+	}
+	Robko01.set_limit_mode(Settings.get().LimitMode);
+
+#if !defined(SLOW)
+	// Slot period of the last calibration, measured on the first start.
+	if (Settings.valid() && (Settings.get().UpdateRate != 0))
+	{
+		Robko01.set_update_rate(Settings.get().UpdateRate);
+	}
+	else
+	{
+		Settings.get().UpdateRate = Robko01.calibrate_update_rate();
+		Settings.save(Robko01.get_limits());
+	}
+#endif
 
 	// Initialize the communication port.
 	COM_PORT.begin(COM_BAUDRATE);
@@ -237,32 +292,62 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 	}
 	else if (opcode == OpCodes::Stop)
 	{
-		Robko01.stop_motors();
+		// Optional StopModes value, decelerate without it.
+		uint8_t ModeL = StopModes::StopDecelerate;
+		if (size == 2)
+		{
+			ModeL = payload[0];
+		}
+		if ((size > 2) || (ModeL > StopModes::StopSegment))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		if (Robko01.post(MotionCommands::CmdStop, ModeL) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
 
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
 	}
 	else if (opcode == OpCodes::Disable)
 	{
-		Robko01.disable_motors();
+		if (Robko01.post(MotionCommands::CmdDisable) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+		MotorsEnabled_g = false;
 
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
 	}
 	else if (opcode == OpCodes::Enable)
 	{
-		Robko01.enable_motors();
+		if (Robko01.post(MotionCommands::CmdEnable) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+		MotorsEnabled_g = true;
 
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
 	}
 	else if (opcode == OpCodes::Clear)
 	{
-		Robko01.clear_motors();
+		if (Robko01.post(MotionCommands::CmdClear) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
 
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
 	}
 	else if (opcode == OpCodes::MoveRelative)
 	{
 		// If it is not enabled, do not execute.
-		if (Robko01.motors_enabled() == false)
+		if (MotorsEnabled_g == false)
 		{
 			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
 			return;
@@ -276,6 +361,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// TODO: Move to function.
 		JointPositionUnion Motion;
 		size_t DataLengthL = sizeof(JointPosition_t);
@@ -284,8 +376,26 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			Motion.Buffer[index] = payload[index];
 		}
 
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(MotionCommands::CmdMoveRelative, Motion.Value))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
+		// Refuse targets outside the soft limits, or clamp them.
+		if (Robko01.accept_move(MotionCommands::CmdMoveRelative, Motion.Value) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::OutOfRange, NULL, 0);
+			return;
+		}
+
 		// Set motion data.
-		Robko01.move_relative(Motion.Value);
+		if (Robko01.post(MotionCommands::CmdMoveRelative, Motion.Value) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
 
 		// Respond with success.
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -293,7 +403,7 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 	else if (opcode == OpCodes::MoveAbsolute)
 	{
 		// If it is not enabled, do not execute.
-		if (Robko01.motors_enabled() == false)
+		if (MotorsEnabled_g == false)
 		{
 			// Respond with error.
 			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
@@ -313,6 +423,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// Extract motion data.
 		JointPositionUnion Motion;
 		size_t DataLengthL = sizeof(JointPosition_t);
@@ -321,8 +438,32 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			Motion.Buffer[index] = payload[index];
 		}
 
+		// The client encodes the next delta against what it sent, not the clamped target.
+		JointPosition_t SentL = Motion.Value;
+
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(MotionCommands::CmdMoveAbsolute, Motion.Value))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
+		// Refuse targets outside the soft limits, or clamp them.
+		if (Robko01.accept_move(MotionCommands::CmdMoveAbsolute, Motion.Value) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::OutOfRange, NULL, 0);
+			return;
+		}
+
 		// Set motion data.
-		Robko01.move_absolute(Motion.Value);
+		if (Robko01.post(MotionCommands::CmdMoveAbsolute, Motion.Value) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// Next delta encoded command is relative to this one.
+		CommandDelta_g.set_reference(SentL);
 
 		// Respond with success.
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -330,7 +471,11 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 	else if (opcode == OpCodes::DO)
 	{
 		// Set port A.
-		Robko01.set_port_a(payload[0]);
+		if (Robko01.post(MotionCommands::CmdSetPortA, payload[0]) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
 
 		
 
@@ -368,23 +513,740 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 		// Respond with success.
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, CurrentPositions_g.Buffer, sizeof(JointPosition_t));
 	}
+	else if (opcode == OpCodes::CurrentPositionDelta)
+	{
+		// Client lost the last response, start over from zero.
+		if ((size > 1) && (payload[0] & 0x01))
+		{
+			TelemetryDelta_g.reset();
+		}
+
+		CurrentPositions_g.Value = Robko01.get_position();
+
+		uint8_t m_payloadResponse[sizeof(JointPosition_t) + 1];
+		uint8_t LengthL = TelemetryDelta_g.encode(CurrentPositions_g.Value, &m_payloadResponse[1], sizeof(JointPosition_t) - 1);
+		if (LengthL == 0)
+		{
+			// Delta is not shorter, send the full state.
+			m_payloadResponse[0] = JointPositionFormats::JposFull;
+			memcpy(&m_payloadResponse[1], CurrentPositions_g.Buffer, sizeof(JointPosition_t));
+			LengthL = sizeof(JointPosition_t);
+		}
+		else
+		{
+			m_payloadResponse[0] = JointPositionFormats::JposDelta;
+		}
+
+		// Next request acknowledges this response.
+		TelemetryDelta_g.set_reference(CurrentPositions_g.Value);
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, LengthL + 1);
+	}
+	else if (opcode == OpCodes::MoveAbsoluteDelta)
+	{
+		// If it is not enabled, do not execute.
+		if (MotorsEnabled_g == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+		// If it is move, do not execute the command.
+		if (MotorState_g != 0)
+		{
+			uint8_t m_payloadResponse[1] = { MotorState_g };
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+			return;
+		}
+
+		// Extract motion data.
+		JointPosition_t Motion;
+		if (CommandDelta_g.decode(payload, size - 1, Motion) == 0)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// The client encodes the next delta against what it sent, not the clamped target.
+		JointPosition_t SentL = Motion;
+
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(MotionCommands::CmdMoveAbsolute, Motion))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
+		// Refuse targets outside the soft limits, or clamp them.
+		if (Robko01.accept_move(MotionCommands::CmdMoveAbsolute, Motion) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::OutOfRange, NULL, 0);
+			return;
+		}
+
+		// Set motion data.
+		if (Robko01.post(MotionCommands::CmdMoveAbsolute, Motion) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// Next delta encoded command is relative to this one.
+		CommandDelta_g.set_reference(SentL);
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
+	}
+	else if ((opcode == OpCodes::MoveRelative32) || (opcode == OpCodes::MoveAbsolute32))
+	{
+		// If it is not enabled, do not execute.
+		if (MotorsEnabled_g == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+		// If it is move, do not execute the command.
+		if (MotorState_g != 0)
+		{
+			uint8_t m_payloadResponse[1] = { MotorState_g };
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+			return;
+		}
+		// The 32 bit state has no optional fields.
+		if ((size - 1) != sizeof(JointState32_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Extract motion data.
+		JointState32_t StateL;
+		ConvertJstate2Buff(StateL, payload);
+
+		uint8_t TypeL = (opcode == OpCodes::MoveRelative32) ? MotionCommands::CmdMoveRelative32 : MotionCommands::CmdMoveAbsolute32;
+
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(TypeL, StateL))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
+		// Refuse targets outside the soft limits, or clamp them.
+		if (Robko01.accept_move(TypeL, StateL) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::OutOfRange, NULL, 0);
+			return;
+		}
+
+		// Set motion data.
+		if (Robko01.post(TypeL, StateL) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
+	}
+	else if (opcode == OpCodes::CurrentPosition32)
+	{
+		CurrentState32_g.Value = Robko01.get_state32();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, CurrentState32_g.Buffer, sizeof(JointState32_t));
+	}
+	else if (opcode == OpCodes::BusTraceControl)
+	{
+#ifdef ENABLE_BUS_TRACE
+		if (size < 2)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		BusTraceClass &TraceL = Robko01.bus_trace();
+		if (payload[0] & BusTraceFlags::TraceClear)
+		{
+			TraceL.clear();
+		}
+		TraceL.enable((payload[0] & BusTraceFlags::TraceEnable) != 0);
+
+		// The debug port shares the serial line with SUPER, dump is not available.
+
+		// Respond with the record count and the overwritten count.
+		uint16_t CountL = TraceL.count();
+		uint32_t OverwrittenL = TraceL.overwritten();
+		uint8_t m_payloadResponse[6];
+		memcpy(&m_payloadResponse[0], &CountL, sizeof(CountL));
+		memcpy(&m_payloadResponse[2], &OverwrittenL, sizeof(OverwrittenL));
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, sizeof(m_payloadResponse));
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::BusTraceRead)
+	{
+#ifdef ENABLE_BUS_TRACE
+		if (size < 3)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Records from the offset, oldest first, after the total count.
+		uint16_t OffsetL = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+		uint16_t CountL = Robko01.bus_trace().count();
+		uint8_t m_payloadResponse[FRAME_MAX_DATA_LEN];
+		memcpy(&m_payloadResponse[0], &CountL, sizeof(CountL));
+		uint8_t RecordsL = Robko01.bus_trace().read(OffsetL, &m_payloadResponse[2], sizeof(m_payloadResponse) - 2);
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 2 + RecordsL * BUS_TRACE_RECORD_LEN);
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::Stats)
+	{
+		// Flags and page.
+		if (size < 3)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		uint8_t m_payloadResponse[1 + STATS_OPCODES_PER_PAGE * sizeof(SUPEROpcodeStats_t)];
+		uint8_t LengthL = 0;
+		if (payload[1] == StatsPages::StatsGeneral)
+		{
+			Robko01Stats_t RobotStatsL = Robko01.get_stats();
+			SUPERStats_t SuperStatsL = SUPER.get_stats();
+			memcpy(&m_payloadResponse[0], &RobotStatsL, sizeof(Robko01Stats_t));
+			memcpy(&m_payloadResponse[sizeof(Robko01Stats_t)], &SuperStatsL, sizeof(SUPERStats_t));
+			LengthL = sizeof(Robko01Stats_t) + sizeof(SUPERStats_t);
+		}
+#ifdef SUPER_OPCODE_STATS
+		else if (payload[1] == StatsPages::StatsOpcodes)
+		{
+			// First opcode of the page, defaults to the first one.
+			uint8_t FirstL = (size > 3) ? payload[2] : 0;
+			m_payloadResponse[0] = FirstL;
+			LengthL = 1;
+			for (uint8_t index = 0; index < STATS_OPCODES_PER_PAGE; index++)
+			{
+				SUPEROpcodeStats_t OpcodeStatsL = SUPER.get_opcode_stats(FirstL + index);
+				memcpy(&m_payloadResponse[LengthL], &OpcodeStatsL, sizeof(SUPEROpcodeStats_t));
+				LengthL += sizeof(SUPEROpcodeStats_t);
+			}
+		}
+#endif
+		else if (payload[1] == StatsPages::StatsStop)
+		{
+			StopStats_t StopStatsL = Robko01.stop_inputs().get_stats();
+			memcpy(&m_payloadResponse[0], &StopStatsL, sizeof(StopStats_t));
+			LengthL = sizeof(StopStats_t);
+		}
+		else
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		if (payload[0] & StatsFlags::StatsReset)
+		{
+			Robko01.reset_stats();
+			Robko01.stop_inputs().reset_stats();
+			SUPER.reset_stats();
+		}
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, LengthL);
+	}
+	else if (opcode == OpCodes::FrameTraceControl)
+	{
+#ifdef SUPER_TRACE
+		if (size < 2)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		FrameTraceClass &TraceL = SUPER.trace();
+		if (payload[0] & FrameTraceFlags::FrameTraceClear)
+		{
+			TraceL.clear();
+		}
+		TraceL.enable((payload[0] & FrameTraceFlags::FrameTraceEnable) != 0,
+			(payload[0] & FrameTraceFlags::FrameTraceStopOnError) != 0);
+
+		// The debug port shares the serial line with SUPER, dump is not available.
+
+		// Respond with the record count and the overwritten count.
+		uint16_t CountL = TraceL.count();
+		uint32_t OverwrittenL = TraceL.overwritten();
+		uint8_t m_payloadResponse[6];
+		memcpy(&m_payloadResponse[0], &CountL, sizeof(CountL));
+		memcpy(&m_payloadResponse[2], &OverwrittenL, sizeof(OverwrittenL));
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, sizeof(m_payloadResponse));
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::FrameTraceRead)
+	{
+#ifdef SUPER_TRACE
+		if (size < 3)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Records from the offset, oldest first, after the total count.
+		uint16_t OffsetL = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+		uint16_t CountL = SUPER.trace().count();
+		uint8_t m_payloadResponse[FRAME_MAX_DATA_LEN];
+		memcpy(&m_payloadResponse[0], &CountL, sizeof(CountL));
+		uint8_t RecordsL = SUPER.trace().read(OffsetL, &m_payloadResponse[2], sizeof(m_payloadResponse) - 2);
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 2 + RecordsL * FRAME_TRACE_RECORD_LEN);
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::UpdateRate)
+	{
+		// Flags, then the period with UpdateRateSet.
+		if ((size < 2) || ((payload[0] & UpdateRateFlags::UpdateRateSet) && (size < 6)))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// The flash write stalls the bus, never in the middle of a move.
+		if ((payload[0] & UpdateRateFlags::UpdateRateSave) && (MotorState_g != 0))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// Applied at the next slot boundary, a later read shows the result.
+		if (payload[0] & (UpdateRateFlags::UpdateRateSet | UpdateRateFlags::UpdateRateCalibrate))
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			if (payload[0] & UpdateRateFlags::UpdateRateSet)
+			{
+				CommandL.Type = MotionCommands::CmdSetUpdateRate;
+				memcpy(&CommandL.Period, &payload[1], sizeof(CommandL.Period));
+			}
+			else
+			{
+				CommandL.Type = MotionCommands::CmdCalibrate;
+			}
+
+			if (Robko01.post(CommandL) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+		}
+
+		if (payload[0] & UpdateRateFlags::UpdateRateSave)
+		{
+			Settings.get().UpdateRate = Robko01.get_update_rate();
+			if (Settings.save(Robko01.get_limits()) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+				return;
+			}
+		}
+
+		Robko01Timing_t TimingL = Robko01.get_timing();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&TimingL, sizeof(Robko01Timing_t));
+	}
+	else if (opcode == OpCodes::Override)
+	{
+		// Global, then up to AXIS_COUNT axis overrides, 0 leaves one as it is.
+		uint8_t LengthL = size - 1;
+		if (LengthL > 1 + AXIS_COUNT)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Byte stores only, accepted while moving and never busy.
+		if ((LengthL > 0) && (payload[0] != 0))
+		{
+			Robko01.set_override(payload[0]);
+		}
+		for (uint8_t index = 1; index < LengthL; index++)
+		{
+			if (payload[index] != 0)
+			{
+				Robko01.set_axis_override(index - 1, payload[index]);
+			}
+		}
+
+		Robko01Override_t OverrideL = Robko01.get_override();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&OverrideL, sizeof(Robko01Override_t));
+	}
+	else if (opcode == OpCodes::JogTimeout)
+	{
+		// Optional timeout in ms, uint16_t, 0 turns the watchdog off.
+		if ((size != 1) && (size != 3))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		uint16_t TimeoutL = Robko01.get_jog_timeout();
+		if (size == 3)
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			CommandL.Type = MotionCommands::CmdSetJogTimeout;
+			CommandL.Period = (uint16_t)payload[0] | ((uint16_t)payload[1] << 8);
+			if (Robko01.post(CommandL) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+			TimeoutL = (uint16_t)CommandL.Period;
+		}
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&TimeoutL, sizeof(TimeoutL));
+	}
+	else if (opcode == OpCodes::Hold)
+	{
+		// Optional AXIS_COUNT idle timeouts in ms, uint16_t, 0 holds, IDLE_TIMEOUT_KEEP leaves one as it is.
+		uint8_t LengthL = size - 1;
+		if ((LengthL != 0) && (LengthL != AXIS_COUNT * sizeof(uint16_t)))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		Robko01Hold_t HoldL = Robko01.get_hold();
+		if (LengthL != 0)
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			CommandL.Type = MotionCommands::CmdSetIdleTimeout;
+			for (uint8_t index = 0; index < AXIS_COUNT; index++)
+			{
+				CommandL.Timeout[index] = (uint16_t)payload[2 * index] | ((uint16_t)payload[2 * index + 1] << 8);
+				if (CommandL.Timeout[index] != IDLE_TIMEOUT_KEEP)
+				{
+					HoldL.IdleTimeout[index] = CommandL.Timeout[index];
+				}
+			}
+			if (Robko01.post(CommandL) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+		}
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&HoldL, sizeof(Robko01Hold_t));
+	}
+	else if (opcode == OpCodes::DriveMode)
+	{
+		// Optional AXIS_COUNT DriveModes values, DRIVE_MODE_KEEP leaves one as it is.
+		uint8_t LengthL = size - 1;
+		if ((LengthL != 0) && (LengthL != AXIS_COUNT))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		Robko01Drive_t DriveL = Robko01.get_drive();
+		if (LengthL != 0)
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			CommandL.Type = MotionCommands::CmdSetDriveMode;
+			for (uint8_t index = 0; index < AXIS_COUNT; index++)
+			{
+				if ((payload[index] > DriveModes::DriveWave) && (payload[index] != DRIVE_MODE_KEEP))
+				{
+					SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+					return;
+				}
+				CommandL.Mode[index] = payload[index];
+			}
+
+			// Only while the robot stands still.
+			if ((MotorState_g != 0) || (Robko01.post(CommandL) == false))
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+		}
+
+		// Respond with the modes in effect, the new ones apply at the next slot.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&DriveL, sizeof(Robko01Drive_t));
+	}
+	else if (opcode == OpCodes::Limits)
+	{
+		// Flags and axis, then AxisLimits_t with LimitsSet.
+		uint8_t LengthL = size - 1;
+		if ((LengthL < 2) || (payload[1] >= AXIS_COUNT) ||
+			((payload[0] & LimitsFlags::LimitsSet) && (LengthL < 2 + sizeof(AxisLimits_t))) ||
+			((payload[0] & LimitsFlags::LimitsReject) && (payload[0] & LimitsFlags::LimitsClamp)))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// The flash write stalls the bus, never in the middle of a move.
+		if ((payload[0] & LimitsFlags::LimitsSave) && (MotorState_g != 0))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// The robot holds the limits in effect, in the steps of the drive mode.
+		AxisLimits_t LimitsL = Robko01.get_axis_limits(payload[1]);
+		if (payload[0] & LimitsFlags::LimitsSet)
+		{
+			AxisLimits_t ValueL;
+			memcpy(&ValueL, &payload[2], sizeof(AxisLimits_t));
+
+			if ((ValueL.MinPosition > ValueL.MaxPosition) ||
+				(ValueL.DriveMode > DriveModes::DriveWave))
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+				return;
+			}
+
+			// Only while the robot stands still.
+			if ((MotorState_g != 0) || (Robko01.post(payload[1], ValueL) == false))
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+
+			LimitsL = ValueL;
+		}
+
+		// The limit mode is one for all axes.
+		if (payload[0] & (LimitsFlags::LimitsReject | LimitsFlags::LimitsClamp))
+		{
+			Settings.get().LimitMode = (payload[0] & LimitsFlags::LimitsClamp) ? LimitModes::LimitClamp : LimitModes::LimitReject;
+			Robko01.set_limit_mode(Settings.get().LimitMode);
+		}
+
+		if (payload[0] & LimitsFlags::LimitsSave)
+		{
+			// The posted limits of this request are not in effect yet.
+			RobotLimits_t TableL = Robko01.get_limits();
+			TableL.Axis[payload[1]] = LimitsL;
+			if (Settings.save(TableL) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+				return;
+			}
+		}
+
+		uint8_t ResponseL[2 + sizeof(AxisLimits_t)];
+		ResponseL[0] = payload[1];
+		memcpy(&ResponseL[1], &LimitsL, sizeof(AxisLimits_t));
+		ResponseL[1 + sizeof(AxisLimits_t)] = Robko01.get_limit_mode();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, ResponseL, sizeof(ResponseL));
+	}
+	else if (opcode == OpCodes::PortAFilter)
+	{
+		// Empty reads, PORT_A_BITS sample counts set.
+		uint8_t LengthL = size - 1;
+		if ((LengthL != 0) && (LengthL != PORT_A_BITS))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		uint8_t m_payloadResponse[PORT_A_BITS];
+		for (uint8_t bit = 0; bit < PORT_A_BITS; bit++)
+		{
+			if (LengthL == PORT_A_BITS)
+			{
+				Robko01.set_port_a_filter(bit, payload[bit]);
+			}
+			m_payloadResponse[bit] = Robko01.get_port_a_filter(bit);
+		}
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, PORT_A_BITS);
+	}
+	else if (opcode == OpCodes::PortAEvents)
+	{
+		// Lost count, then the oldest edges, the client asks again while the response is full.
+		PortAEvent_t EventsL[PORT_A_EVENTS_PER_READ];
+		uint8_t m_payloadResponse[1 + sizeof(EventsL)];
+		m_payloadResponse[0] = Robko01.get_port_a_events_lost();
+		uint8_t CountL = Robko01.read_port_a_events(EventsL, PORT_A_EVENTS_PER_READ);
+		memcpy(&m_payloadResponse[1], EventsL, CountL * sizeof(PortAEvent_t));
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 1 + CountL * sizeof(PortAEvent_t));
+	}
+	else if (opcode == OpCodes::MoveUntilInput)
+	{
+#ifdef ENABLE_PROBE
+		// If it is not enabled, do not execute.
+		if (MotorsEnabled_g == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+		// If it is move, do not execute the command.
+		if (MotorState_g != 0)
+		{
+			uint8_t m_payloadResponse[1] = { MotorState_g };
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, m_payloadResponse, 1);
+			return;
+		}
+		// Target, then the Port A mask and levels that stop the move.
+		if (((size - 1) != (sizeof(JointState32_t) + 2)) || (payload[sizeof(JointState32_t)] == 0))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Extract motion data.
+		JointState32_t StateL;
+		ConvertJstate2Buff(StateL, payload);
+
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(MotionCommands::CmdMoveAbsolute32, StateL))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
+		// Refuse targets outside the soft limits, or clamp them.
+		if (Robko01.accept_move(MotionCommands::CmdMoveAbsolute32, StateL) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::OutOfRange, NULL, 0);
+			return;
+		}
+
+		// Set motion data, the condition waits beside the queue.
+		if (Robko01.post(StateL, payload[sizeof(JointState32_t)], payload[sizeof(JointState32_t) + 1]) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
+
+		// Respond with success, ProbeResult tells where it stopped.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::ProbeResult)
+	{
+#ifdef ENABLE_PROBE
+		Robko01Probe_t ProbeL = Robko01.get_probe();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&ProbeL, sizeof(Robko01Probe_t));
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
+	else if (opcode == OpCodes::Triggers)
+	{
+#ifdef ENABLE_PORT_A_TRIGGERS
+		// Flags, then PortATrigger_t with TriggersAdd.
+		uint8_t LengthL = size - 1;
+		if ((LengthL < 1) || ((payload[0] & TriggersFlags::TriggersAdd) && (LengthL != 1 + sizeof(PortATrigger_t))))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+			return;
+		}
+
+		// Queued with the moves, the entries go to the move posted after them.
+		if (payload[0] & TriggersFlags::TriggersClear)
+		{
+			if (Robko01.post(MotionCommands::CmdClearTriggers) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+		}
+
+		if (payload[0] & TriggersFlags::TriggersAdd)
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			CommandL.Type = MotionCommands::CmdAddTrigger;
+			memcpy(&CommandL.Trigger, &payload[1], sizeof(PortATrigger_t));
+
+			if ((CommandL.Trigger.Axis >= AXIS_COUNT) || (CommandL.Trigger.Mask == 0) ||
+				(CommandL.Trigger.Kind > TriggerKinds::TriggerFraction) ||
+				((CommandL.Trigger.Kind == TriggerKinds::TriggerFraction) &&
+				((CommandL.Trigger.Value < 0) || (CommandL.Trigger.Value > TRIGGER_FRACTION_ONE))))
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+				return;
+			}
+
+			if (Robko01.post(CommandL) == false)
+			{
+				SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+				return;
+			}
+		}
+
+		Robko01Triggers_t TriggersL = Robko01.get_triggers();
+
+		// Respond with success.
+		SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t *)&TriggersL, sizeof(Robko01Triggers_t));
+#else
+		SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif
+	}
 	else if (opcode == OpCodes::MoveSpeed)
 	{
 		// If it is not enabled, do not execute.
-		if (Robko01.motors_enabled() == false)
+		if (MotorsEnabled_g == false)
 		{
 			SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
 			return;
 		}
 		
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		JointPositionUnion Motion;
-		for (uint8_t index = 0; index < size; index++)
+		for (uint8_t index = 0; index < sizeof(JointPosition_t); index++)
 		{
 			Motion.Buffer[index] = payload[index];
 		}
 		
+		// A pressed stop input refuses the moves toward it.
+		if (Robko01.inhibited(MotionCommands::CmdMoveSpeed, Motion.Value))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+			return;
+		}
+
 		// Set motion data.
-		Robko01.move_speed(Motion.Value);
+		if (Robko01.post(MotionCommands::CmdMoveSpeed, Motion.Value) == false)
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+			return;
+		}
 		
 		// Respond with success.
 		SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
@@ -322,6 +322,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// TODO: Move to function.
 		JointPositionUnion Motion;
 		size_t DataLengthL = sizeof(JointPosition_t);
@@ -358,6 +365,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// Extract motion data.
 		JointPositionUnion Motion;
 		size_t DataLengthL = sizeof(JointPosition_t);
@@ -412,8 +426,15 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload)
 			return;
 		}
 		
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		JointPositionUnion Motion;
-		for (uint8_t index = 0; index < size; index++)
+		for (uint8_t index = 0; index < sizeof(JointPosition_t); index++)
 		{
 			Motion.Buffer[index] = payload[index];
 		}
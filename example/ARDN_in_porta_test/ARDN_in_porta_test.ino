@@ -76,22 +76,10 @@ void display_port_a(uint8_t port_state);
 #pragma region Variables
 
 /**
- * @brief Current time.
+ * @brief Filtered Port A edges drained in one go.
  * 
  */
-unsigned long CurrentMillis_g = 0;
-
-/**
- * @brief Previous time.
- * 
- */
-unsigned long PreviousMillis_g = 0;
-
-/**
- * @brief Update interval.
- * 
- */
-const long UpdateInterval_g = 100;
+PortAEvent_t Events_g[PORT_A_EVENTS_PER_READ];
 
 /**
  * @brief Port A bits.
@@ -146,14 +134,14 @@ void loop()
 {
 	Robko01.update();
 
-	CurrentMillis_g = millis();
-	
-	if (CurrentMillis_g - PreviousMillis_g >= UpdateInterval_g)
+	// Every filtered edge with its time, short pulses included.
+	uint8_t CountL = Robko01.read_port_a_events(Events_g, PORT_A_EVENTS_PER_READ);
+	for (uint8_t index = 0; index < CountL; index++)
 	{
-		PreviousMillis_g = CurrentMillis_g;
+		bitWrite(PortA_g, Events_g[index].Bit, Events_g[index].Level);
 
-		PortA_g = Robko01.get_port_a();
-		
+		Serial.print(Events_g[index].Time);
+		Serial.print(' ');
 		display_port_a(PortA_g);
 	}
 }
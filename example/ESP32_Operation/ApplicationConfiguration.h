@@ -32,6 +32,22 @@
 
 #define ESP_FW_VERSION 1
 
+/** @brief Serve the bus from a pinned task, SUPER and WiFi from a task on the other core. */
+// #define ENABLE_MOTION_TASK
+
+#pragma region Tasks
+
+/** @brief Core of the communication task, the motion task takes MOTION_TASK_CORE. */
+#define COMM_TASK_CORE 0
+
+/** @brief Priority of the communication task. */
+#define COMM_TASK_PRIORITY 1
+
+/** @brief Stack of the communication task in bytes. */
+#define COMM_TASK_STACK 8192
+
+#pragma endregion
+
 #pragma region IO Pins Definitions
 
 /** @brief Address pin 0. */
@@ -73,6 +89,9 @@
 /** @brief Output data pin 3. */
 #define PIN_DO3 36
 
+/** @brief E-stop input, pulled up, the switch pulls it low and every axis stops at its next slot. */
+// #define PIN_ESTOP 4
+
 #pragma endregion
 
 #endif
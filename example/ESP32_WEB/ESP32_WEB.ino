@@ -758,6 +758,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload) {
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// TODO: Move to function.
 		size_t DataLengthL = sizeof(JointPosition_t);
 		for (uint8_t index = 0; index < DataLengthL; index++)
@@ -793,6 +800,13 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload) {
 			return;
 		}
 
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
 		// Extract motion data.
 		size_t DataLengthL = sizeof(JointPosition_t);
 		for (uint8_t index = 0; index < DataLengthL; index++)
@@ -853,7 +867,14 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t * payload) {
 		}
 		
 
-		for (uint8_t index = 0; index < size; index++)
+		// The payload is exactly one JointPosition_t.
+		if ((size - 1) != sizeof(JointPosition_t))
+		{
+			SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+			return;
+		}
+
+		for (uint8_t index = 0; index < sizeof(JointPosition_t); index++)
 		{
 			MoveSpeed_g.Buffer[index] = payload[index];
 		}
@@ -168,6 +168,30 @@
  */
 #define MAX_SPEED_OFFSET 0
 
+/**
+ * @brief Homing approach speed.
+ * 
+ */
+#define HOMING_FAST_SPEED MOTOR_SLOW_SPEED
+
+/**
+ * @brief Homing re-approach speed, slow enough to stop at once.
+ * 
+ */
+#define HOMING_SLOW_SPEED (MOTOR_SPEED / 20)
+
+/**
+ * @brief Steps off the switch, more than the stopping distance from the approach speed.
+ * 
+ */
+#define HOMING_BACKOFF 400
+
+/**
+ * @brief Steps of the approach before homing gives up.
+ * 
+ */
+#define HOMING_MAX_TRAVEL 100000
+
 #pragma endregion // Params
 
 #pragma region Networ Configuration
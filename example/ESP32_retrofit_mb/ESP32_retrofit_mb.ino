@@ -64,6 +64,10 @@
 #if defined(ENABLE_MOTORS) || defined(ENABLE_SUPER)
 #include "JointPosition.h"
 #include "JointPositionUnion.h"
+
+#include "Homing.h"
+
+#include "StopInputs.h"
 #endif // define(ENABLE_MOTORS) || defined(ENABLE_SUPER)
 
 #if defined(ENABLE_SUPER) || defined(ENABLE_OTA)
@@ -116,6 +120,30 @@ void init_stepper_drivers();
 void update_driver();
 #endif // define(ENABLE_MOTORS)
 
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+/**
+ * @brief Attach the limit switches to the homing engine.
+ * 
+ */
+void init_homing();
+
+/**
+ * @brief Stop the axes of the latched limit switches.
+ * 
+ */
+void serve_limit_stops();
+
+/**
+ * @brief Whether a pressed limit switch refuses the move.
+ * 
+ * @param position Move.
+ * @param relative Relative move, absolute otherwise.
+ * @param speed Speed move, the signs of the speeds count.
+ * @return true if an axis would move toward its pressed switch.
+ */
+bool limit_inhibits(const JointPosition_t &position, bool relative, bool speed);
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+
 #if defined(ENABLE_SUPER)
 /**
  * @brief Initialize the communication.
@@ -275,6 +303,14 @@ AccelStepper stepper6;
 
 MultiStepper steppers;
 
+#if defined(ENABLE_MOTORS_IO)
+/**
+ * @brief Limit switch edges outside homing, stop their axis.
+ * 
+ */
+StopInputsClass LimitStops_g;
+#endif // defined(ENABLE_MOTORS_IO)
+
 #endif // defined(ENABLE_MOTORS)
 
 #if defined(ENABLE_SUPER)
@@ -311,6 +347,11 @@ void setup() {
   init_stepper_drivers();
 #endif // define(ENABLE_MOTORS)
 
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+  //
+  init_homing();
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+
 #if defined(ENABLE_SUPER)
   // Initialize the communication.
   init_communication();
@@ -342,7 +383,11 @@ void loop() {
   if (SafetyStopFlag_g == LOW) {
     // Robko01.update();
     // MotorState_g = Robko01.get_motor_state();
+#if defined(ENABLE_MOTORS_IO)
+    serve_limit_stops();
+#endif // defined(ENABLE_MOTORS_IO)
     update_driver();
+    Homing.update();
   }
 
   if (MotorState_g == 0 && StorePosition_g) {
@@ -562,6 +607,158 @@ void update_driver() {
 }
 #endif // define(ENABLE_MOTORS)
 
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+/**
+ * @brief Limit switch of motor 1 closed.
+ * 
+ */
+void IRAM_ATTR isr_limit_1() {
+  if (bitRead(Homing.get_active(), 0)) {
+    Homing.latch(0);
+  } else {
+    LimitStops_g.latch_input(0);
+  }
+}
+
+/**
+ * @brief Limit switch of motor 2 closed.
+ * 
+ */
+void IRAM_ATTR isr_limit_2() {
+  if (bitRead(Homing.get_active(), 1)) {
+    Homing.latch(1);
+  } else {
+    LimitStops_g.latch_input(1);
+  }
+}
+
+/**
+ * @brief Limit switch of motor 3 closed.
+ * 
+ */
+void IRAM_ATTR isr_limit_3() {
+  if (bitRead(Homing.get_active(), 2)) {
+    Homing.latch(2);
+  } else {
+    LimitStops_g.latch_input(2);
+  }
+}
+
+/**
+ * @brief Limit switch of motor 6 closed.
+ * 
+ */
+void IRAM_ATTR isr_limit_6() {
+  if (bitRead(Homing.get_active(), 5)) {
+    Homing.latch(5);
+  } else {
+    LimitStops_g.latch_input(3);
+  }
+}
+
+/**
+ * @brief Stop the axes of the latched limit switches.
+ * 
+ */
+void serve_limit_stops() {
+#ifdef SHOW_FUNC_NAMES_S
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif  // SHOW_FUNC_NAMES
+
+  uint8_t PendingL = LimitStops_g.pending();
+  if (PendingL == 0) {
+    return;
+  }
+
+  // Before the next run(), the axis takes no further step.
+  AccelStepper* SteppersL[] = { &stepper1, &stepper2, &stepper3, &stepper4, &stepper5, &stepper6 };
+  for (uint8_t axis = 0; axis < 6; axis++) {
+    if (bitRead(PendingL, axis)) {
+      SteppersL[axis]->setCurrentPosition(SteppersL[axis]->currentPosition());
+      LimitStops_g.served(axis);
+    }
+  }
+}
+
+/**
+ * @brief Whether a pressed limit switch refuses the move.
+ * 
+ * @param position Move.
+ * @param relative Relative move, absolute otherwise.
+ * @param speed Speed move, the signs of the speeds count.
+ * @return true if an axis would move toward its pressed switch.
+ */
+bool limit_inhibits(const JointPosition_t &position, bool relative, bool speed) {
+#ifdef SHOW_FUNC_NAMES
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif  // SHOW_FUNC_NAMES
+
+  uint8_t UpL = LimitStops_g.inhibited(1);
+  uint8_t DownL = LimitStops_g.inhibited(-1);
+  if ((UpL | DownL) == 0) {
+    return false;
+  }
+
+  AccelStepper* SteppersL[] = { &stepper1, &stepper2, &stepper3, &stepper4, &stepper5, &stepper6 };
+  const int16_t PositionsL[] = { position.BasePos, position.ShoulderPos, position.ElbowPos, position.LeftDiffPos, position.RightDiffPos, position.GripperPos };
+  const int16_t SpeedsL[] = { position.BaseSpeed, position.ShoulderSpeed, position.ElbowSpeed, position.LeftDiffSpeed, position.RightDiffSpeed, position.GripperSpeed };
+  for (uint8_t axis = 0; axis < 6; axis++) {
+    long DistanceL = speed ? SpeedsL[axis] : (relative ? PositionsL[axis] : PositionsL[axis] - SteppersL[axis]->currentPosition());
+    if (((DistanceL > 0) && bitRead(UpL, axis)) || ((DistanceL < 0) && bitRead(DownL, axis))) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Attach the limit switches to the homing engine.
+ * 
+ */
+void init_homing() {
+#ifdef SHOW_FUNC_NAMES
+  DEBUGLOG("\r\n");
+  DEBUGLOG(__PRETTY_FUNCTION__);
+  DEBUGLOG("\r\n");
+#endif  // SHOW_FUNC_NAMES
+
+  // The switches pull the pins low, at the negative end they refuse the moves toward it.
+  HomingAxis_t ConfigL;
+  ConfigL.ActiveLevel = LOW;
+  ConfigL.Direction = -1;
+  ConfigL.FastSpeed = HOMING_FAST_SPEED;
+  ConfigL.SlowSpeed = HOMING_SLOW_SPEED;
+  ConfigL.Backoff = HOMING_BACKOFF;
+  ConfigL.MaxTravel = HOMING_MAX_TRAVEL;
+  ConfigL.Offset = 0;
+
+  ConfigL.Pin = M1_LIMIT;
+  Homing.attach(0, &stepper1, ConfigL);
+  LimitStops_g.attach(0, M1_LIMIT, LOW, 1U << 0, -1);
+  attachInterrupt(digitalPinToInterrupt(M1_LIMIT), isr_limit_1, FALLING);
+
+  ConfigL.Pin = M2_LIMIT;
+  Homing.attach(1, &stepper2, ConfigL);
+  LimitStops_g.attach(1, M2_LIMIT, LOW, 1U << 1, -1);
+  attachInterrupt(digitalPinToInterrupt(M2_LIMIT), isr_limit_2, FALLING);
+
+  ConfigL.Pin = M3_LIMIT;
+  Homing.attach(2, &stepper3, ConfigL);
+  LimitStops_g.attach(2, M3_LIMIT, LOW, 1U << 2, -1);
+  attachInterrupt(digitalPinToInterrupt(M3_LIMIT), isr_limit_3, FALLING);
+
+  ConfigL.Pin = M6_LIMIT;
+  Homing.attach(5, &stepper6, ConfigL);
+  LimitStops_g.attach(3, M6_LIMIT, LOW, 1U << 5, -1);
+  attachInterrupt(digitalPinToInterrupt(M6_LIMIT), isr_limit_6, FALLING);
+}
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+
 #if defined(ENABLE_SUPER)
 /**
  * @brief Initialize the communication.
@@ -654,19 +851,21 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
   if (opcode == OpCodes::Ping) {
     SUPER.send_raw_response(opcode, StatusCodes::Ok, payload, size - 1);
   } else if (opcode == OpCodes::Stop) {
-#ifdef defined(ENABLE_MOTORS)
+#if defined(ENABLE_MOTORS)
     // Robko01.stop_motors();
+    Homing.abort();
     stepper1.stop();
     stepper2.stop();
     stepper3.stop();
     stepper4.stop();
     stepper5.stop();
     stepper6.stop();
-#endif  // SHOW_FUNC_NAMES
+#endif  // defined(ENABLE_MOTORS)
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   } else if (opcode == OpCodes::Disable) {
-#ifdef defined(ENABLE_MOTORS)
+#if defined(ENABLE_MOTORS)
     // Robko01.disable_motors();
+    Homing.abort();
     stepper1.disableOutputs();
     stepper2.disableOutputs();
     stepper3.disableOutputs();
@@ -675,7 +874,7 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
     stepper6.disableOutputs();
     digitalWrite(MX_ENB, HIGH);
     MotorsEnabled_g = false;
-#endif  // SHOW_FUNC_NAMES
+#endif  // defined(ENABLE_MOTORS)
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
   } else if (opcode == OpCodes::Enable) {
 #ifdef defined(ENABLE_MOTORS)
@@ -714,11 +913,24 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
       return;
     }
 
+    // The payload is exactly one JointPosition_t.
+    if ((size - 1) != sizeof(JointPosition_t)) {
+      SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+      return;
+    }
+
     // TODO: Move to function.
     size_t DataLengthL = sizeof(JointPosition_t);
     for (uint8_t index = 0; index < DataLengthL; index++) {
       MoveRelative_g.Buffer[index] = payload[index];
     }
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+    // A pressed limit switch refuses the moves toward it.
+    if (limit_inhibits(MoveRelative_g.Value, true, false)) {
+      SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+      return;
+    }
+#endif  // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
 #ifdef defined(ENABLE_MOTORS)
     // Set motion data.
     // Robko01.move_relative(MoveRelative_g.Value);
@@ -765,11 +977,24 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
       return;
     }
 
+    // The payload is exactly one JointPosition_t.
+    if ((size - 1) != sizeof(JointPosition_t)) {
+      SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+      return;
+    }
+
     // Extract motion data.
     size_t DataLengthL = sizeof(JointPosition_t);
     for (uint8_t index = 0; index < DataLengthL; index++) {
       MoveAbsolute_g.Buffer[index] = payload[index];
     }
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+    // A pressed limit switch refuses the moves toward it.
+    if (limit_inhibits(MoveAbsolute_g.Value, false, false)) {
+      SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+      return;
+    }
+#endif  // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
 #ifdef defined(ENABLE_MOTORS)
     // Set motion data.
     // Robko01.move_absolute(MoveAbsolute_g.Value);
@@ -840,9 +1065,22 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
       return;
     }
 
-    for (uint8_t index = 0; index < size; index++) {
+    // The payload is exactly one JointPosition_t.
+    if ((size - 1) != sizeof(JointPosition_t)) {
+      SUPER.send_raw_response(opcode, StatusCodes::BadRequest, NULL, 0);
+      return;
+    }
+
+    for (uint8_t index = 0; index < sizeof(JointPosition_t); index++) {
       MoveSpeed_g.Buffer[index] = payload[index];
     }
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+    // A pressed limit switch refuses the moves toward it.
+    if (limit_inhibits(MoveSpeed_g.Value, false, true)) {
+      SUPER.send_raw_response(opcode, StatusCodes::Inhibited, NULL, 0);
+      return;
+    }
+#endif  // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
 #ifdef defined(ENABLE_MOTORS)
     // Set motion data.
     // Robko01.move_speed(MoveSpeed_g.Value);
@@ -857,6 +1095,53 @@ void cbRequestHandler(uint8_t opcode, uint8_t size, uint8_t* payload) {
 #endif  // SHOW_FUNC_NAMES
     // Respond with success.
     SUPER.send_raw_response(opcode, StatusCodes::Ok, NULL, 0);
+  } else if (opcode == OpCodes::Home) {
+    // Axes mask and HomeFlags, an empty mask only reads the progress.
+    uint8_t LengthL = size - 1;
+    if ((LengthL >= 1) && (payload[0] != 0)) {
+      // If it is not enabled, do not execute.
+      if (MotorsEnabled_g == false) {
+        SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+        return;
+      }
+      // Not while the joints move.
+      if ((MotorState_g != 0) || (Homing.get_active() != 0)) {
+        SUPER.send_raw_response(opcode, StatusCodes::Busy, NULL, 0);
+        return;
+      }
+
+      // The homing engine drives the positioning mode.
+      OperationMode_g = OperationModes::Positioning;
+      if (Homing.start(payload[0], (LengthL >= 2) ? payload[1] : 0) == false) {
+        SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+        return;
+      }
+    }
+
+    // Respond with the active, homed and failed axes.
+    uint8_t m_payloadResponse[3];
+    m_payloadResponse[0] = Homing.get_active();
+    m_payloadResponse[1] = Homing.get_homed();
+    m_payloadResponse[2] = Homing.get_failed();
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, m_payloadResponse, 3);
+  } else if (opcode == OpCodes::Stats) {
+#if defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
+    // Flags and page, only the stop inputs on this board.
+    if ((size < 3) || (payload[1] != StatsPages::StatsStop)) {
+      SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+      return;
+    }
+
+    StopStats_t StopStatsL = LimitStops_g.get_stats();
+    if (payload[0] & StatsFlags::StatsReset) {
+      LimitStops_g.reset_stats();
+    }
+
+    // Respond with success.
+    SUPER.send_raw_response(opcode, StatusCodes::Ok, (uint8_t*)&StopStatsL, sizeof(StopStats_t));
+#else
+    SUPER.send_raw_response(opcode, StatusCodes::Error, NULL, 0);
+#endif // defined(ENABLE_MOTORS) && defined(ENABLE_MOTORS_IO)
   } else if (opcode == OpCodes::SetRobotID) {
     // TODO: Write to I2C EEPROM.
     //for (uint8_t index = 0; index < DataLengthL; index++)
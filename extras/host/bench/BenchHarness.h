@@ -0,0 +1,96 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// BenchHarness.h - minimal self registering benchmarks.
+
+#ifndef _BENCHHARNESS_h
+#define _BENCHHARNESS_h
+
+#include <stdint.h>
+
+#pragma region Types
+
+/** @brief State of one benchmark run. */
+typedef struct
+{
+	uint32_t Iterations; ///< Operations to run between start and stop.
+	uint64_t WallStart; ///< Host clock at start in ns.
+	uint64_t WallNanos; ///< Host time between start and stop in ns.
+	uint64_t VirtualStart; ///< Virtual clock at start in ns.
+	uint64_t VirtualNanos; ///< Virtual time between start and stop in ns.
+	uint64_t Advanced; ///< Virtual time the benchmark advanced itself in ns.
+} BenchState_t;
+
+/** @brief Benchmark body. */
+typedef void (*BenchFunction)(BenchState_t &state);
+
+/** @brief Adds the benchmark to the list at static init. */
+class BenchRegistrar
+{
+
+	public:
+
+	BenchRegistrar(const char * name, BenchFunction function);
+
+};
+
+#pragma endregion
+
+#pragma region Variables
+
+/** @brief Results are written here so the compiler keeps the work. */
+extern volatile uint32_t BenchSink_g;
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Start measuring, call after the setup of the benchmark.
+ *  @param state BenchState_t, Run state.
+ *  @return Void.
+ */
+void bench_start(BenchState_t &state);
+
+/** @brief Stop measuring.
+ *  @param state BenchState_t, Run state.
+ *  @return Void.
+ */
+void bench_stop(BenchState_t &state);
+
+/** @brief Advance the virtual clock without counting it as cost.
+ *  @param state BenchState_t, Run state.
+ *  @param us unsigned long, Time in microseconds.
+ *  @return Void.
+ */
+void bench_advance_micros(BenchState_t &state, unsigned long us);
+
+#pragma endregion
+
+#pragma region Macros
+
+#define BENCH_CASE(name) \
+	static void name(BenchState_t &state); \
+	static BenchRegistrar name##_registrar(#name, name); \
+	static void name(BenchState_t &state)
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,389 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+/*
+	Every benchmark runs twice:
+
+	1. BENCH_VIRTUAL_OPS operations on a fresh virtual bench with the pin
+	   cost model below. The virtual time they consume is deterministic,
+	   so it is compared against the baseline with a tight tolerance.
+	2. Enough operations to fill BENCH_MIN_WALL_NS of host time, best of
+	   BENCH_REPEATS. The host time depends on the machine and is only
+	   compared when --wall-tolerance is given.
+
+	Usage: robko01_bench [--smoke] [--json FILE] [--baseline FILE]
+		[--tolerance PCT] [--wall-tolerance PCT]
+*/
+
+#include <chrono>
+
+#include "HostHAL.h"
+
+#include "BenchHarness.h"
+
+#pragma region Definitions
+
+/** @brief Maximum count of the benchmarks in one binary. */
+#define BENCH_CASES_MAX 64
+
+/** @brief Operations of the deterministic virtual run. */
+#define BENCH_VIRTUAL_OPS 800
+
+/** @brief Host time one timed run should take. */
+#define BENCH_MIN_WALL_NS 20000000ULL
+
+/** @brief Timed runs, the best one is reported. */
+#define BENCH_REPEATS 5
+
+/** @brief Operations of one timed run in smoke mode. */
+#define BENCH_SMOKE_OPS 64
+
+/** @brief Virtual cost of digitalWrite() and digitalRead(), ESP32 core. */
+#define BENCH_DIGITAL_NS 100
+
+/** @brief Virtual cost of analogRead(), ESP32 core. */
+#define BENCH_ANALOG_NS 10000
+
+/** @brief Default allowed virtual regression in percent. */
+#define BENCH_DEFAULT_TOLERANCE 5.0
+
+#pragma endregion
+
+#pragma region Types
+
+/** @brief Result of one benchmark. */
+typedef struct
+{
+	const char * Name;
+	uint32_t Iterations;
+	double NsPerOp;
+	double VirtualNsPerOp;
+} BenchResult_t;
+
+#pragma endregion
+
+#pragma region Variables
+
+volatile uint32_t BenchSink_g;
+
+/** @brief Registered benchmark names. */
+static const char * BenchNames_g[BENCH_CASES_MAX];
+
+/** @brief Registered benchmark bodies. */
+static BenchFunction BenchFunctions_g[BENCH_CASES_MAX];
+
+/** @brief Count of the registered benchmarks. */
+static int BenchCount_g;
+
+/** @brief Results of the current run. */
+static BenchResult_t BenchResults_g[BENCH_CASES_MAX];
+
+#pragma endregion
+
+#pragma region Functions
+
+BenchRegistrar::BenchRegistrar(const char * name, BenchFunction function)
+{
+	if (BenchCount_g < BENCH_CASES_MAX)
+	{
+		BenchNames_g[BenchCount_g] = name;
+		BenchFunctions_g[BenchCount_g] = function;
+		BenchCount_g++;
+	}
+}
+
+/** @brief Host monotonic clock.
+ *  @return uint64_t, Time in ns.
+ */
+static uint64_t wall_nanos()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void bench_start(BenchState_t &state)
+{
+	state.Advanced = 0;
+	state.VirtualStart = host_nanos();
+	state.WallStart = wall_nanos();
+}
+
+void bench_stop(BenchState_t &state)
+{
+	state.WallNanos = wall_nanos() - state.WallStart;
+	state.VirtualNanos = host_nanos() - state.VirtualStart - state.Advanced;
+}
+
+void bench_advance_micros(BenchState_t &state, unsigned long us)
+{
+	host_advance_micros(us);
+	state.Advanced += (uint64_t)us * 1000ULL;
+}
+
+/** @brief Run one benchmark on a clean virtual bench.
+ *  @param function BenchFunction, Benchmark body.
+ *  @param iterations uint32_t, Operations.
+ *  @return BenchState_t, Measured state.
+ */
+static BenchState_t run_once(BenchFunction function, uint32_t iterations)
+{
+	BenchState_t StateL;
+
+	memset(&StateL, 0, sizeof(StateL));
+	StateL.Iterations = iterations;
+
+	host_reset();
+	host_set_costs(BENCH_DIGITAL_NS, BENCH_ANALOG_NS);
+	function(StateL);
+
+	return StateL;
+}
+
+/** @brief Measure one benchmark.
+ *  @param index int, Benchmark index.
+ *  @param smoke bool, Short timed run.
+ *  @return Void.
+ */
+static void run_case(int index, bool smoke)
+{
+	BenchResult_t &ResultL = BenchResults_g[index];
+	BenchFunction FunctionL = BenchFunctions_g[index];
+
+	ResultL.Name = BenchNames_g[index];
+
+	BenchState_t StateL = run_once(FunctionL, BENCH_VIRTUAL_OPS);
+	ResultL.VirtualNsPerOp = (double)StateL.VirtualNanos / BENCH_VIRTUAL_OPS;
+
+	uint32_t IterationsL = BENCH_SMOKE_OPS;
+	uint8_t RepeatsL = 1;
+	if (!smoke)
+	{
+		// Scale from the virtual run so one timed run fills the window.
+		uint64_t PerOpL = (StateL.WallNanos / BENCH_VIRTUAL_OPS) + 1;
+		uint64_t ScaledL = BENCH_MIN_WALL_NS / PerOpL;
+		IterationsL = (ScaledL > 0x7FFFFFFFULL) ? 0x7FFFFFFFUL : (uint32_t)ScaledL;
+		if (IterationsL < BENCH_VIRTUAL_OPS)
+		{
+			IterationsL = BENCH_VIRTUAL_OPS;
+		}
+		RepeatsL = BENCH_REPEATS;
+	}
+
+	ResultL.Iterations = IterationsL;
+	ResultL.NsPerOp = 0.0;
+	for (uint8_t repeat = 0; repeat < RepeatsL; repeat++)
+	{
+		StateL = run_once(FunctionL, IterationsL);
+		double NsPerOpL = (double)StateL.WallNanos / IterationsL;
+		if ((repeat == 0) || (NsPerOpL < ResultL.NsPerOp))
+		{
+			ResultL.NsPerOp = NsPerOpL;
+		}
+	}
+}
+
+/** @brief Write the results as JSON, one benchmark per line.
+ *  @param file FILE *, Output.
+ *  @param smoke bool, Smoke mode.
+ *  @return Void.
+ */
+static void write_json(FILE * file, bool smoke)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"context\": {\"digital_ns\": %d, \"analog_ns\": %d, \"smoke\": %s},\n",
+		BENCH_DIGITAL_NS, BENCH_ANALOG_NS, smoke ? "true" : "false");
+	fprintf(file, "  \"benchmarks\": [\n");
+	for (int index = 0; index < BenchCount_g; index++)
+	{
+		BenchResult_t &ResultL = BenchResults_g[index];
+		fprintf(file, "    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.2f, \"virtual_ns_per_op\": %.2f}%s\n",
+			ResultL.Name, ResultL.Iterations, ResultL.NsPerOp, ResultL.VirtualNsPerOp,
+			(index + 1 < BenchCount_g) ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+/** @brief Read a number that follows the key on the line.
+ *  @return bool, True if the key was found.
+ */
+static bool json_number(const char * line, const char * key, double &value)
+{
+	const char * PositionL = strstr(line, key);
+	if (PositionL == NULL)
+	{
+		return false;
+	}
+
+	PositionL = strchr(PositionL + strlen(key), ':');
+	if (PositionL == NULL)
+	{
+		return false;
+	}
+
+	value = strtod(PositionL + 1, NULL);
+
+	return true;
+}
+
+/** @brief Compare the results against a baseline written by --json.
+ *  @param path const char *, Baseline file.
+ *  @param tolerance double, Allowed virtual regression in percent.
+ *  @param wall_tolerance double, Allowed host regression in percent, < 0 skips.
+ *  @return int, Count of the regressions, -1 if the file is unreadable.
+ */
+static int compare_baseline(const char * path, double tolerance, double wall_tolerance)
+{
+	FILE * FileL = fopen(path, "r");
+	if (FileL == NULL)
+	{
+		fprintf(stderr, "Can not open baseline %s\n", path);
+		return -1;
+	}
+
+	int RegressionsL = 0;
+	char LineL[256];
+	while (fgets(LineL, sizeof(LineL), FileL) != NULL)
+	{
+		const char * NameL = strstr(LineL, "\"name\": \"");
+		if (NameL == NULL)
+		{
+			continue;
+		}
+		NameL += strlen("\"name\": \"");
+		const char * EndL = strchr(NameL, '"');
+		if (EndL == NULL)
+		{
+			continue;
+		}
+
+		double NsL = 0.0;
+		double VirtualL = 0.0;
+		json_number(LineL, "\"ns_per_op\"", NsL);
+		json_number(LineL, "\"virtual_ns_per_op\"", VirtualL);
+
+		for (int index = 0; index < BenchCount_g; index++)
+		{
+			BenchResult_t &ResultL = BenchResults_g[index];
+			if ((strlen(ResultL.Name) != (size_t)(EndL - NameL)) ||
+				(strncmp(ResultL.Name, NameL, EndL - NameL) != 0))
+			{
+				continue;
+			}
+
+			if (ResultL.VirtualNsPerOp > VirtualL * (1.0 + tolerance / 100.0) + 0.5)
+			{
+				printf("REGRESSION %s: virtual %.2f ns/op, baseline %.2f\n",
+					ResultL.Name, ResultL.VirtualNsPerOp, VirtualL);
+				RegressionsL++;
+			}
+
+			if ((wall_tolerance >= 0.0) &&
+				(ResultL.NsPerOp > NsL * (1.0 + wall_tolerance / 100.0)))
+			{
+				printf("REGRESSION %s: %.2f ns/op, baseline %.2f\n",
+					ResultL.Name, ResultL.NsPerOp, NsL);
+				RegressionsL++;
+			}
+		}
+	}
+
+	fclose(FileL);
+
+	return RegressionsL;
+}
+
+#pragma endregion
+
+int main(int argc, char ** argv)
+{
+	bool SmokeL = false;
+	const char * JsonL = NULL;
+	const char * BaselineL = NULL;
+	double ToleranceL = BENCH_DEFAULT_TOLERANCE;
+	double WallToleranceL = -1.0;
+
+	for (int index = 1; index < argc; index++)
+	{
+		if (strcmp(argv[index], "--smoke") == 0)
+		{
+			SmokeL = true;
+		}
+		else if ((strcmp(argv[index], "--json") == 0) && (index + 1 < argc))
+		{
+			JsonL = argv[++index];
+		}
+		else if ((strcmp(argv[index], "--baseline") == 0) && (index + 1 < argc))
+		{
+			BaselineL = argv[++index];
+		}
+		else if ((strcmp(argv[index], "--tolerance") == 0) && (index + 1 < argc))
+		{
+			ToleranceL = strtod(argv[++index], NULL);
+		}
+		else if ((strcmp(argv[index], "--wall-tolerance") == 0) && (index + 1 < argc))
+		{
+			WallToleranceL = strtod(argv[++index], NULL);
+		}
+		else
+		{
+			fprintf(stderr, "Unknown argument %s\n", argv[index]);
+			return 2;
+		}
+	}
+
+	printf("%-32s %12s %12s %16s\n", "benchmark", "iterations", "ns/op", "virtual ns/op");
+	for (int index = 0; index < BenchCount_g; index++)
+	{
+		run_case(index, SmokeL);
+		printf("%-32s %12u %12.2f %16.2f\n", BenchResults_g[index].Name,
+			BenchResults_g[index].Iterations, BenchResults_g[index].NsPerOp,
+			BenchResults_g[index].VirtualNsPerOp);
+	}
+
+	if (JsonL != NULL)
+	{
+		FILE * FileL = fopen(JsonL, "w");
+		if (FileL == NULL)
+		{
+			fprintf(stderr, "Can not write %s\n", JsonL);
+			return 2;
+		}
+		write_json(FileL, SmokeL);
+		fclose(FileL);
+	}
+
+	if (BaselineL != NULL)
+	{
+		int RegressionsL = compare_baseline(BaselineL, ToleranceL, WallToleranceL);
+		if (RegressionsL < 0)
+		{
+			return 2;
+		}
+		printf("%d regression(s) against %s\n", RegressionsL, BaselineL);
+		if (RegressionsL > 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,330 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "SUPER.h"
+
+#include "Robko01.h"
+
+#include "JointPositionUnion.h"
+
+#include "JointPositionDelta.h"
+
+#include "OperationsCodes.h"
+
+#include "../tests/TestBus.h"
+
+#include "BenchHarness.h"
+
+#pragma region Definitions
+
+/** @brief Frames queued per read_frame() call. */
+#define BENCH_FRAMES_PER_READ 32
+
+/** @brief Step rate of the stepper benchmarks. */
+#define BENCH_STEPPER_SPEED 500.0f
+
+#pragma endregion
+
+#pragma region Classes
+
+/** @brief Exposes the protected parser methods. */
+class BenchSUPER : public SUPERClass
+{
+
+	public:
+
+	using SUPERClass::read_frame;
+
+	using SUPERClass::calculate_CRC;
+
+};
+
+/** @brief Exposes the stepper pin interface. */
+class BenchStepper : public AccelStepper
+{
+
+	public:
+
+	BenchStepper(const BusConfig_t &config)
+		: AccelStepper(AccelStepper::FULL4WIRE, config.DI0, config.DI1, config.DI2, config.DI3)
+	{
+	}
+
+};
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Count the parsed frames. */
+static void cbCount(uint8_t opcode, uint8_t size, uint8_t * payload)
+{
+	BenchSink_g += opcode + size + payload[0];
+}
+
+/** @brief Build a request frame the way the host clients do.
+ *  @return size_t, Frame length.
+ */
+static size_t build_request(uint8_t opcode, uint8_t length, uint8_t * frame)
+{
+	frame[0] = FRAME_SENTINEL;
+	frame[1] = 1;
+	frame[2] = length + 1;
+	frame[3] = opcode;
+	for (uint8_t index = 0; index < length; index++)
+	{
+		frame[4 + index] = index * 7;
+	}
+
+	uint8_t CRCL[FRAME_CRC_LEN] = { 0, 0 };
+	for (uint8_t index = 0; index < length + 4; index++)
+	{
+		CRCL[index % 2] ^= frame[index];
+	}
+	frame[length + 4] = CRCL[0];
+	frame[length + 5] = CRCL[1];
+
+	return length + 6;
+}
+
+/** @brief calculate_CRC() over a frame of the given length. */
+static void bench_crc(BenchState_t &state, uint8_t length)
+{
+	BenchSUPER SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+
+	for (uint8_t index = 0; index < length; index++)
+	{
+		FrameL[index] = index * 13;
+	}
+
+	bench_start(state);
+	for (uint32_t index = 0; index < state.Iterations; index++)
+	{
+		uint8_t CRCL[FRAME_CRC_LEN] = { 0, 0 };
+		FrameL[0] = (uint8_t)index;
+		SuperL.calculate_CRC(FrameL, length, CRCL);
+		BenchSink_g += CRCL[0] + CRCL[1];
+	}
+	bench_stop(state);
+}
+
+/** @brief read_frame() parsing frames with the given payload length.
+ *  One operation is one frame, frames are queued in batches.
+ */
+static void bench_read_frame(BenchState_t &state, uint8_t length)
+{
+	BenchSUPER SuperL;
+	MemoryStream PortL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	uint8_t BatchL[FRAME_MAX_LEN * BENCH_FRAMES_PER_READ];
+
+	size_t FrameLengthL = build_request(OpCodes::Ping, length, FrameL);
+	for (uint8_t index = 0; index < BENCH_FRAMES_PER_READ; index++)
+	{
+		memcpy(&BatchL[index * FrameLengthL], FrameL, FrameLengthL);
+	}
+
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbCount);
+
+	uint64_t WallL = 0;
+	uint64_t VirtualL = 0;
+	uint32_t DoneL = 0;
+	while (DoneL < state.Iterations)
+	{
+		uint32_t FramesL = state.Iterations - DoneL;
+		if (FramesL > BENCH_FRAMES_PER_READ)
+		{
+			FramesL = BENCH_FRAMES_PER_READ;
+		}
+
+		// Queuing is not part of the measurement.
+		PortL.feed(BatchL, FramesL * FrameLengthL);
+
+		bench_start(state);
+		SuperL.read_frame();
+		bench_stop(state);
+
+		WallL += state.WallNanos;
+		VirtualL += state.VirtualNanos;
+		DoneL += FramesL;
+	}
+
+	state.WallNanos = WallL;
+	state.VirtualNanos = VirtualL;
+}
+
+/** @brief One Robko01Class::update() call that serves one address slot. */
+static void bench_update(BenchState_t &state, bool moving)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	if (moving)
+	{
+		JointState32_t TargetL;
+		memset(&TargetL, 0, sizeof(TargetL));
+		for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+		{
+			// Far enough to never arrive during the run.
+			TargetL.Axis[axis].Position = (axis % 2) ? -1000000L : 1000000L;
+			TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+		}
+		RobotL.move_absolute32(TargetL);
+	}
+
+	bench_start(state);
+	for (uint32_t index = 0; index < state.Iterations; index++)
+	{
+		bench_advance_micros(state, 1000);
+		RobotL.update();
+	}
+	bench_stop(state);
+
+	BenchSink_g += RobotL.get_motor_state();
+}
+
+/** @brief One AccelStepper run() or runSpeed() call every 100 us. */
+static void bench_stepper(BenchState_t &state, bool accelerated)
+{
+	BusConfig_t ConfigL = test_bus_config();
+	BenchStepper StepperL(ConfigL);
+
+	StepperL.setMaxSpeed(BENCH_STEPPER_SPEED);
+	StepperL.setAcceleration(DEFAULT_ACCELERATION);
+	if (accelerated)
+	{
+		StepperL.moveTo(1000000L);
+	}
+	else
+	{
+		StepperL.setSpeed(BENCH_STEPPER_SPEED);
+	}
+
+	bench_start(state);
+	for (uint32_t index = 0; index < state.Iterations; index++)
+	{
+		bench_advance_micros(state, 100);
+		BenchSink_g += accelerated ? StepperL.run() : StepperL.runSpeed();
+	}
+	bench_stop(state);
+}
+
+#pragma endregion
+
+BENCH_CASE(crc_8)
+{
+	bench_crc(state, 8);
+}
+
+BENCH_CASE(crc_24)
+{
+	bench_crc(state, 24);
+}
+
+BENCH_CASE(crc_56)
+{
+	bench_crc(state, FRAME_MAX_LEN);
+}
+
+BENCH_CASE(read_frame_0)
+{
+	bench_read_frame(state, 0);
+}
+
+BENCH_CASE(read_frame_12)
+{
+	bench_read_frame(state, 12);
+}
+
+BENCH_CASE(read_frame_24)
+{
+	bench_read_frame(state, 24);
+}
+
+BENCH_CASE(read_frame_50)
+{
+	bench_read_frame(state, FRAME_MAX_DATA_LEN);
+}
+
+BENCH_CASE(update_slot_idle)
+{
+	bench_update(state, false);
+}
+
+BENCH_CASE(update_slot_moving)
+{
+	bench_update(state, true);
+}
+
+BENCH_CASE(stepper_run)
+{
+	bench_stepper(state, true);
+}
+
+BENCH_CASE(stepper_run_speed)
+{
+	bench_stepper(state, false);
+}
+
+BENCH_CASE(convert_jpos2buff)
+{
+	JointPosition_t PositionL;
+	uint8_t BufferL[sizeof(JointPosition_t)];
+
+	for (uint8_t index = 0; index < sizeof(BufferL); index++)
+	{
+		BufferL[index] = index;
+	}
+
+	bench_start(state);
+	for (uint32_t index = 0; index < state.Iterations; index++)
+	{
+		BufferL[0] = (uint8_t)index;
+		ConvertJpos2Buff(PositionL, BufferL);
+		BenchSink_g += PositionL.BasePos;
+	}
+	bench_stop(state);
+}
+
+BENCH_CASE(delta_encode)
+{
+	JointPositionDelta DeltaL;
+	JointPosition_t PositionL;
+	uint8_t BufferL[JPOS_DELTA_MAX_LEN];
+
+	memset(&PositionL, 0, sizeof(PositionL));
+
+	bench_start(state);
+	for (uint32_t index = 0; index < state.Iterations; index++)
+	{
+		PositionL.BasePos = (int16_t)index;
+		PositionL.ElbowPos = (int16_t)(index >> 1);
+		BenchSink_g += DeltaL.encode(PositionL, BufferL, sizeof(BufferL));
+	}
+	bench_stop(state);
+}
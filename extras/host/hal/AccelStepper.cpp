@@ -0,0 +1,549 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "AccelStepper.h"
+
+AccelStepper::AccelStepper(uint8_t interface, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, bool enable)
+{
+	_interface = interface;
+	_currentPos = 0;
+	_targetPos = 0;
+	_speed = 0.0;
+	_maxSpeed = 1.0;
+	_acceleration = 0.0;
+	_stepInterval = 0;
+	_minPulseWidth = 1;
+	_enablePin = 0xff;
+	_lastStepTime = 0;
+	_pin[0] = pin1;
+	_pin[1] = pin2;
+	_pin[2] = pin3;
+	_pin[3] = pin4;
+	_enableInverted = false;
+	_forward = NULL;
+	_backward = NULL;
+
+	_n = 0;
+	_c0 = 0.0;
+	_cn = 0.0;
+	_cmin = 1.0;
+	_direction = DIRECTION_CCW;
+
+	for (uint8_t index = 0; index < 4; index++)
+	{
+		_pinInverted[index] = 0;
+	}
+
+	if (enable)
+	{
+		enableOutputs();
+	}
+
+	setAcceleration(1);
+}
+
+AccelStepper::AccelStepper(void (*forward)(), void (*backward)())
+{
+	_interface = FUNCTION;
+	_currentPos = 0;
+	_targetPos = 0;
+	_speed = 0.0;
+	_maxSpeed = 1.0;
+	_acceleration = 0.0;
+	_stepInterval = 0;
+	_minPulseWidth = 1;
+	_enablePin = 0xff;
+	_lastStepTime = 0;
+	_pin[0] = 0;
+	_pin[1] = 0;
+	_pin[2] = 0;
+	_pin[3] = 0;
+	_enableInverted = false;
+	_forward = forward;
+	_backward = backward;
+
+	_n = 0;
+	_c0 = 0.0;
+	_cn = 0.0;
+	_cmin = 1.0;
+	_direction = DIRECTION_CCW;
+
+	for (uint8_t index = 0; index < 4; index++)
+	{
+		_pinInverted[index] = 0;
+	}
+
+	setAcceleration(1);
+}
+
+void AccelStepper::moveTo(long absolute)
+{
+	if (_targetPos != absolute)
+	{
+		_targetPos = absolute;
+		computeNewSpeed();
+	}
+}
+
+void AccelStepper::move(long relative)
+{
+	moveTo(_currentPos + relative);
+}
+
+boolean AccelStepper::runSpeed()
+{
+	if (!_stepInterval)
+	{
+		return false;
+	}
+
+	unsigned long time = micros();
+	if (time - _lastStepTime >= _stepInterval)
+	{
+		if (_direction == DIRECTION_CW)
+		{
+			_currentPos += 1;
+		}
+		else
+		{
+			_currentPos -= 1;
+		}
+		step(_currentPos);
+
+		_lastStepTime = time;
+
+		return true;
+	}
+
+	return false;
+}
+
+long AccelStepper::distanceToGo()
+{
+	return _targetPos - _currentPos;
+}
+
+long AccelStepper::targetPosition()
+{
+	return _targetPos;
+}
+
+long AccelStepper::currentPosition()
+{
+	return _currentPos;
+}
+
+void AccelStepper::setCurrentPosition(long position)
+{
+	_targetPos = _currentPos = position;
+	_n = 0;
+	_stepInterval = 0;
+	_speed = 0.0;
+}
+
+unsigned long AccelStepper::computeNewSpeed()
+{
+	long distanceTo = distanceToGo();
+	long stepsToStop = (long)((_speed * _speed) / (2.0 * _acceleration));
+
+	if (distanceTo == 0 && stepsToStop <= 1)
+	{
+		// At the target and slow enough to stop.
+		_stepInterval = 0;
+		_speed = 0.0;
+		_n = 0;
+		return _stepInterval;
+	}
+
+	if (distanceTo > 0)
+	{
+		if (_n > 0)
+		{
+			// Accelerating, start decelerating if the target is near or it goes the wrong way.
+			if ((stepsToStop >= distanceTo) || _direction == DIRECTION_CCW)
+			{
+				_n = -stepsToStop;
+			}
+		}
+		else if (_n < 0)
+		{
+			// Decelerating, start accelerating again if there is room.
+			if ((stepsToStop < distanceTo) && _direction == DIRECTION_CW)
+			{
+				_n = -_n;
+			}
+		}
+	}
+	else if (distanceTo < 0)
+	{
+		if (_n > 0)
+		{
+			if ((stepsToStop >= -distanceTo) || _direction == DIRECTION_CW)
+			{
+				_n = -stepsToStop;
+			}
+		}
+		else if (_n < 0)
+		{
+			if ((stepsToStop < -distanceTo) && _direction == DIRECTION_CCW)
+			{
+				_n = -_n;
+			}
+		}
+	}
+
+	if (_n == 0)
+	{
+		// First step from stopped.
+		_cn = _c0;
+		_direction = (distanceTo > 0) ? DIRECTION_CW : DIRECTION_CCW;
+	}
+	else
+	{
+		// Subsequent step, equation 13 of the Austin paper.
+		_cn = _cn - ((2.0 * _cn) / ((4.0 * _n) + 1));
+		if (_cn < _cmin)
+		{
+			_cn = _cmin;
+		}
+	}
+	_n++;
+	_stepInterval = (unsigned long)_cn;
+	_speed = 1000000.0 / _cn;
+	if (_direction == DIRECTION_CCW)
+	{
+		_speed = -_speed;
+	}
+
+	return _stepInterval;
+}
+
+boolean AccelStepper::run()
+{
+	if (runSpeed())
+	{
+		computeNewSpeed();
+	}
+
+	return _speed != 0.0 || distanceToGo() != 0;
+}
+
+void AccelStepper::setMaxSpeed(float speed)
+{
+	if (speed < 0.0)
+	{
+		speed = -speed;
+	}
+
+	if (_maxSpeed != speed)
+	{
+		_maxSpeed = speed;
+		_cmin = 1000000.0 / speed;
+
+		// Recompute _n from the current speed and adjust speed if accelerating or cruising.
+		if (_n > 0)
+		{
+			_n = (long)((_speed * _speed) / (2.0 * _acceleration));
+			computeNewSpeed();
+		}
+	}
+}
+
+float AccelStepper::maxSpeed()
+{
+	return _maxSpeed;
+}
+
+void AccelStepper::setAcceleration(float acceleration)
+{
+	if (acceleration == 0.0)
+	{
+		return;
+	}
+	if (acceleration < 0.0)
+	{
+		acceleration = -acceleration;
+	}
+
+	if (_acceleration != acceleration)
+	{
+		// Recompute _n per equation 17 of the Austin paper.
+		_n = _n * (_acceleration / acceleration);
+		// New c0 per equation 7, with correction per equation 15.
+		_c0 = 0.676 * sqrt(2.0 / acceleration) * 1000000.0;
+		_acceleration = acceleration;
+		computeNewSpeed();
+	}
+}
+
+void AccelStepper::setSpeed(float speed)
+{
+	if (speed == _speed)
+	{
+		return;
+	}
+
+	speed = constrain(speed, -_maxSpeed, _maxSpeed);
+	if (speed == 0.0)
+	{
+		_stepInterval = 0;
+	}
+	else
+	{
+		_stepInterval = (unsigned long)fabs(1000000.0 / speed);
+		_direction = (speed > 0.0) ? DIRECTION_CW : DIRECTION_CCW;
+	}
+	_speed = speed;
+}
+
+float AccelStepper::speed()
+{
+	return _speed;
+}
+
+void AccelStepper::step(long step)
+{
+	switch (_interface)
+	{
+	case FUNCTION:
+		step0(step);
+		break;
+
+	case DRIVER:
+		step1(step);
+		break;
+
+	case FULL2WIRE:
+		step2(step);
+		break;
+
+	case FULL4WIRE:
+		step4(step);
+		break;
+
+	case HALF4WIRE:
+		step8(step);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void AccelStepper::setOutputPins(uint8_t mask)
+{
+	uint8_t numpins = 2;
+	if (_interface == FULL4WIRE || _interface == HALF4WIRE)
+	{
+		numpins = 4;
+	}
+	else if (_interface == FULL3WIRE || _interface == HALF3WIRE)
+	{
+		numpins = 3;
+	}
+
+	for (uint8_t index = 0; index < numpins; index++)
+	{
+		digitalWrite(_pin[index], (mask & (1 << index)) ? (HIGH ^ _pinInverted[index]) : (LOW ^ _pinInverted[index]));
+	}
+}
+
+void AccelStepper::step0(long step)
+{
+	(void)step;
+
+	if (_speed > 0)
+	{
+		_forward();
+	}
+	else
+	{
+		_backward();
+	}
+}
+
+void AccelStepper::step1(long step)
+{
+	(void)step;
+
+	// Direction first, then the step pulse.
+	setOutputPins(_direction ? 0b10 : 0b00);
+	setOutputPins(_direction ? 0b11 : 0b01);
+	delayMicroseconds(_minPulseWidth);
+	setOutputPins(_direction ? 0b10 : 0b00);
+}
+
+void AccelStepper::step2(long step)
+{
+	switch (step & 0x3)
+	{
+	case 0: setOutputPins(0b10); break;
+	case 1: setOutputPins(0b11); break;
+	case 2: setOutputPins(0b01); break;
+	case 3: setOutputPins(0b00); break;
+	}
+}
+
+void AccelStepper::step4(long step)
+{
+	switch (step & 0x3)
+	{
+	case 0: setOutputPins(0b0101); break;
+	case 1: setOutputPins(0b0110); break;
+	case 2: setOutputPins(0b1010); break;
+	case 3: setOutputPins(0b1001); break;
+	}
+}
+
+void AccelStepper::step8(long step)
+{
+	switch (step & 0x7)
+	{
+	case 0: setOutputPins(0b0001); break;
+	case 1: setOutputPins(0b0101); break;
+	case 2: setOutputPins(0b0100); break;
+	case 3: setOutputPins(0b0110); break;
+	case 4: setOutputPins(0b0010); break;
+	case 5: setOutputPins(0b1010); break;
+	case 6: setOutputPins(0b1000); break;
+	case 7: setOutputPins(0b1001); break;
+	}
+}
+
+void AccelStepper::disableOutputs()
+{
+	if (!_interface)
+	{
+		return;
+	}
+
+	setOutputPins(0);
+
+	if (_enablePin != 0xff)
+	{
+		pinMode(_enablePin, OUTPUT);
+		digitalWrite(_enablePin, LOW ^ _enableInverted);
+	}
+}
+
+void AccelStepper::enableOutputs()
+{
+	if (!_interface)
+	{
+		return;
+	}
+
+	pinMode(_pin[0], OUTPUT);
+	pinMode(_pin[1], OUTPUT);
+	if (_interface == FULL4WIRE || _interface == HALF4WIRE)
+	{
+		pinMode(_pin[2], OUTPUT);
+		pinMode(_pin[3], OUTPUT);
+	}
+	else if (_interface == FULL3WIRE || _interface == HALF3WIRE)
+	{
+		pinMode(_pin[2], OUTPUT);
+	}
+
+	if (_enablePin != 0xff)
+	{
+		pinMode(_enablePin, OUTPUT);
+		digitalWrite(_enablePin, HIGH ^ _enableInverted);
+	}
+}
+
+void AccelStepper::setMinPulseWidth(unsigned int minWidth)
+{
+	_minPulseWidth = minWidth;
+}
+
+void AccelStepper::setEnablePin(uint8_t enablePin)
+{
+	_enablePin = enablePin;
+
+	if (_enablePin != 0xff)
+	{
+		pinMode(_enablePin, OUTPUT);
+		digitalWrite(_enablePin, HIGH ^ _enableInverted);
+	}
+}
+
+void AccelStepper::setPinsInverted(bool directionInvert, bool stepInvert, bool enableInvert)
+{
+	_pinInverted[0] = stepInvert;
+	_pinInverted[1] = directionInvert;
+	_enableInverted = enableInvert;
+}
+
+void AccelStepper::runToPosition()
+{
+	while (run())
+	{
+		// Nothing advances the virtual clock here, callers must.
+		delayMicroseconds(1);
+	}
+}
+
+boolean AccelStepper::runSpeedToPosition()
+{
+	if (_targetPos == _currentPos)
+	{
+		return false;
+	}
+
+	if (_targetPos > _currentPos)
+	{
+		_direction = DIRECTION_CW;
+	}
+	else
+	{
+		_direction = DIRECTION_CCW;
+	}
+
+	return runSpeed();
+}
+
+void AccelStepper::runToNewPosition(long position)
+{
+	moveTo(position);
+	runToPosition();
+}
+
+void AccelStepper::stop()
+{
+	if (_speed != 0.0)
+	{
+		long stepsToStop = (long)((_speed * _speed) / (2.0 * _acceleration)) + 1;
+		if (_speed > 0)
+		{
+			move(stepsToStop);
+		}
+		else
+		{
+			move(-stepsToStop);
+		}
+	}
+}
+
+bool AccelStepper::isRunning()
+{
+	return !(_speed == 0.0 && _targetPos == _currentPos);
+}
@@ -0,0 +1,169 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// AccelStepper.h - host implementation of the AccelStepper API subset the
+// library and the sketches use. Same speed profile algorithm and the same
+// coil patterns as the upstream library, so bus traces match the target.
+
+#ifndef _ACCELSTEPPER_h
+#define _ACCELSTEPPER_h
+
+#include "Arduino.h"
+
+class AccelStepper
+{
+
+	public:
+
+	/** @brief Motor interface types. */
+	typedef enum
+	{
+		FUNCTION = 0, ///< Use the functions passed to the constructor.
+		DRIVER = 1, ///< Step and direction driver.
+		FULL2WIRE = 2, ///< 2 wire stepper, full step.
+		FULL3WIRE = 3, ///< 3 wire stepper, full step.
+		FULL4WIRE = 4, ///< 4 wire stepper, full step.
+		HALF3WIRE = 6, ///< 3 wire stepper, half step.
+		HALF4WIRE = 8 ///< 4 wire stepper, half step.
+	} MotorInterfaceType;
+
+	AccelStepper(uint8_t interface = AccelStepper::FULL4WIRE, uint8_t pin1 = 2, uint8_t pin2 = 3, uint8_t pin3 = 4, uint8_t pin4 = 5, bool enable = true);
+
+	AccelStepper(void (*forward)(), void (*backward)());
+
+	virtual ~AccelStepper() {}
+
+	void moveTo(long absolute);
+
+	void move(long relative);
+
+	boolean run();
+
+	boolean runSpeed();
+
+	void setMaxSpeed(float speed);
+
+	float maxSpeed();
+
+	void setAcceleration(float acceleration);
+
+	void setSpeed(float speed);
+
+	float speed();
+
+	long distanceToGo();
+
+	long targetPosition();
+
+	long currentPosition();
+
+	void setCurrentPosition(long position);
+
+	void runToPosition();
+
+	boolean runSpeedToPosition();
+
+	void runToNewPosition(long position);
+
+	void stop();
+
+	virtual void disableOutputs();
+
+	virtual void enableOutputs();
+
+	void setMinPulseWidth(unsigned int minWidth);
+
+	void setEnablePin(uint8_t enablePin = 0xff);
+
+	void setPinsInverted(bool directionInvert = false, bool stepInvert = false, bool enableInvert = false);
+
+	bool isRunning();
+
+	protected:
+
+	/** @brief Direction of rotation. */
+	typedef enum
+	{
+		DIRECTION_CCW = 0, ///< Counter-Clockwise.
+		DIRECTION_CW = 1 ///< Clockwise.
+	} Direction;
+
+	unsigned long computeNewSpeed();
+
+	virtual void setOutputPins(uint8_t mask);
+
+	virtual void step(long step);
+
+	virtual void step0(long step);
+
+	virtual void step1(long step);
+
+	virtual void step2(long step);
+
+	virtual void step4(long step);
+
+	virtual void step8(long step);
+
+	boolean _direction;
+
+	private:
+
+	uint8_t _interface;
+
+	uint8_t _pin[4];
+
+	uint8_t _pinInverted[4];
+
+	long _currentPos;
+
+	long _targetPos;
+
+	float _speed;
+
+	float _maxSpeed;
+
+	float _acceleration;
+
+	unsigned long _stepInterval;
+
+	unsigned long _lastStepTime;
+
+	unsigned int _minPulseWidth;
+
+	bool _enableInverted;
+
+	uint8_t _enablePin;
+
+	void (*_forward)();
+
+	void (*_backward)();
+
+	long _n;
+
+	float _c0;
+
+	float _cn;
+
+	float _cmin;
+
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// EEPROM.h - host shim, byte array erased to 0xFF by host_reset().
+
+#ifndef _EEPROM_h
+#define _EEPROM_h
+
+#include "Arduino.h"
+
+/** @brief Size of the virtual EEPROM, as on the ATmega328P. */
+#define HOST_EEPROM_SIZE 1024
+
+/** @brief Virtual EEPROM, the AVR EEPROM library interface. */
+class EEPROMClass
+{
+
+	public:
+
+	EEPROMClass();
+
+	uint8_t read(int address);
+
+	void write(int address, uint8_t value);
+
+	void update(int address, uint8_t value);
+
+	uint16_t length() { return HOST_EEPROM_SIZE; }
+
+	/** @brief Count of the write() and update() calls that changed a cell.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t writes();
+
+};
+
+/** @brief Default EEPROM. */
+extern EEPROMClass EEPROM;
+
+#endif
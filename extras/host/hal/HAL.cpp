@@ -0,0 +1,451 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <stdarg.h>
+
+#include "HostHAL.h"
+
+#include "EEPROM.h"
+
+#pragma region Variables
+
+/** @brief Virtual clock in nanoseconds. */
+static uint64_t Nanos_g;
+
+/** @brief Cost of the digital pin access. */
+static unsigned long DigitalCost_g;
+
+/** @brief Cost of the analog conversion. */
+static unsigned long AnalogCost_g;
+
+/** @brief Pin levels. */
+static uint8_t PinLevel_g[HOST_PINS_COUNT];
+
+/** @brief Pin modes. */
+static uint8_t PinMode_g[HOST_PINS_COUNT];
+
+/** @brief Analog values. */
+static int PinAnalog_g[HOST_PINS_COUNT];
+
+/** @brief Interrupt handlers. */
+static void (*PinISR_g[HOST_PINS_COUNT])(void);
+
+/** @brief Interrupt modes. */
+static int PinISRMode_g[HOST_PINS_COUNT];
+
+/** @brief Output pin hook. */
+static HostPinHook PinHook_g;
+
+/** @brief Output pin hook context. */
+static void * PinHookContext_g;
+
+/** @brief EEPROM cells. */
+static uint8_t EEPROMCells_g[HOST_EEPROM_SIZE];
+
+/** @brief Count of the EEPROM cell writes. */
+static uint32_t EEPROMWrites_g;
+
+HardwareSerial Serial;
+
+EEPROMClass EEPROM;
+
+#pragma endregion
+
+#pragma region Arduino API
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	PinMode_g[pin] = mode;
+	if (mode == INPUT_PULLUP)
+	{
+		PinLevel_g[pin] = HIGH;
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+	Nanos_g += DigitalCost_g;
+
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	PinLevel_g[pin] = (value != LOW) ? HIGH : LOW;
+
+	if (PinHook_g != NULL)
+	{
+		PinHook_g(PinHookContext_g, pin, PinLevel_g[pin]);
+	}
+}
+
+int digitalRead(uint8_t pin)
+{
+	Nanos_g += DigitalCost_g;
+
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return LOW;
+	}
+
+	return PinLevel_g[pin];
+}
+
+int analogRead(uint8_t pin)
+{
+	Nanos_g += AnalogCost_g;
+
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return 0;
+	}
+
+	return PinAnalog_g[pin];
+}
+
+unsigned long micros()
+{
+	return (unsigned long)(Nanos_g / 1000ULL);
+}
+
+unsigned long millis()
+{
+	return (unsigned long)(Nanos_g / 1000000ULL);
+}
+
+void delay(unsigned long ms)
+{
+	Nanos_g += (uint64_t)ms * 1000000ULL;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	Nanos_g += (uint64_t)us * 1000ULL;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode)
+{
+	if (interrupt >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	PinISR_g[interrupt] = isr;
+	PinISRMode_g[interrupt] = mode;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+	if (interrupt >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	PinISR_g[interrupt] = NULL;
+}
+
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+#pragma endregion
+
+#pragma region Host API
+
+void host_reset()
+{
+	Nanos_g = 0;
+	DigitalCost_g = 0;
+	AnalogCost_g = 0;
+	PinHook_g = NULL;
+	PinHookContext_g = NULL;
+
+	for (uint8_t pin = 0; pin < HOST_PINS_COUNT; pin++)
+	{
+		PinLevel_g[pin] = LOW;
+		PinMode_g[pin] = INPUT;
+		PinAnalog_g[pin] = 0;
+		PinISR_g[pin] = NULL;
+		PinISRMode_g[pin] = 0;
+	}
+
+	Serial.clear();
+
+	memset(EEPROMCells_g, 0xFF, sizeof(EEPROMCells_g));
+	EEPROMWrites_g = 0;
+}
+
+void host_set_micros(unsigned long us)
+{
+	Nanos_g = (uint64_t)us * 1000ULL;
+}
+
+void host_advance_micros(unsigned long us)
+{
+	Nanos_g += (uint64_t)us * 1000ULL;
+}
+
+void host_advance_nanos(unsigned long ns)
+{
+	Nanos_g += ns;
+}
+
+uint64_t host_nanos()
+{
+	return Nanos_g;
+}
+
+void host_set_costs(unsigned long digital_ns, unsigned long analog_ns)
+{
+	DigitalCost_g = digital_ns;
+	AnalogCost_g = analog_ns;
+}
+
+void host_set_pin_hook(HostPinHook hook, void * context)
+{
+	PinHook_g = hook;
+	PinHookContext_g = context;
+}
+
+uint8_t host_pin_level(uint8_t pin)
+{
+	return (pin < HOST_PINS_COUNT) ? PinLevel_g[pin] : LOW;
+}
+
+uint8_t host_pin_mode(uint8_t pin)
+{
+	return (pin < HOST_PINS_COUNT) ? PinMode_g[pin] : INPUT;
+}
+
+void host_set_input(uint8_t pin, uint8_t level)
+{
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	uint8_t PrevL = PinLevel_g[pin];
+	PinLevel_g[pin] = (level != LOW) ? HIGH : LOW;
+
+	if ((PinISR_g[pin] == NULL) || (PrevL == PinLevel_g[pin]))
+	{
+		return;
+	}
+
+	int ModeL = PinISRMode_g[pin];
+	if ((ModeL == CHANGE) ||
+		((ModeL == RISING) && (PinLevel_g[pin] == HIGH)) ||
+		((ModeL == FALLING) && (PinLevel_g[pin] == LOW)))
+	{
+		PinISR_g[pin]();
+	}
+}
+
+void host_set_analog(uint8_t pin, int value)
+{
+	if (pin >= HOST_PINS_COUNT)
+	{
+		return;
+	}
+
+	PinAnalog_g[pin] = value;
+}
+
+#pragma endregion
+
+#pragma region Streams
+
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+	size_t CountL = 0;
+	for (size_t index = 0; index < size; index++)
+	{
+		CountL += write(buffer[index]);
+	}
+
+	return CountL;
+}
+
+size_t Print::print(const char * text)
+{
+	return write((const uint8_t *)text, strlen(text));
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+	char BufferL[24];
+
+	snprintf(BufferL, sizeof(BufferL), (base == HEX) ? "%lX" : "%lu", value);
+
+	return print(BufferL);
+}
+
+size_t Print::print(long value, int base)
+{
+	if (base == HEX)
+	{
+		return print((unsigned long)value, base);
+	}
+
+	char BufferL[24];
+
+	snprintf(BufferL, sizeof(BufferL), "%ld", value);
+
+	return print(BufferL);
+}
+
+size_t Print::println(const char * text)
+{
+	return print(text) + print("\r\n");
+}
+
+size_t Print::printf(const char * format, ...)
+{
+	char BufferL[256];
+	va_list ArgsL;
+
+	va_start(ArgsL, format);
+	int LengthL = vsnprintf(BufferL, sizeof(BufferL), format, ArgsL);
+	va_end(ArgsL);
+
+	if (LengthL < 0)
+	{
+		return 0;
+	}
+	if ((size_t)LengthL >= sizeof(BufferL))
+	{
+		LengthL = sizeof(BufferL) - 1;
+	}
+
+	return write((const uint8_t *)BufferL, (size_t)LengthL);
+}
+
+size_t MemoryStream::write(uint8_t data)
+{
+	m_tx.push_back(data);
+
+	return 1;
+}
+
+int MemoryStream::available()
+{
+	return (int)(m_rx.size() - m_rxIndex);
+}
+
+int MemoryStream::read()
+{
+	if (m_rxIndex >= m_rx.size())
+	{
+		return -1;
+	}
+
+	return m_rx[m_rxIndex++];
+}
+
+int MemoryStream::peek()
+{
+	if (m_rxIndex >= m_rx.size())
+	{
+		return -1;
+	}
+
+	return m_rx[m_rxIndex];
+}
+
+void MemoryStream::feed(const uint8_t * data, size_t size)
+{
+	// Drop what was already consumed, keeps the buffer small.
+	m_rx.erase(m_rx.begin(), m_rx.begin() + m_rxIndex);
+	m_rxIndex = 0;
+	m_rx.insert(m_rx.end(), data, data + size);
+}
+
+void MemoryStream::clear()
+{
+	m_rx.clear();
+	m_rxIndex = 0;
+	m_tx.clear();
+}
+
+size_t HardwareSerial::write(uint8_t data)
+{
+	if (m_echo)
+	{
+		fputc(data, stdout);
+	}
+
+	return MemoryStream::write(data);
+}
+
+#pragma endregion
+
+#pragma region EEPROM
+
+EEPROMClass::EEPROMClass()
+{
+	memset(EEPROMCells_g, 0xFF, sizeof(EEPROMCells_g));
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+	if ((address < 0) || (address >= HOST_EEPROM_SIZE))
+	{
+		return 0xFF;
+	}
+
+	return EEPROMCells_g[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+	if ((address < 0) || (address >= HOST_EEPROM_SIZE))
+	{
+		return;
+	}
+
+	EEPROMCells_g[address] = value;
+	EEPROMWrites_g++;
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+	// Wear only when the cell changes, as on the AVR.
+	if (read(address) != value)
+	{
+		write(address, value);
+	}
+}
+
+uint32_t EEPROMClass::writes()
+{
+	return EEPROMWrites_g;
+}
+
+#pragma endregion
@@ -0,0 +1,63 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// HardwareSerial.h - host shim.
+
+#ifndef _HARDWARESERIAL_h
+#define _HARDWARESERIAL_h
+
+#include "MemoryStream.h"
+
+#define SERIAL_8N1 0x06
+
+/** @brief Serial port backed by memory, optionally echoed to stdout. */
+class HardwareSerial : public MemoryStream
+{
+
+	protected:
+
+	/** @brief Echo TX to stdout. */
+	bool m_echo;
+
+	public:
+
+	HardwareSerial() : m_echo(false) {}
+
+	using Print::write;
+
+	size_t write(uint8_t data) override;
+
+	void begin(unsigned long baud, uint32_t config = SERIAL_8N1) { (void)baud; (void)config; }
+
+	void setDebugOutput(bool enable) { (void)enable; }
+
+	/** @brief Echo everything written to stdout.
+	 *  @param enable bool, Echo state.
+	 *  @return Void.
+	 */
+	void setEcho(bool enable) { m_echo = enable; }
+
+};
+
+/** @brief Default serial port. */
+extern HardwareSerial Serial;
+
+#endif
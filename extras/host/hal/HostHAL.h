@@ -0,0 +1,118 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// HostHAL.h - control side of the host shim, used by tests and tools.
+
+#ifndef _HOSTHAL_h
+#define _HOSTHAL_h
+
+#include "Arduino.h"
+
+#pragma region Definitions
+
+/** @brief Count of the virtual GPIO pins. */
+#define HOST_PINS_COUNT 64
+
+/** @brief ADC full scale of the virtual analog inputs. */
+#define HOST_ANALOG_MAX 1023
+
+#pragma endregion
+
+#pragma region Types
+
+/** @brief Called after every digitalWrite() on an output pin. */
+typedef void (*HostPinHook)(void * context, uint8_t pin, uint8_t value);
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Reset pins, clock, costs, hooks and erase the EEPROM.
+ *  @return Void.
+ */
+void host_reset();
+
+/** @brief Set the virtual clock.
+ *  @param us unsigned long, Time in microseconds.
+ *  @return Void.
+ */
+void host_set_micros(unsigned long us);
+
+/** @brief Advance the virtual clock.
+ *  @param us unsigned long, Time in microseconds.
+ *  @return Void.
+ */
+void host_advance_micros(unsigned long us);
+
+/** @brief Advance the virtual clock with sub microsecond resolution.
+ *  @param ns unsigned long, Time in nanoseconds.
+ *  @return Void.
+ */
+void host_advance_nanos(unsigned long ns);
+
+/** @brief Virtual clock in nanoseconds.
+ *  @return uint64_t, Time.
+ */
+uint64_t host_nanos();
+
+/** @brief Set the virtual time every call costs.
+ *  @param digital_ns unsigned long, Cost of digitalWrite() and digitalRead().
+ *  @param analog_ns unsigned long, Cost of analogRead().
+ *  @return Void.
+ */
+void host_set_costs(unsigned long digital_ns, unsigned long analog_ns);
+
+/** @brief Register the output pin hook.
+ *  @param hook HostPinHook, Hook or NULL.
+ *  @param context void *, Passed back to the hook.
+ *  @return Void.
+ */
+void host_set_pin_hook(HostPinHook hook, void * context);
+
+/** @brief Level of the pin.
+ *  @param pin uint8_t, Pin.
+ *  @return uint8_t, HIGH or LOW.
+ */
+uint8_t host_pin_level(uint8_t pin);
+
+/** @brief Mode of the pin.
+ *  @param pin uint8_t, Pin.
+ *  @return uint8_t, INPUT, OUTPUT or INPUT_PULLUP.
+ */
+uint8_t host_pin_mode(uint8_t pin);
+
+/** @brief Drive an input pin from outside, fires attached interrupts.
+ *  @param pin uint8_t, Pin.
+ *  @param level uint8_t, HIGH or LOW.
+ *  @return Void.
+ */
+void host_set_input(uint8_t pin, uint8_t level);
+
+/** @brief Drive an analog input from outside.
+ *  @param pin uint8_t, Pin.
+ *  @param value int, ADC value, 0 to HOST_ANALOG_MAX.
+ *  @return Void.
+ */
+void host_set_analog(uint8_t pin, int value);
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,79 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// MemoryStream.h - host shim.
+
+#ifndef _MEMORYSTREAM_h
+#define _MEMORYSTREAM_h
+
+#include <vector>
+
+#include "Stream.h"
+
+/** @brief In-memory stream, the test feeds RX and inspects TX. */
+class MemoryStream : public Stream
+{
+
+	protected:
+
+	/** @brief Bytes waiting to be read by the library. */
+	std::vector<uint8_t> m_rx;
+
+	/** @brief Read index in the RX buffer. */
+	size_t m_rxIndex;
+
+	/** @brief Bytes written by the library. */
+	std::vector<uint8_t> m_tx;
+
+	public:
+
+	MemoryStream() : m_rxIndex(0) {}
+
+	using Print::write;
+
+	size_t write(uint8_t data) override;
+
+	int available() override;
+
+	int read() override;
+
+	int peek() override;
+
+	/** @brief Queue bytes for the library to read.
+	 *  @param data const uint8_t *, Data.
+	 *  @param size size_t, Size of the data.
+	 *  @return Void.
+	 */
+	void feed(const uint8_t * data, size_t size);
+
+	/** @brief Bytes written by the library so far.
+	 *  @return std::vector<uint8_t> &, TX buffer.
+	 */
+	std::vector<uint8_t> & tx() { return m_tx; }
+
+	/** @brief Drop RX and TX content.
+	 *  @return Void.
+	 */
+	void clear();
+
+};
+
+#endif
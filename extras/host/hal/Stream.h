@@ -0,0 +1,83 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// Stream.h - host shim.
+
+#ifndef _STREAM_h
+#define _STREAM_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEC 10
+#define HEX 16
+
+/** @brief Byte sink, the printf flavour follows the ESP32 core. */
+class Print
+{
+
+	public:
+
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t data) = 0;
+
+	virtual size_t write(const uint8_t * buffer, size_t size);
+
+	size_t print(const char * text);
+
+	size_t print(unsigned long value, int base = DEC);
+
+	size_t print(long value, int base = DEC);
+
+	size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+
+	size_t print(int value, int base = DEC) { return print((long)value, base); }
+
+	size_t println(const char * text);
+
+	size_t printf(const char * format, ...) __attribute__((format(printf, 2, 3)));
+
+};
+
+/** @brief Byte source and sink. */
+class Stream : public Print
+{
+
+	protected:
+
+	unsigned long m_timeout;
+
+	public:
+
+	Stream() : m_timeout(1000UL) {}
+
+	virtual int available() = 0;
+
+	virtual int read() = 0;
+
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) { m_timeout = timeout; }
+
+};
+
+#endif
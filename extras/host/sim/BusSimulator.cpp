@@ -0,0 +1,297 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "BusSimulator.h"
+
+#pragma region Variables
+
+/** @brief Coil mask of every electrical position, same order as HALF4WIRE. */
+static const uint8_t PhaseCoils_g[SIM_PHASES_COUNT] = {
+	0b0001, 0b0101, 0b0100, 0b0110, 0b0010, 0b1010, 0b1000, 0b1001
+};
+
+#pragma endregion
+
+BusSimulator::BusSimulator()
+{
+	m_attached = false;
+	memset(&m_config, 0, sizeof(m_config));
+	reset();
+}
+
+void BusSimulator::reset()
+{
+	for (uint8_t axis = 0; axis < SIM_AXIS_COUNT; axis++)
+	{
+		m_axis[axis].Coils = 0;
+		m_axis[axis].RotorPhase = SIM_DEFAULT_PHASE;
+		m_axis[axis].HalfSteps = 0;
+		m_axis[axis].LastStep = 0;
+		m_axis[axis].Steps = 0;
+		m_axis[axis].IllegalStates = 0;
+		m_axis[axis].MissedSteps = 0;
+	}
+
+	for (uint8_t address = 0; address < SIM_ADDRESS_COUNT; address++)
+	{
+		m_latches[address] = 0;
+	}
+
+	m_portAOut = 0;
+	m_portAIn = 0;
+	m_minStepPeriod = 0;
+	m_halfStepsPerRev = SIM_DEFAULT_HALF_STEPS_PER_REV;
+	m_writeStrobes = 0;
+	m_readStrobes = 0;
+	m_iow = HIGH;
+	m_ior = HIGH;
+}
+
+void BusSimulator::attach(const BusConfig_t &config)
+{
+	m_config = config;
+	m_attached = true;
+	m_iow = host_pin_level(m_config.IOW);
+	m_ior = host_pin_level(m_config.IOR);
+	host_set_pin_hook(pin_hook, this);
+	drive_do(bus_address());
+}
+
+void BusSimulator::detach()
+{
+	if (m_attached)
+	{
+		host_set_pin_hook(NULL, NULL);
+		m_attached = false;
+	}
+}
+
+void BusSimulator::pin_hook(void * context, uint8_t pin, uint8_t value)
+{
+	static_cast<BusSimulator *>(context)->on_pin(pin, value);
+}
+
+void BusSimulator::on_pin(uint8_t pin, uint8_t value)
+{
+	if (pin == m_config.IOW)
+	{
+		// Registers latch on the rising edge.
+		if ((m_iow == LOW) && (value == HIGH))
+		{
+			write_strobe(micros(), bus_address(), bus_data());
+		}
+		m_iow = value;
+	}
+	else if (pin == m_config.IOR)
+	{
+		if ((m_ior == HIGH) && (value == LOW))
+		{
+			read_strobe(micros(), bus_address());
+		}
+		m_ior = value;
+	}
+	else if ((pin == m_config.AO0) || (pin == m_config.AO1) || (pin == m_config.AO2))
+	{
+		drive_do(bus_address());
+	}
+}
+
+uint8_t BusSimulator::bus_address()
+{
+	return (host_pin_level(m_config.AO0) << 0) |
+		(host_pin_level(m_config.AO1) << 1) |
+		(host_pin_level(m_config.AO2) << 2);
+}
+
+uint8_t BusSimulator::bus_data()
+{
+	return (host_pin_level(m_config.DI0) << 0) |
+		(host_pin_level(m_config.DI1) << 1) |
+		(host_pin_level(m_config.DI2) << 2) |
+		(host_pin_level(m_config.DI3) << 3);
+}
+
+void BusSimulator::drive_do(uint8_t address)
+{
+	if (!m_attached)
+	{
+		return;
+	}
+
+	uint8_t NibbleL = 0;
+	if (address == 6)
+	{
+		NibbleL = m_portAIn & 0x0F;
+	}
+	else if (address == 7)
+	{
+		NibbleL = (m_portAIn >> 4) & 0x0F;
+	}
+
+	host_set_analog(m_config.DO0, bitRead(NibbleL, 0) ? HOST_ANALOG_MAX : 0);
+	host_set_analog(m_config.DO1, bitRead(NibbleL, 1) ? HOST_ANALOG_MAX : 0);
+	host_set_analog(m_config.DO2, bitRead(NibbleL, 2) ? HOST_ANALOG_MAX : 0);
+	host_set_analog(m_config.DO3, bitRead(NibbleL, 3) ? HOST_ANALOG_MAX : 0);
+}
+
+void BusSimulator::write_strobe(unsigned long timestamp, uint8_t address, uint8_t pins)
+{
+	// Active low data lines.
+	uint8_t NibbleL = (~pins) & 0x0F;
+
+	address &= 0x07;
+	m_writeStrobes++;
+	m_latches[address]++;
+
+	if (address < SIM_AXIS_COUNT)
+	{
+		latch_coils(timestamp, address, NibbleL);
+	}
+	else if (address == 6)
+	{
+		m_portAOut = (m_portAOut & 0xF0) | NibbleL;
+	}
+	else
+	{
+		m_portAOut = (m_portAOut & 0x0F) | (NibbleL << 4);
+	}
+}
+
+uint8_t BusSimulator::read_strobe(unsigned long timestamp, uint8_t address)
+{
+	(void)timestamp;
+
+	m_readStrobes++;
+
+	if (address == 6)
+	{
+		return m_portAIn & 0x0F;
+	}
+	if (address == 7)
+	{
+		return (m_portAIn >> 4) & 0x0F;
+	}
+
+	return 0;
+}
+
+void BusSimulator::set_port_a_inputs(uint8_t value)
+{
+	m_portAIn = value;
+
+	if (m_attached)
+	{
+		drive_do(bus_address());
+	}
+}
+
+void BusSimulator::latch_coils(unsigned long timestamp, uint8_t axis, uint8_t coils)
+{
+	SimAxis_t &AxisL = m_axis[axis];
+
+	AxisL.Coils = coils;
+
+	// Off or all on, no torque toward a phase.
+	if ((coils == 0x00) || (coils == 0x0F))
+	{
+		return;
+	}
+
+	uint8_t PhaseL = coils_to_phase(coils);
+	if (PhaseL == SIM_PHASE_NONE)
+	{
+		AxisL.IllegalStates++;
+		return;
+	}
+
+	// Shortest signed distance on the 8 phase circle.
+	int8_t DeltaL = (int8_t)((PhaseL - AxisL.RotorPhase) & 0x07);
+	if (DeltaL > 4)
+	{
+		DeltaL -= SIM_PHASES_COUNT;
+	}
+
+	if (DeltaL == 0)
+	{
+		return;
+	}
+
+	// Opposite or nearly opposite phase, the rotor direction is undefined.
+	if ((DeltaL > 2) || (DeltaL < -2))
+	{
+		AxisL.IllegalStates++;
+		AxisL.MissedSteps++;
+		return;
+	}
+
+	// Faster than the rotor can follow.
+	if ((m_minStepPeriod != 0) && (AxisL.Steps != 0) &&
+		((timestamp - AxisL.LastStep) < m_minStepPeriod))
+	{
+		AxisL.MissedSteps++;
+		return;
+	}
+
+	AxisL.RotorPhase = PhaseL;
+	AxisL.HalfSteps += DeltaL;
+	AxisL.LastStep = timestamp;
+	AxisL.Steps++;
+}
+
+float BusSimulator::shaft_angle(uint8_t axis) const
+{
+	return (float)m_axis[axis].HalfSteps * 360.0f / (float)m_halfStepsPerRev;
+}
+
+uint32_t BusSimulator::illegal_states() const
+{
+	uint32_t CountL = 0;
+	for (uint8_t axis = 0; axis < SIM_AXIS_COUNT; axis++)
+	{
+		CountL += m_axis[axis].IllegalStates;
+	}
+
+	return CountL;
+}
+
+uint32_t BusSimulator::missed_steps() const
+{
+	uint32_t CountL = 0;
+	for (uint8_t axis = 0; axis < SIM_AXIS_COUNT; axis++)
+	{
+		CountL += m_axis[axis].MissedSteps;
+	}
+
+	return CountL;
+}
+
+uint8_t BusSimulator::coils_to_phase(uint8_t coils)
+{
+	for (uint8_t phase = 0; phase < SIM_PHASES_COUNT; phase++)
+	{
+		if (PhaseCoils_g[phase] == coils)
+		{
+			return phase;
+		}
+	}
+
+	return SIM_PHASE_NONE;
+}
@@ -0,0 +1,264 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// BusSimulator.h - virtual Robko01 behind the host HAL.
+
+/*
+	The driver boards latch the DI nibble on the rising edge of IOW into
+	the register selected by AO0..AO2. The DI lines are active low, the
+	same way write_di() inverts Port A, so coil = ~pin for every bit:
+
+	+---------+---------------------------------------------+
+	| Address | Latched nibble                              |
+	+---------+---------------------------------------------+
+	| 0 .. 5  | Coils of the axis, bit N = coil on DIN.     |
+	| 6       | Port A outputs 0 .. 3.                      |
+	| 7       | Port A outputs 4 .. 7.                      |
+	+---------+---------------------------------------------+
+
+	While AO0..AO2 select address 6 or 7 the board drives DO0..DO3 with
+	the matching Port A input nibble.
+
+	A coil mask maps to an electrical position in half steps (0..7).
+	All coils off keeps the rotor where it is, all coils on gives no net
+	torque and keeps it too. Any other mask is an illegal coil state.
+	A jump of more than two half steps from the rotor, or a step faster
+	than the motor can follow, is a missed step.
+*/
+
+#ifndef _BUSSIMULATOR_h
+#define _BUSSIMULATOR_h
+
+#include "HostHAL.h"
+
+#include "BusConfig.h"
+
+#pragma region Definitions
+
+/** @brief Count of the simulated axes. */
+#define SIM_AXIS_COUNT 6
+
+/** @brief Count of the bus addresses. */
+#define SIM_ADDRESS_COUNT 8
+
+/** @brief Electrical positions per coil cycle. */
+#define SIM_PHASES_COUNT 8
+
+/** @brief Marks a coil mask that is not a phase. */
+#define SIM_PHASE_NONE 0xFF
+
+/** @brief Rotor phase at position 0 of the FULL4WIRE table (pins 0101). */
+#define SIM_DEFAULT_PHASE 5
+
+/** @brief Default half steps per shaft revolution. */
+#define SIM_DEFAULT_HALF_STEPS_PER_REV 96
+
+#pragma endregion
+
+#pragma region Types
+
+/** @brief State of one simulated axis. */
+typedef struct
+{
+	uint8_t Coils; ///< Latched coil mask, bit set means energised.
+	uint8_t RotorPhase; ///< Electrical position of the rotor, 0 .. 7.
+	long HalfSteps; ///< Shaft position in half steps.
+	unsigned long LastStep; ///< Time of the last rotor move in us.
+	uint32_t Steps; ///< Count of the rotor moves.
+	uint32_t IllegalStates; ///< Count of the illegal coil masks.
+	uint32_t MissedSteps; ///< Count of the steps the rotor did not follow.
+} SimAxis_t;
+
+#pragma endregion
+
+class BusSimulator
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Bus pinout of the controller. */
+	BusConfig_t m_config;
+
+	/** @brief Attached to the HAL pin hook. */
+	bool m_attached;
+
+	/** @brief Last IOW level. */
+	uint8_t m_iow;
+
+	/** @brief Last IOR level. */
+	uint8_t m_ior;
+
+	/** @brief Axis state. */
+	SimAxis_t m_axis[SIM_AXIS_COUNT];
+
+	/** @brief Port A outputs latched from the bus. */
+	uint8_t m_portAOut;
+
+	/** @brief Port A inputs presented to the bus. */
+	uint8_t m_portAIn;
+
+	/** @brief Fastest step the motors follow, 0 disables the check. */
+	unsigned long m_minStepPeriod;
+
+	/** @brief Half steps per shaft revolution. */
+	long m_halfStepsPerRev;
+
+	/** @brief Count of the IOW strobes. */
+	uint32_t m_writeStrobes;
+
+	/** @brief Count of the IOR strobes. */
+	uint32_t m_readStrobes;
+
+	/** @brief Count of the latches per address. */
+	uint32_t m_latches[SIM_ADDRESS_COUNT];
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief HAL pin hook trampoline. */
+	static void pin_hook(void * context, uint8_t pin, uint8_t value);
+
+	/** @brief React on one output pin change. */
+	void on_pin(uint8_t pin, uint8_t value);
+
+	/** @brief Address selected by AO0..AO2. */
+	uint8_t bus_address();
+
+	/** @brief DI0..DI3 pin levels. */
+	uint8_t bus_data();
+
+	/** @brief Present DO0..DO3 for the selected address. */
+	void drive_do(uint8_t address);
+
+	/** @brief Move the rotor of the axis toward the latched coils. */
+	void latch_coils(unsigned long timestamp, uint8_t axis, uint8_t coils);
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	BusSimulator();
+
+	/** @brief Watch the bus pins through the HAL hook.
+	 *  @param config BusConfig_t, Bus pinout.
+	 *  @return Void.
+	 */
+	void attach(const BusConfig_t &config);
+
+	/** @brief Stop watching the bus.
+	 *  @return Void.
+	 */
+	void detach();
+
+	/** @brief Reset axes, ports and counters.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Apply an IOW strobe directly, used by trace replay.
+	 *  @param timestamp unsigned long, Time in us.
+	 *  @param address uint8_t, AO0..AO2 value.
+	 *  @param pins uint8_t, DI0..DI3 pin levels.
+	 *  @return Void.
+	 */
+	void write_strobe(unsigned long timestamp, uint8_t address, uint8_t pins);
+
+	/** @brief Apply an IOR strobe directly, used by trace replay.
+	 *  @param timestamp unsigned long, Time in us.
+	 *  @param address uint8_t, AO0..AO2 value.
+	 *  @return uint8_t, DO0..DO3 nibble the board drives.
+	 */
+	uint8_t read_strobe(unsigned long timestamp, uint8_t address);
+
+	/** @brief Set Port A inputs.
+	 *  @param value uint8_t, Input bits.
+	 *  @return Void.
+	 */
+	void set_port_a_inputs(uint8_t value);
+
+	/** @brief Port A outputs latched from the bus.
+	 *  @return uint8_t, Output bits.
+	 */
+	uint8_t port_a_outputs() { return m_portAOut; }
+
+	/** @brief Place the rotor without counting a step.
+	 *  @param axis uint8_t, Axis index.
+	 *  @param phase uint8_t, Electrical position 0 .. 7.
+	 *  @return Void.
+	 */
+	void set_rotor_phase(uint8_t axis, uint8_t phase) { m_axis[axis].RotorPhase = phase & 0x07; }
+
+	/** @brief Set the fastest step period the motors follow.
+	 *  @param us unsigned long, Period, 0 disables the check.
+	 *  @return Void.
+	 */
+	void set_min_step_period(unsigned long us) { m_minStepPeriod = us; }
+
+	/** @brief Set the shaft resolution.
+	 *  @param half_steps long, Half steps per revolution.
+	 *  @return Void.
+	 */
+	void set_half_steps_per_rev(long half_steps) { m_halfStepsPerRev = half_steps; }
+
+	/** @brief Axis state.
+	 *  @param axis uint8_t, Axis index.
+	 *  @return const SimAxis_t &, State.
+	 */
+	const SimAxis_t & axis(uint8_t axis) const { return m_axis[axis]; }
+
+	/** @brief Shaft angle of the axis.
+	 *  @param axis uint8_t, Axis index.
+	 *  @return float, Angle in degrees.
+	 */
+	float shaft_angle(uint8_t axis) const;
+
+	/** @brief Sum of the illegal coil states over all axes.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t illegal_states() const;
+
+	/** @brief Sum of the missed steps over all axes.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t missed_steps() const;
+
+	uint32_t write_strobes() const { return m_writeStrobes; }
+
+	uint32_t read_strobes() const { return m_readStrobes; }
+
+	uint32_t latches(uint8_t address) const { return m_latches[address]; }
+
+	/** @brief Electrical position of a coil mask.
+	 *  @param coils uint8_t, Coil mask.
+	 *  @return uint8_t, 0 .. 7 or SIM_PHASE_NONE.
+	 */
+	static uint8_t coils_to_phase(uint8_t coils);
+
+#pragma endregion
+
+};
+
+#endif
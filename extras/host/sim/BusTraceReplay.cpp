@@ -0,0 +1,277 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "BusTraceReplay.h"
+
+#include <ctype.h>
+
+BusTraceReplay::BusTraceReplay()
+{
+	m_binWidth = REPLAY_DEFAULT_BIN_WIDTH;
+	clear();
+}
+
+void BusTraceReplay::clear()
+{
+	m_records.clear();
+	m_inDump = false;
+	memset(m_histogram, 0, sizeof(m_histogram));
+	memset(m_address, 0, sizeof(m_address));
+	m_duration = 0;
+	m_segments = 0;
+}
+
+/** @brief Value of one hex digit, -1 if it is not one. */
+static int hex_digit(char digit)
+{
+	if ((digit >= '0') && (digit <= '9'))
+	{
+		return digit - '0';
+	}
+	if ((digit >= 'A') && (digit <= 'F'))
+	{
+		return digit - 'A' + 10;
+	}
+	if ((digit >= 'a') && (digit <= 'f'))
+	{
+		return digit - 'a' + 10;
+	}
+
+	return -1;
+}
+
+void BusTraceReplay::parse_line(const char * line)
+{
+	if (strncmp(line, "BUSTRACE", 8) == 0)
+	{
+		m_inDump = true;
+		return;
+	}
+
+	if (!m_inDump)
+	{
+		return;
+	}
+
+	if (strncmp(line, "END", 3) == 0)
+	{
+		m_inDump = false;
+		return;
+	}
+
+	uint8_t RecordL[BUS_TRACE_RECORD_LEN];
+	uint8_t IndexL = 0;
+	while (isxdigit((unsigned char)line[0]) && isxdigit((unsigned char)line[1]))
+	{
+		RecordL[IndexL++] = (uint8_t)((hex_digit(line[0]) << 4) | hex_digit(line[1]));
+		line += 2;
+
+		if (IndexL == BUS_TRACE_RECORD_LEN)
+		{
+			add(RecordL, 1);
+			IndexL = 0;
+		}
+	}
+}
+
+void BusTraceReplay::load(FILE * file)
+{
+	char LineL[512];
+
+	while (fgets(LineL, sizeof(LineL), file) != NULL)
+	{
+		parse_line(LineL);
+	}
+}
+
+void BusTraceReplay::add(const uint8_t * data, size_t count)
+{
+	for (size_t index = 0; index < count; index++)
+	{
+		BusTraceRecord_t RecordL;
+		RecordL.Delta = (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+		RecordL.Control = data[2];
+		RecordL.Data = data[3];
+		m_records.push_back(RecordL);
+
+		data += BUS_TRACE_RECORD_LEN;
+	}
+}
+
+void BusTraceReplay::replay(BusSimulator &sim, bool align)
+{
+	unsigned long LastVisitL[SIM_ADDRESS_COUNT];
+	bool VisitedL[SIM_ADDRESS_COUNT];
+	unsigned long PeriodSumL[SIM_ADDRESS_COUNT];
+	uint32_t PeriodCountL[SIM_ADDRESS_COUNT];
+	std::vector<unsigned long> PeriodsL[SIM_ADDRESS_COUNT];
+	unsigned long LastIowL = 0;
+	bool HasIowL = false;
+	unsigned long TimeL = 0;
+
+	memset(m_histogram, 0, sizeof(m_histogram));
+	memset(m_address, 0, sizeof(m_address));
+	memset(VisitedL, 0, sizeof(VisitedL));
+	memset(PeriodSumL, 0, sizeof(PeriodSumL));
+	memset(PeriodCountL, 0, sizeof(PeriodCountL));
+	m_duration = 0;
+	m_segments = 0;
+
+	// The trace may start mid move, align every rotor to its first phase.
+	bool AlignedL[SIM_AXIS_COUNT];
+	memset(AlignedL, 0, sizeof(AlignedL));
+	for (size_t index = 0; align && (index < m_records.size()); index++)
+	{
+		const BusTraceRecord_t &RecordL = m_records[index];
+		uint8_t AddressL = RecordL.Control & 0x07;
+		if (((RecordL.Control >> 4) != BusStrobes::StrobeIOW) ||
+			(AddressL >= SIM_AXIS_COUNT) || AlignedL[AddressL])
+		{
+			continue;
+		}
+
+		uint8_t PhaseL = BusSimulator::coils_to_phase((~RecordL.Data) & 0x0F);
+		if (PhaseL != SIM_PHASE_NONE)
+		{
+			sim.set_rotor_phase(AddressL, PhaseL);
+			AlignedL[AddressL] = true;
+		}
+	}
+
+	for (size_t index = 0; index < m_records.size(); index++)
+	{
+		const BusTraceRecord_t &RecordL = m_records[index];
+		uint8_t AddressL = RecordL.Control & 0x07;
+		uint8_t StrobeL = RecordL.Control >> 4;
+
+		// Restart marker, intervals do not span it.
+		if (RecordL.Delta == BUS_TRACE_DELTA_MAX)
+		{
+			m_segments++;
+			HasIowL = false;
+			memset(VisitedL, 0, sizeof(VisitedL));
+		}
+		else
+		{
+			m_duration += RecordL.Delta;
+		}
+		TimeL += RecordL.Delta;
+
+		if (StrobeL == BusStrobes::StrobeIOR)
+		{
+			sim.read_strobe(TimeL, AddressL);
+			continue;
+		}
+
+		sim.write_strobe(TimeL, AddressL, RecordL.Data & 0x0F);
+
+		if (HasIowL)
+		{
+			unsigned long BinL = (TimeL - LastIowL) / m_binWidth;
+			if (BinL >= REPLAY_BINS_COUNT)
+			{
+				BinL = REPLAY_BINS_COUNT - 1;
+			}
+			m_histogram[BinL]++;
+		}
+		LastIowL = TimeL;
+		HasIowL = true;
+
+		m_address[AddressL].Visits++;
+		if (VisitedL[AddressL])
+		{
+			unsigned long PeriodL = TimeL - LastVisitL[AddressL];
+			PeriodsL[AddressL].push_back(PeriodL);
+			PeriodSumL[AddressL] += PeriodL;
+			PeriodCountL[AddressL]++;
+			if (PeriodL > m_address[AddressL].MaxPeriod)
+			{
+				m_address[AddressL].MaxPeriod = PeriodL;
+			}
+		}
+		LastVisitL[AddressL] = TimeL;
+		VisitedL[AddressL] = true;
+	}
+
+	for (uint8_t address = 0; address < SIM_ADDRESS_COUNT; address++)
+	{
+		if (PeriodCountL[address] == 0)
+		{
+			continue;
+		}
+
+		m_address[address].MeanPeriod = PeriodSumL[address] / PeriodCountL[address];
+		for (size_t index = 0; index < PeriodsL[address].size(); index++)
+		{
+			if (PeriodsL[address][index] > REPLAY_GAP_FACTOR * m_address[address].MeanPeriod)
+			{
+				m_address[address].Gaps++;
+			}
+		}
+	}
+}
+
+void BusTraceReplay::report(const BusSimulator &sim, FILE * file) const
+{
+	fprintf(file, "records: %u, segments: %u, duration: %lu us\n",
+		(unsigned)m_records.size(), m_segments, m_duration);
+
+	fprintf(file, "\nIOW to IOW period histogram:\n");
+	uint32_t PeakL = 1;
+	for (uint8_t index = 0; index < REPLAY_BINS_COUNT; index++)
+	{
+		if (m_histogram[index] > PeakL)
+		{
+			PeakL = m_histogram[index];
+		}
+	}
+	for (uint8_t index = 0; index < REPLAY_BINS_COUNT; index++)
+	{
+		char BarL[41];
+		uint8_t LengthL = (uint8_t)((m_histogram[index] * 40ULL) / PeakL);
+		memset(BarL, '#', LengthL);
+		BarL[LengthL] = '\0';
+		if (index + 1 < REPLAY_BINS_COUNT)
+		{
+			fprintf(file, "  %6lu - %6lu us %8u %s\n", index * m_binWidth,
+				(index + 1) * m_binWidth - 1, m_histogram[index], BarL);
+		}
+		else
+		{
+			fprintf(file, "  %6lu +        us %8u %s\n", index * m_binWidth, m_histogram[index], BarL);
+		}
+	}
+
+	fprintf(file, "\naddress  visits  mean us   max us  gaps  steps  steps/s  illegal  missed\n");
+	for (uint8_t address = 0; address < SIM_ADDRESS_COUNT; address++)
+	{
+		const ReplayAddress_t &AddressL = m_address[address];
+		fprintf(file, "%7u %7u %8lu %8lu %5u", address, AddressL.Visits,
+			AddressL.MeanPeriod, AddressL.MaxPeriod, AddressL.Gaps);
+		if (address < SIM_AXIS_COUNT)
+		{
+			const SimAxis_t &AxisL = sim.axis(address);
+			double RateL = (m_duration > 0) ? (AxisL.Steps * 1000000.0 / m_duration) : 0.0;
+			fprintf(file, " %6u %8.1f %8u %7u", AxisL.Steps, RateL, AxisL.IllegalStates, AxisL.MissedSteps);
+		}
+		fprintf(file, "\n");
+	}
+}
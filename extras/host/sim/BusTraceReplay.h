@@ -0,0 +1,161 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// BusTraceReplay.h - feeds a recorded bus trace through the simulator.
+
+#ifndef _BUSTRACEREPLAY_h
+#define _BUSTRACEREPLAY_h
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "BusTrace.h"
+
+#include "BusSimulator.h"
+
+#pragma region Definitions
+
+/** @brief Bins of the slot period histogram, the last one collects the rest. */
+#define REPLAY_BINS_COUNT 16
+
+/** @brief Default width of one histogram bin in us. */
+#define REPLAY_DEFAULT_BIN_WIDTH 250
+
+/** @brief Revisit interval above this many times the mean is a gap. */
+#define REPLAY_GAP_FACTOR 1.5
+
+#pragma endregion
+
+#pragma region Types
+
+/** @brief Statistics of one bus address. */
+typedef struct
+{
+	uint32_t Visits; ///< Count of the IOW strobes.
+	unsigned long MeanPeriod; ///< Mean revisit interval in us.
+	unsigned long MaxPeriod; ///< Longest revisit interval in us.
+	uint32_t Gaps; ///< Revisit intervals above REPLAY_GAP_FACTOR times the mean.
+} ReplayAddress_t;
+
+#pragma endregion
+
+class BusTraceReplay
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Decoded records, oldest first. */
+	std::vector<BusTraceRecord_t> m_records;
+
+	/** @brief A dump is being parsed. */
+	bool m_inDump;
+
+	/** @brief Width of one histogram bin in us. */
+	unsigned long m_binWidth;
+
+	/** @brief IOW to IOW interval histogram. */
+	uint32_t m_histogram[REPLAY_BINS_COUNT];
+
+	/** @brief Per address statistics. */
+	ReplayAddress_t m_address[SIM_ADDRESS_COUNT];
+
+	/** @brief Traced time without the restart gaps in us. */
+	unsigned long m_duration;
+
+	/** @brief Count of the restart markers. */
+	uint32_t m_segments;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	BusTraceReplay();
+
+	/** @brief Drop records and results.
+	 *  @return Void.
+	 */
+	void clear();
+
+	/** @brief Parse one line of a BusTraceClass::dump(), other lines are skipped.
+	 *  @param line const char *, Text line.
+	 *  @return Void.
+	 */
+	void parse_line(const char * line);
+
+	/** @brief Parse a whole dump.
+	 *  @param file FILE *, Input.
+	 *  @return Void.
+	 */
+	void load(FILE * file);
+
+	/** @brief Add serialised records, as BusTraceRead returns them.
+	 *  @param data const uint8_t *, Records.
+	 *  @param count size_t, Count of the records.
+	 *  @return Void.
+	 */
+	void add(const uint8_t * data, size_t count);
+
+	/** @brief Count of the loaded records.
+	 *  @return size_t, Count.
+	 */
+	size_t count() const { return m_records.size(); }
+
+	/** @brief Set the histogram resolution.
+	 *  @param us unsigned long, Width of one bin.
+	 *  @return Void.
+	 */
+	void set_bin_width(unsigned long us) { m_binWidth = us; }
+
+	/** @brief Feed the records through the simulator and collect statistics.
+	 *  @param sim BusSimulator, Simulator, not attached to the HAL.
+	 *  @param align bool, Start every rotor at its first traced phase, for
+	 *  traces that begin mid move. Otherwise the rotors start at position 0.
+	 *  @return Void.
+	 */
+	void replay(BusSimulator &sim, bool align = false);
+
+	uint32_t bin(uint8_t index) const { return m_histogram[index]; }
+
+	unsigned long bin_width() const { return m_binWidth; }
+
+	const ReplayAddress_t & address(uint8_t address) const { return m_address[address]; }
+
+	unsigned long duration() const { return m_duration; }
+
+	uint32_t segments() const { return m_segments; }
+
+	/** @brief Print histogram, step rates and gaps.
+	 *  @param sim BusSimulator, Simulator the trace was replayed through.
+	 *  @param file FILE *, Output.
+	 *  @return Void.
+	 */
+	void report(const BusSimulator &sim, FILE * file) const;
+
+#pragma endregion
+
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "LogDecoder.h"
+
+LogDecoder::LogDecoder()
+{
+	m_timestamps = false;
+	clear();
+}
+
+void LogDecoder::clear()
+{
+	for (uint16_t index = 0; index < LOG_DECODER_IDS; index++)
+	{
+		m_formats[index].clear();
+	}
+	m_pending.clear();
+	m_records = 0;
+	m_dropped = 0;
+	m_skipped = 0;
+	m_unknown = 0;
+}
+
+size_t LogDecoder::decode_frame(Print &out)
+{
+	const uint8_t * FrameL = m_pending.data();
+	size_t SizeL = m_pending.size();
+
+	if (FrameL[0] == DEFERRED_LOG_MARK_RESTART)
+	{
+		for (uint16_t index = 0; index < LOG_DECODER_IDS; index++)
+		{
+			m_formats[index].clear();
+		}
+		return 1;
+	}
+
+	if (FrameL[0] == DEFERRED_LOG_MARK_DROPPED)
+	{
+		if (SizeL < 5)
+		{
+			return 0;
+		}
+
+		uint32_t CountL;
+		memcpy(&CountL, &FrameL[1], sizeof(CountL));
+		m_dropped += CountL;
+		out.printf("[log: %u dropped]\r\n", (unsigned)CountL);
+		return 5;
+	}
+
+	if ((FrameL[0] != DEFERRED_LOG_MARK_FORMAT) && (FrameL[0] != DEFERRED_LOG_MARK_RECORD))
+	{
+		m_skipped++;
+		return 1;
+	}
+
+	if ((SizeL < 3) || (SizeL < 3 + (size_t)FrameL[2]))
+	{
+		return 0;
+	}
+
+	uint8_t IdL = FrameL[1];
+	uint8_t LengthL = FrameL[2];
+	const uint8_t * BodyL = &FrameL[3];
+
+	if (FrameL[0] == DEFERRED_LOG_MARK_FORMAT)
+	{
+		m_formats[IdL].assign((const char *)BodyL, LengthL);
+		return 3 + LengthL;
+	}
+
+	if ((m_formats[IdL].empty()) || (LengthL < sizeof(uint32_t)))
+	{
+		m_unknown++;
+		return 3 + LengthL;
+	}
+
+	uint32_t TimestampL;
+	memcpy(&TimestampL, BodyL, sizeof(TimestampL));
+	if (m_timestamps)
+	{
+		out.printf("%10u ", (unsigned)TimestampL);
+	}
+
+	DeferredLogClass::render(out, m_formats[IdL].c_str(), BodyL + sizeof(TimestampL), LengthL - sizeof(TimestampL));
+	m_records++;
+
+	return 3 + LengthL;
+}
+
+void LogDecoder::feed(const uint8_t * data, size_t size, Print &out)
+{
+	m_pending.insert(m_pending.end(), data, data + size);
+
+	size_t ConsumedL = 0;
+	while (!m_pending.empty())
+	{
+		ConsumedL = decode_frame(out);
+		if (ConsumedL == 0)
+		{
+			break;
+		}
+		m_pending.erase(m_pending.begin(), m_pending.begin() + ConsumedL);
+	}
+}
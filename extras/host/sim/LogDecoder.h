@@ -0,0 +1,116 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// LogDecoder.h - renders the binary DeferredLog stream on the host.
+
+#ifndef _LOGDECODER_h
+#define _LOGDECODER_h
+
+#include <string>
+
+#include <vector>
+
+#include "DeferredLog.h"
+
+#pragma region Definitions
+
+/** @brief Largest binary mode format id plus one. */
+#define LOG_DECODER_IDS 256
+
+#pragma endregion
+
+class LogDecoder
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Format strings by id. */
+	std::string m_formats[LOG_DECODER_IDS];
+
+	/** @brief Bytes of an incomplete frame. */
+	std::vector<uint8_t> m_pending;
+
+	/** @brief Prefix every line with the device timestamp. */
+	bool m_timestamps;
+
+	/** @brief Count of the rendered records. */
+	uint32_t m_records;
+
+	/** @brief Sum of the reported drops. */
+	uint32_t m_dropped;
+
+	/** @brief Bytes outside of any frame. */
+	uint32_t m_skipped;
+
+	/** @brief Records that referenced an unknown format id. */
+	uint32_t m_unknown;
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Decode one frame from the front of the pending bytes.
+	 *  @return size_t, Consumed length, 0 when the frame is incomplete.
+	 */
+	size_t decode_frame(Print &out);
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	LogDecoder();
+
+	/** @brief Forget formats and counters.
+	 *  @return Void.
+	 */
+	void clear();
+
+	/** @brief Prefix the rendered records with the device timestamp.
+	 *  @param enable bool, Enable.
+	 *  @return Void.
+	 */
+	void set_timestamps(bool enable) { m_timestamps = enable; }
+
+	/** @brief Decode a part of the stream, frames may span calls.
+	 *  @param data const uint8_t *, Stream bytes.
+	 *  @param size size_t, Count of the bytes.
+	 *  @param out Print, Rendered text.
+	 *  @return Void.
+	 */
+	void feed(const uint8_t * data, size_t size, Print &out);
+
+	uint32_t records() const { return m_records; }
+
+	uint32_t dropped() const { return m_dropped; }
+
+	uint32_t skipped() const { return m_skipped; }
+
+	uint32_t unknown() const { return m_unknown; }
+
+#pragma endregion
+
+};
+
+#endif
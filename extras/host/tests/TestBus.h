@@ -0,0 +1,53 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// TestBus.h - bus pinout shared by the host tests, same as ESP32_Operation.
+
+#ifndef _TESTBUS_h
+#define _TESTBUS_h
+
+#include "BusConfig.h"
+
+/** @brief Bus pinout of the ESP32_Operation sketch.
+ *  @return BusConfig_t, Pin configuration.
+ */
+inline BusConfig_t test_bus_config()
+{
+	BusConfig_t ConfigL = {
+		33, // AO0
+		25, // AO1
+		26, // AO2
+		15, // IOR
+		32, // IOW
+		13, // DI0
+		12, // DI1
+		14, // DI2
+		27, // DI3
+		35, // DO0
+		34, // DO1
+		39, // DO2
+		36, // DO3
+	};
+
+	return ConfigL;
+}
+
+#endif
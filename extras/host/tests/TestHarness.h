@@ -0,0 +1,81 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// TestHarness.h - minimal self registering test cases.
+
+#ifndef _TESTHARNESS_h
+#define _TESTHARNESS_h
+
+#include <stdio.h>
+
+#pragma region Types
+
+/** @brief Test case body. */
+typedef void (*TestFunction)();
+
+/** @brief Adds the test case to the list at static init. */
+class TestRegistrar
+{
+
+	public:
+
+	TestRegistrar(const char * name, TestFunction function);
+
+};
+
+#pragma endregion
+
+#pragma region Variables
+
+/** @brief Count of the failed checks in the current test case. */
+extern int TestFailures_g;
+
+#pragma endregion
+
+#pragma region Macros
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static TestRegistrar name##_registrar(#name, name); \
+	static void name()
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			TestFailures_g++; \
+		} \
+	} while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		long long ActualL = (long long)(actual); \
+		long long ExpectedL = (long long)(expected); \
+		if (ActualL != ExpectedL) { \
+			fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+				__FILE__, __LINE__, #actual, #expected, ActualL, ExpectedL); \
+			TestFailures_g++; \
+		} \
+	} while (0)
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,81 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "TestHarness.h"
+
+#pragma region Definitions
+
+/** @brief Maximum count of the test cases in one binary. */
+#define TEST_CASES_MAX 64
+
+#pragma endregion
+
+#pragma region Variables
+
+int TestFailures_g;
+
+/** @brief Registered test case names. */
+static const char * TestNames_g[TEST_CASES_MAX];
+
+/** @brief Registered test case bodies. */
+static TestFunction TestFunctions_g[TEST_CASES_MAX];
+
+/** @brief Count of the registered test cases. */
+static int TestCount_g;
+
+#pragma endregion
+
+TestRegistrar::TestRegistrar(const char * name, TestFunction function)
+{
+	if (TestCount_g < TEST_CASES_MAX)
+	{
+		TestNames_g[TestCount_g] = name;
+		TestFunctions_g[TestCount_g] = function;
+		TestCount_g++;
+	}
+}
+
+int main()
+{
+	int FailedL = 0;
+
+	for (int index = 0; index < TestCount_g; index++)
+	{
+		// Every case starts on a clean bench.
+		host_reset();
+		TestFailures_g = 0;
+
+		printf("[ RUN  ] %s\n", TestNames_g[index]);
+		TestFunctions_g[index]();
+		printf("[ %s ] %s\n", (TestFailures_g == 0) ? " OK " : "FAIL", TestNames_g[index]);
+
+		if (TestFailures_g != 0)
+		{
+			FailedL++;
+		}
+	}
+
+	printf("%d of %d test cases passed\n", TestCount_g - FailedL, TestCount_g);
+
+	return (FailedL == 0) ? 0 : 1;
+}
@@ -0,0 +1,631 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "Robko01.h"
+
+#include "BusSimulator.h"
+
+#include "TestBus.h"
+
+#include "TestHarness.h"
+
+/** @brief Run the bus scheduler for the given virtual time.
+ *  @return Void.
+ */
+static void run_for(Robko01Class &robot, unsigned long us)
+{
+	unsigned long EndL = micros() + us;
+	while (micros() < EndL)
+	{
+		robot.update();
+		host_advance_micros(10);
+	}
+}
+
+TEST_CASE(sim_follows_every_axis)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointPosition_t TargetL;
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.BasePos = 30;
+	TargetL.BaseSpeed = 100;
+	TargetL.ShoulderPos = -25;
+	TargetL.ShoulderSpeed = 100;
+	TargetL.ElbowPos = 7;
+	TargetL.ElbowSpeed = 50;
+	TargetL.LeftDiffPos = -3;
+	TargetL.LeftDiffSpeed = 100;
+	TargetL.RightDiffPos = 12;
+	TargetL.RightDiffSpeed = 100;
+	TargetL.GripperPos = -18;
+	TargetL.GripperSpeed = 100;
+	RobotL.move_absolute(TargetL);
+
+	run_for(RobotL, 5000000UL);
+
+	JointState32_t StateL = RobotL.get_state32();
+	for (uint8_t axis = 0; axis < SIM_AXIS_COUNT; axis++)
+	{
+		// Full step mode, one step is two half steps.
+		CHECK_EQ(SimL.axis(axis).HalfSteps, 2L * StateL.Axis[axis].Position);
+	}
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 60L);
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	CHECK_EQ(SimL.missed_steps(), 0U);
+
+	SimL.detach();
+}
+
+/** @brief Stop a cruising move at the given mode.
+ *  @param mode uint8_t, StopModes value.
+ *  @param sim BusSimulator, Simulator, attached by the call.
+ *  @return unsigned long, Time from the posted stop to the last step in us.
+ */
+static unsigned long stop_latency(uint8_t mode, BusSimulator &sim)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	// The motors follow one step per bus cycle, with a slot of jitter.
+	sim.reset();
+	sim.set_min_step_period((ADDRESS_COUNT - 1) * 1000UL);
+	sim.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Base].Position = 500;
+	TargetL.Axis[AddressIndex::Base].Speed = 100 * JOINT_SPEED_ONE;
+	TargetL.Axis[AddressIndex::Elbow].Position = -500;
+	TargetL.Axis[AddressIndex::Elbow].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+
+	// Cruise, then the opcode arrives in the middle of a slot.
+	run_for(RobotL, 1500000UL + 370UL);
+	unsigned long ReceivedL = micros();
+	CHECK(RobotL.post(MotionCommands::CmdStop, mode));
+	run_for(RobotL, 1000000UL);
+
+	CHECK_EQ(RobotL.get_motor_state(), 0);
+	CHECK_EQ(sim.missed_steps(), 0U);
+	CHECK_EQ(sim.illegal_states(), 0U);
+	sim.detach();
+
+	unsigned long LastL = ReceivedL;
+	for (uint8_t axis = 0; axis < SIM_AXIS_COUNT; axis++)
+	{
+		if ((long)(sim.axis(axis).LastStep - LastL) > 0)
+		{
+			LastL = sim.axis(axis).LastStep;
+		}
+	}
+
+	return LastL - ReceivedL;
+}
+
+TEST_CASE(sim_stop_modes_bound_latency)
+{
+	BusSimulator SimL;
+	// One slot, the command waits for the next one.
+	const unsigned long SlotL = 1000UL;
+	// One bus cycle, every axis is served once per cycle.
+	const unsigned long CycleL = ADDRESS_COUNT * SlotL;
+
+	// Hard, no step after the slot that takes the command.
+	unsigned long HardL = stop_latency(StopModes::StopHard, SimL);
+	CHECK(HardL <= SlotL);
+
+	// Decelerate from 100 steps/s, v / a plus the first ramp step
+	// 0.676 * sqrt(2 / a) and the cycle quantisation.
+	unsigned long QuickL = stop_latency(StopModes::StopQuick, SimL);
+	CHECK(QuickL <= (unsigned long)(1000000.0f * (100.0f / EMERGENCY_ACCELERATION + 0.676f * sqrtf(2.0f / EMERGENCY_ACCELERATION))) + 2 * CycleL);
+
+	unsigned long DecelerateL = stop_latency(StopModes::StopDecelerate, SimL);
+	CHECK(DecelerateL <= (unsigned long)(1000000.0f * (100.0f / DEFAULT_ACCELERATION + 0.676f * sqrtf(2.0f / DEFAULT_ACCELERATION))) + 2 * CycleL);
+	CHECK(HardL < QuickL);
+	CHECK(QuickL < DecelerateL);
+}
+
+TEST_CASE(sim_stop_segment_finishes_move)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Base].Position = 60;
+	TargetL.Axis[AddressIndex::Base].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 200000UL);
+
+	CHECK(RobotL.post(MotionCommands::CmdStop, StopModes::StopSegment));
+	run_for(RobotL, 3000000UL);
+
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 60);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 120L);
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_idle_axis_releases_coils)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+	MotionCommand_t CommandL;
+	memset(&CommandL, 0, sizeof(CommandL));
+	CommandL.Type = MotionCommands::CmdSetIdleTimeout;
+	for (uint8_t axis = 0; axis < AXIS_COUNT; axis++)
+	{
+		CommandL.Timeout[axis] = IDLE_TIMEOUT_KEEP;
+	}
+	CommandL.Timeout[AddressIndex::Gripper] = 100;
+	CHECK(RobotL.post(CommandL));
+	run_for(RobotL, ADDRESS_COUNT * 1000UL);
+	CHECK_EQ(RobotL.get_idle_timeout(AddressIndex::Gripper), 100);
+	CHECK_EQ(RobotL.get_idle_timeout(AddressIndex::Base), IDLE_TIMEOUT);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Gripper].Position = 11;
+	TargetL.Axis[AddressIndex::Gripper].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 1000000UL);
+
+	// Idle for longer than the timeout, the gripper coils are off and the rest hold.
+	Robko01Hold_t HoldL = RobotL.get_hold();
+	CHECK_EQ(HoldL.Released, 1 << AddressIndex::Gripper);
+	CHECK_EQ(SimL.axis(AddressIndex::Gripper).Coils, 0);
+	CHECK(SimL.axis(AddressIndex::Base).Coils != 0);
+	CHECK_EQ(SimL.axis(AddressIndex::Gripper).HalfSteps, 22L);
+
+	// Five axes energised from here on.
+	uint32_t EnergisedL = HoldL.Energised;
+	run_for(RobotL, 1000000UL);
+	uint32_t RateL = RobotL.get_hold().Energised - EnergisedL;
+	CHECK(RateL >= 4990U);
+	CHECK(RateL <= 5010U);
+
+	// The next move locks the last step back on and runs without a missed step.
+	TargetL.Axis[AddressIndex::Gripper].Position = -5;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 50000UL);
+	CHECK_EQ(RobotL.get_hold().Released, 0);
+	run_for(RobotL, 2000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Gripper].Position, -5);
+	CHECK_EQ(SimL.axis(AddressIndex::Gripper).HalfSteps, -10L);
+	CHECK_EQ(SimL.missed_steps(), 0U);
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	CHECK_EQ(RobotL.get_hold().Released, 1 << AddressIndex::Gripper);
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_drive_modes_step_the_shaft)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	SimL.set_min_step_period((ADDRESS_COUNT - 1) * 1000UL);
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	MotionCommand_t CommandL;
+	memset(&CommandL, DRIVE_MODE_KEEP, sizeof(CommandL));
+	CommandL.Type = MotionCommands::CmdSetDriveMode;
+	CommandL.Mode[AddressIndex::Base] = DriveModes::DriveHalf;
+	CommandL.Mode[AddressIndex::Shoulder] = DriveModes::DriveWave;
+	CHECK(RobotL.post(CommandL));
+	run_for(RobotL, 2 * ADDRESS_COUNT * 1000UL);
+
+	// One step per bus cycle, a half step in half mode.
+	Robko01Drive_t DriveL = RobotL.get_drive();
+	CHECK_EQ(DriveL.Mode[AddressIndex::Base], DriveModes::DriveHalf);
+	CHECK_EQ(DriveL.Mode[AddressIndex::Shoulder], DriveModes::DriveWave);
+	CHECK_EQ(DriveL.Mode[AddressIndex::Elbow], DriveModes::DriveFull);
+	CHECK_EQ(DriveL.MaxSpeed[AddressIndex::Base], 125);
+	CHECK_EQ(DriveL.MaxSpeed[AddressIndex::Elbow], 250);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		TargetL.Axis[axis].Position = 10;
+		TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+	}
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 3000000UL);
+
+	// The wave steps sit half a step behind the full ones.
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 10L);
+	CHECK_EQ(SimL.axis(AddressIndex::Shoulder).HalfSteps, 19L);
+	CHECK_EQ(SimL.axis(AddressIndex::Elbow).HalfSteps, 20L);
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	CHECK_EQ(SimL.missed_steps(), 0U);
+
+	// Back to full steps, the position keeps the shaft angle.
+	CHECK(RobotL.set_drive_mode(AddressIndex::Base, DriveModes::DriveFull));
+	run_for(RobotL, 2 * ADDRESS_COUNT * 1000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 5);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 10L);
+
+	// Not while the axis moves.
+	TargetL.Axis[AddressIndex::Base].Position = 50;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 100000UL);
+	CHECK(!RobotL.set_drive_mode(AddressIndex::Base, DriveModes::DriveHalf));
+	CHECK(!RobotL.set_drive_mode(AddressIndex::Elbow, DriveModes::DriveWave + 1));
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_clear_keeps_the_coils)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	SimL.set_min_step_period((ADDRESS_COUNT - 1) * 1000UL);
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	// Half mode on the shoulder, positions off the coil cycle.
+	MotionCommand_t CommandL;
+	memset(&CommandL, DRIVE_MODE_KEEP, sizeof(CommandL));
+	CommandL.Type = MotionCommands::CmdSetDriveMode;
+	CommandL.Mode[AddressIndex::Shoulder] = DriveModes::DriveHalf;
+	CHECK(RobotL.post(CommandL));
+	run_for(RobotL, 2 * ADDRESS_COUNT * 1000UL);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		TargetL.Axis[axis].Position = 3 + axis;
+		TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+	}
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 2000000UL);
+
+	uint8_t CoilsL[3];
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		CoilsL[axis] = SimL.axis(axis).Coils;
+	}
+
+	// The new zero latches the same coils, the rotor does not move.
+	CHECK(RobotL.post(MotionCommands::CmdClear));
+	run_for(RobotL, 4 * ADDRESS_COUNT * 1000UL);
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		CHECK_EQ(RobotL.get_state32().Axis[axis].Position, 0);
+		CHECK_EQ(SimL.axis(axis).Coils, CoilsL[axis]);
+	}
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 6L);
+	CHECK_EQ(SimL.axis(AddressIndex::Shoulder).HalfSteps, 4L);
+	CHECK_EQ(SimL.axis(AddressIndex::Elbow).HalfSteps, 10L);
+
+	// Moves from the new zero step on from there.
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 2000000UL);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 12L);
+	CHECK_EQ(SimL.axis(AddressIndex::Shoulder).HalfSteps, 8L);
+	CHECK_EQ(SimL.axis(AddressIndex::Elbow).HalfSteps, 20L);
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	CHECK_EQ(SimL.missed_steps(), 0U);
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_port_a_round_trip)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+
+	SimL.set_port_a_inputs(0xA5);
+	RobotL.set_port_a(0x3C);
+
+	// One full scan of the eight addresses.
+	run_for(RobotL, 2 * ADDRESS_COUNT * 1000UL);
+
+	CHECK_EQ(RobotL.get_port_a(), 0xA5);
+	CHECK_EQ(SimL.port_a_outputs(), 0x3C);
+	CHECK(SimL.read_strobes() > 0);
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_port_a_events_filter_and_time)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	PortAEvent_t EventsL[PORT_A_EVENTS_SIZE];
+	const unsigned long CycleL = ADDRESS_COUNT * 1000UL;
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+
+	// The first samples are the state, not edges.
+	SimL.set_port_a_inputs(0x80);
+	run_for(RobotL, 3 * CycleL);
+	CHECK_EQ(RobotL.read_port_a_events(EventsL, PORT_A_EVENTS_SIZE), 0);
+
+	// A pulse of two bus cycles, both edges with their times.
+	unsigned long RiseL = micros();
+	SimL.set_port_a_inputs(0x84);
+	run_for(RobotL, 2 * CycleL);
+	SimL.set_port_a_inputs(0x80);
+	run_for(RobotL, 2 * CycleL);
+	CHECK_EQ(RobotL.read_port_a_events(EventsL, PORT_A_EVENTS_SIZE), 2);
+	CHECK_EQ(EventsL[0].Bit, 2);
+	CHECK_EQ(EventsL[0].Level, 1);
+	CHECK_EQ(EventsL[1].Level, 0);
+	CHECK(EventsL[0].Time - RiseL <= CycleL);
+	CHECK(labs((long)(EventsL[1].Time - EventsL[0].Time) - (long)(2 * CycleL)) <= (long)CycleL);
+
+	// Three samples filter the short pulse out, a long level gets through timed at its start.
+	RobotL.set_port_a_filter(2, 3);
+	CHECK_EQ(RobotL.get_port_a_filter(2), 3);
+	SimL.set_port_a_inputs(0x84);
+	run_for(RobotL, CycleL);
+	SimL.set_port_a_inputs(0x80);
+	run_for(RobotL, 2 * CycleL);
+	CHECK_EQ(RobotL.read_port_a_events(EventsL, PORT_A_EVENTS_SIZE), 0);
+	RiseL = micros();
+	SimL.set_port_a_inputs(0x84);
+	run_for(RobotL, 5 * CycleL);
+	CHECK_EQ(RobotL.read_port_a_events(EventsL, PORT_A_EVENTS_SIZE), 1);
+	CHECK(EventsL[0].Time - RiseL <= CycleL);
+
+	// Nobody drains, the full queue counts the dropped edges.
+	CHECK_EQ(RobotL.get_port_a_events_lost(), 0);
+	for (uint8_t index = 0; index < PORT_A_EVENTS_SIZE; index++)
+	{
+		SimL.set_port_a_inputs((index & 1) ? 0x81 : 0x80);
+		run_for(RobotL, CycleL);
+	}
+	CHECK_EQ(RobotL.read_port_a_events(EventsL, PORT_A_EVENTS_SIZE), PORT_A_EVENTS_SIZE - 1);
+	CHECK(RobotL.get_port_a_events_lost() > 0);
+
+	// The count saturates instead of wrapping back to none.
+	for (uint16_t index = 0; index < 300; index++)
+	{
+		SimL.set_port_a_inputs((index & 1) ? 0x80 : 0x81);
+		run_for(RobotL, CycleL);
+	}
+	CHECK_EQ(RobotL.get_port_a_events_lost(), UINT8_MAX);
+
+	SimL.detach();
+}
+
+TEST_CASE(sim_probe_stops_at_the_input)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+	Robko01Probe_t ProbeL;
+	const unsigned long CycleL = ADDRESS_COUNT * 1000UL;
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	// Slow enough to stop in one step.
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Base].Position = 400;
+	TargetL.Axis[AddressIndex::Base].Speed = 20 * JOINT_SPEED_ONE;
+	CHECK_EQ(RobotL.move_until_input(TargetL, 0x00, 0x00), false);
+	CHECK(RobotL.move_until_input(TargetL, 0x04, 0x04));
+	CHECK_EQ(RobotL.get_probe().Status, ProbeStatus::ProbeArmed);
+
+	// The input rises during the move, the base stops in the same cycle.
+	run_for(RobotL, 1000000UL);
+	SimL.set_port_a_inputs(0x04);
+	unsigned long RiseL = micros();
+	run_for(RobotL, CycleL);
+	ProbeL = RobotL.get_probe();
+	CHECK_EQ(ProbeL.Status, ProbeStatus::ProbeTriggered);
+	CHECK_EQ(ProbeL.PortA & 0x04, 0x04);
+	CHECK(ProbeL.Time - RiseL <= CycleL);
+	CHECK(ProbeL.Position[AddressIndex::Base] > 0);
+	CHECK(ProbeL.Position[AddressIndex::Base] < 400);
+	run_for(RobotL, 100000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, ProbeL.Position[AddressIndex::Base]);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 2L * ProbeL.Position[AddressIndex::Base]);
+	CHECK_EQ(RobotL.get_motor_state(), 0);
+
+	// Already matching, nothing moves.
+	long StartL = ProbeL.Position[AddressIndex::Base];
+	CHECK(RobotL.move_until_input(TargetL, 0x04, 0x04));
+	run_for(RobotL, 2 * CycleL);
+	CHECK_EQ(RobotL.get_probe().Status, ProbeStatus::ProbeTriggered);
+	CHECK_EQ(RobotL.get_probe().Position[AddressIndex::Base], StartL);
+
+	// Waiting for a low level that never comes, the move runs to its end.
+	TargetL.Axis[AddressIndex::Base].Position = StartL + 20;
+	CHECK(RobotL.move_until_input(TargetL, 0x04, 0x00));
+	run_for(RobotL, 3000000UL);
+	CHECK_EQ(RobotL.get_probe().Status, ProbeStatus::ProbeMissed);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, StartL + 20);
+
+	// Another move ends the armed probe.
+	CHECK(RobotL.move_until_input(TargetL, 0x04, 0x00));
+	RobotL.stop_motors();
+	CHECK_EQ(RobotL.get_probe().Status, ProbeStatus::ProbeAborted);
+
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	SimL.detach();
+}
+
+TEST_CASE(sim_triggers_set_outputs_on_the_path)
+{
+	Robko01Class RobotL;
+	BusSimulator SimL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+	PortATrigger_t TriggerL;
+	const unsigned long CycleL = ADDRESS_COUNT * 1000UL;
+	long StepAtL[2] = { -1, -1 };
+
+	SimL.attach(ConfigL);
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	// Bit 0 at step 30, bit 1 at the middle, bit 0 off again at the target.
+	memset(&TriggerL, 0, sizeof(TriggerL));
+	TriggerL.Axis = AddressIndex::Base;
+	TriggerL.Kind = TriggerKinds::TriggerStep;
+	TriggerL.Value = 30;
+	TriggerL.Mask = 0x01;
+	TriggerL.Level = 0x01;
+	CHECK(RobotL.add_trigger(TriggerL));
+	TriggerL.Kind = TriggerKinds::TriggerFraction;
+	TriggerL.Value = TRIGGER_FRACTION_ONE / 2;
+	TriggerL.Mask = 0x02;
+	TriggerL.Level = 0x02;
+	CHECK(RobotL.add_trigger(TriggerL));
+	TriggerL.Value = TRIGGER_FRACTION_ONE;
+	TriggerL.Mask = 0x01;
+	TriggerL.Level = 0x00;
+	CHECK(RobotL.add_trigger(TriggerL));
+	TriggerL.Value = TRIGGER_FRACTION_ONE + 1;
+	CHECK_EQ(RobotL.add_trigger(TriggerL), false);
+	CHECK_EQ(RobotL.get_triggers().Pending, 3);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Base].Position = 100;
+	TargetL.Axis[AddressIndex::Base].Speed = 50 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+	CHECK_EQ(RobotL.get_triggers().Pending, 0);
+	CHECK_EQ(RobotL.get_triggers().Armed, 0x07);
+
+	// Every output changes in the bus cycle in which the base reaches the step.
+	for (uint16_t cycle = 0; cycle < 5000; cycle++)
+	{
+		run_for(RobotL, CycleL);
+		long StepL = SimL.axis(AddressIndex::Base).HalfSteps / 2;
+		for (uint8_t bit = 0; bit < 2; bit++)
+		{
+			if ((StepAtL[bit] < 0) && bitRead(SimL.port_a_outputs(), bit))
+			{
+				StepAtL[bit] = StepL;
+			}
+		}
+		if (RobotL.get_motor_state() == 0)
+		{
+			break;
+		}
+	}
+	CHECK_EQ(StepAtL[0], 30L);
+	CHECK_EQ(StepAtL[1], 50L);
+	CHECK_EQ(SimL.port_a_outputs() & 0x03, 0x02);
+	CHECK_EQ(RobotL.get_triggers().Fired, 0x07);
+	CHECK_EQ(RobotL.get_triggers().Armed, 0);
+
+	// The triggers belong to one move, the next one runs without them.
+	TargetL.Axis[AddressIndex::Base].Position = 0;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 3000000UL);
+	CHECK_EQ(RobotL.get_triggers().Fired, 0);
+	CHECK_EQ(SimL.port_a_outputs() & 0x03, 0x02);
+
+	// Behind the start in the direction of the move, a stop drops it.
+	TriggerL.Kind = TriggerKinds::TriggerStep;
+	TriggerL.Value = -10;
+	TriggerL.Mask = 0x02;
+	TriggerL.Level = 0x00;
+	CHECK(RobotL.add_trigger(TriggerL));
+	TargetL.Axis[AddressIndex::Base].Position = 50;
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 500000UL);
+	CHECK_EQ(RobotL.get_triggers().Armed, 0x01);
+	RobotL.stop_motors(StopModes::StopHard);
+	CHECK_EQ(RobotL.get_triggers().Armed, 0);
+	CHECK_EQ(SimL.port_a_outputs() & 0x03, 0x02);
+
+	CHECK_EQ(SimL.illegal_states(), 0U);
+	SimL.detach();
+}
+
+TEST_CASE(sim_flags_illegal_sequences)
+{
+	BusSimulator SimL;
+
+	// FULL4WIRE pins at positions 0, 1 and 3, position 2 is skipped.
+	SimL.write_strobe(0, AddressIndex::Base, 0b0101);
+	SimL.write_strobe(1000, AddressIndex::Base, 0b0110);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 2L);
+	SimL.write_strobe(2000, AddressIndex::Base, 0b1001);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 2L);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).IllegalStates, 1U);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).MissedSteps, 1U);
+
+	// Two opposite coils, not a phase.
+	SimL.write_strobe(3000, AddressIndex::Elbow, 0b1100);
+	CHECK_EQ(SimL.axis(AddressIndex::Elbow).IllegalStates, 1U);
+
+	// All coils off, the rotor stays.
+	SimL.write_strobe(4000, AddressIndex::Base, 0b1111);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).Coils, 0);
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 2L);
+}
+
+TEST_CASE(sim_detects_missed_steps)
+{
+	BusSimulator SimL;
+
+	SimL.set_min_step_period(5000);
+
+	// Backwards through the FULL4WIRE table every millisecond.
+	SimL.write_strobe(0, AddressIndex::Gripper, 0b1001);
+	SimL.write_strobe(1000, AddressIndex::Gripper, 0b1010);
+
+	CHECK_EQ(SimL.axis(AddressIndex::Gripper).HalfSteps, -2L);
+	CHECK_EQ(SimL.axis(AddressIndex::Gripper).MissedSteps, 1U);
+}
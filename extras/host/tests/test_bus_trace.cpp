@@ -0,0 +1,149 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "Robko01.h"
+
+#include "BusSimulator.h"
+
+#include "BusTraceReplay.h"
+
+#include "TestBus.h"
+
+#include "TestHarness.h"
+
+/** @brief Run the bus scheduler for the given virtual time.
+ *  @return Void.
+ */
+static void run_for(Robko01Class &robot, unsigned long us)
+{
+	unsigned long EndL = micros() + us;
+	while (micros() < EndL)
+	{
+		robot.update();
+		host_advance_micros(10);
+	}
+}
+
+TEST_CASE(trace_records_strobes)
+{
+	BusTraceClass TraceL;
+	uint8_t BufferL[3 * BUS_TRACE_RECORD_LEN];
+
+	// Disabled by default.
+	TraceL.record(10, BusStrobes::StrobeIOW, 1, 0x5, 0);
+	CHECK_EQ(TraceL.count(), 0);
+
+	TraceL.enable(true);
+	TraceL.record(100, BusStrobes::StrobeIOW, 2, 0x6, 0);
+	TraceL.record(350, BusStrobes::StrobeIOR, 6, 0xF, 0xA);
+	CHECK_EQ(TraceL.count(), 2);
+
+	CHECK_EQ(TraceL.read(0, BufferL, sizeof(BufferL)), 2);
+	// First record marks the start of the time base.
+	CHECK_EQ(BufferL[0], 0xFF);
+	CHECK_EQ(BufferL[1], 0xFF);
+	CHECK_EQ(BufferL[2], (BusStrobes::StrobeIOW << 4) | 2);
+	CHECK_EQ(BufferL[3], 0x06);
+	CHECK_EQ(BufferL[4], 250);
+	CHECK_EQ(BufferL[5], 0);
+	CHECK_EQ(BufferL[6], (BusStrobes::StrobeIOR << 4) | 6);
+	CHECK_EQ(BufferL[7], 0xAF);
+}
+
+TEST_CASE(trace_ring_wraps)
+{
+	BusTraceClass TraceL;
+	uint8_t BufferL[BUS_TRACE_RECORD_LEN];
+
+	TraceL.enable(true);
+	for (uint16_t index = 0; index < BUS_TRACE_SIZE + 10; index++)
+	{
+		TraceL.record(index * 1000UL, BusStrobes::StrobeIOW, index & 0x07, 0, 0);
+	}
+
+	CHECK_EQ(TraceL.count(), BUS_TRACE_SIZE);
+	CHECK_EQ(TraceL.overwritten(), 10U);
+
+	// Oldest kept record is the 11th one.
+	CHECK_EQ(TraceL.read(0, BufferL, sizeof(BufferL)), 1);
+	CHECK_EQ(BufferL[2] & 0x07, 10 & 0x07);
+	CHECK_EQ(TraceL.read(BUS_TRACE_SIZE, BufferL, sizeof(BufferL)), 0);
+}
+
+TEST_CASE(trace_replay_matches_robot)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointPosition_t TargetL;
+	MemoryStream DumpL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+	RobotL.bus_trace().enable(true);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.BasePos = 12;
+	TargetL.BaseSpeed = 100;
+	TargetL.ElbowPos = -9;
+	TargetL.ElbowSpeed = 100;
+	RobotL.move_absolute(TargetL);
+
+	// Short enough to fit the ring.
+	run_for(RobotL, 100UL * (BUS_TRACE_SIZE / 2));
+	CHECK_EQ(RobotL.bus_trace().overwritten(), 0U);
+
+	RobotL.bus_trace().dump(DumpL);
+	DumpL.write((const uint8_t *)"\0", 1);
+
+	BusTraceReplay ReplayL;
+	const char * TextL = (const char *)DumpL.tx().data();
+	while (*TextL != '\0')
+	{
+		ReplayL.parse_line(TextL);
+		const char * NextL = strchr(TextL, '\n');
+		TextL = (NextL == NULL) ? "" : NextL + 1;
+	}
+	CHECK_EQ(ReplayL.count(), RobotL.bus_trace().count());
+
+	BusSimulator SimL;
+	ReplayL.replay(SimL);
+
+	JointState32_t StateL = RobotL.get_state32();
+	CHECK_EQ(SimL.axis(AddressIndex::Base).HalfSteps, 2L * StateL.Axis[AddressIndex::Base].Position);
+	CHECK_EQ(SimL.axis(AddressIndex::Elbow).HalfSteps, 2L * StateL.Axis[AddressIndex::Elbow].Position);
+	CHECK_EQ(SimL.illegal_states(), 0U);
+
+	// One address per millisecond plus the strobe time.
+	uint8_t PeakL = 0;
+	for (uint8_t index = 0; index < REPLAY_BINS_COUNT; index++)
+	{
+		if (ReplayL.bin(index) > ReplayL.bin(PeakL))
+		{
+			PeakL = index;
+		}
+	}
+	CHECK_EQ(PeakL, 1000 / REPLAY_DEFAULT_BIN_WIDTH);
+	CHECK_EQ(ReplayL.address(AddressIndex::Base).Gaps, 0U);
+	CHECK(ReplayL.address(AddressIndex::Base).MeanPeriod >= 8000UL);
+	CHECK(ReplayL.address(AddressIndex::Base).MeanPeriod < 9000UL);
+}
@@ -0,0 +1,164 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "JointPositionDelta.h"
+
+#include "JointPositionUnion.h"
+
+#include "JointState32.h"
+
+#include "TestHarness.h"
+
+TEST_CASE(delta_single_field_is_short)
+{
+	JointPositionDelta EncoderL;
+	JointPosition_t PositionL;
+	uint8_t BufferL[JPOS_DELTA_MAX_LEN];
+
+	memset(&PositionL, 0, sizeof(PositionL));
+	PositionL.ElbowPos = -3;
+
+	// Mask plus one byte of zigzag.
+	CHECK_EQ(EncoderL.encode(PositionL, BufferL, sizeof(BufferL)), 3);
+	CHECK_EQ(BufferL[0], 1 << 4);
+	CHECK_EQ(BufferL[1], 0);
+	CHECK_EQ(BufferL[2], 5);
+}
+
+TEST_CASE(delta_round_trip)
+{
+	JointPositionDelta EncoderL;
+	JointPositionDelta DecoderL;
+	JointPosition_t ReferenceL;
+	JointPosition_t PositionL;
+	JointPosition_t DecodedL;
+	int16_t FieldsL[JPOS_FIELDS_COUNT];
+	uint8_t BufferL[JPOS_DELTA_MAX_LEN];
+
+	srand(26);
+	for (int iteration = 0; iteration < 10000; iteration++)
+	{
+		for (uint8_t index = 0; index < JPOS_FIELDS_COUNT; index++)
+		{
+			FieldsL[index] = (int16_t)rand();
+		}
+		memcpy(&ReferenceL, FieldsL, sizeof(ReferenceL));
+
+		for (uint8_t index = 0; index < JPOS_FIELDS_COUNT; index++)
+		{
+			if (rand() % 2)
+			{
+				FieldsL[index] = (int16_t)rand();
+			}
+		}
+		memcpy(&PositionL, FieldsL, sizeof(PositionL));
+
+		EncoderL.set_reference(ReferenceL);
+		DecoderL.set_reference(ReferenceL);
+
+		uint8_t LengthL = EncoderL.encode(PositionL, BufferL, sizeof(BufferL));
+		CHECK(LengthL >= JPOS_DELTA_MASK_LEN);
+		CHECK_EQ(DecoderL.decode(BufferL, LengthL, DecodedL), LengthL);
+		CHECK(memcmp(&PositionL, &DecodedL, sizeof(JointPosition_t)) == 0);
+	}
+}
+
+TEST_CASE(delta_rejects_malformed)
+{
+	JointPositionDelta DecoderL;
+	JointPosition_t DecodedL;
+
+	// Reserved mask bit.
+	const uint8_t ReservedL[] = { 0x00, 0x10 };
+	CHECK_EQ(DecoderL.decode(ReservedL, sizeof(ReservedL), DecodedL), 0);
+
+	// Varint runs past the end.
+	const uint8_t TruncatedL[] = { 0x01, 0x00, 0x80 };
+	CHECK_EQ(DecoderL.decode(TruncatedL, sizeof(TruncatedL), DecodedL), 0);
+
+	// Third group above bit 15.
+	const uint8_t OverflowL[] = { 0x01, 0x00, 0xFF, 0xFF, 0x07 };
+	CHECK_EQ(DecoderL.decode(OverflowL, sizeof(OverflowL), DecodedL), 0);
+
+	// Third group with bits 14 and 15 only, still valid.
+	const uint8_t TopL[] = { 0x01, 0x00, 0xFF, 0xFF, 0x03 };
+	CHECK_EQ(DecoderL.decode(TopL, sizeof(TopL), DecodedL), 5);
+
+	// Encoder reports a buffer too small.
+	JointPositionDelta EncoderL;
+	JointPosition_t PositionL;
+	uint8_t BufferL[4];
+	memset(&PositionL, 0x7F, sizeof(PositionL));
+	CHECK_EQ(EncoderL.encode(PositionL, BufferL, sizeof(BufferL)), 0);
+
+	// A delta as long as the full state only fits the full budget, the sketches pass one less.
+	int16_t FieldsL[JPOS_FIELDS_COUNT];
+	uint8_t FullL[sizeof(JointPosition_t)];
+	for (uint8_t index = 0; index < JPOS_FIELDS_COUNT; index++)
+	{
+		FieldsL[index] = (index < JPOS_FIELDS_COUNT - 1) ? 100 : 0;
+	}
+	memcpy(&PositionL, FieldsL, sizeof(PositionL));
+	EncoderL.reset();
+	CHECK_EQ(EncoderL.encode(PositionL, FullL, sizeof(FullL)), sizeof(JointPosition_t));
+	CHECK_EQ(EncoderL.encode(PositionL, FullL, sizeof(FullL) - 1), 0);
+}
+
+TEST_CASE(state32_widen_and_narrow)
+{
+	JointPosition_t PositionL;
+	JointPosition_t NarrowL;
+	JointState32_t StateL;
+
+	memset(&PositionL, 0, sizeof(PositionL));
+	PositionL.BasePos = -1200;
+	PositionL.BaseSpeed = -300;
+	PositionL.GripperPos = INT16_MAX;
+	PositionL.GripperSpeed = 50;
+
+	ConvertJpos2Jstate(PositionL, StateL);
+	CHECK_EQ(StateL.Axis[0].Position, -1200);
+	CHECK_EQ(StateL.Axis[0].Speed, -300 * JOINT_SPEED_ONE);
+	CHECK_EQ(StateL.Axis[5].Position, INT16_MAX);
+
+	CHECK(ConvertJstate2Jpos(StateL, NarrowL));
+	CHECK(memcmp(&PositionL, &NarrowL, sizeof(JointPosition_t)) == 0);
+
+	// Out of range positions saturate and are reported.
+	StateL.Axis[1].Position = 70000;
+	CHECK(!ConvertJstate2Jpos(StateL, NarrowL));
+	CHECK_EQ(NarrowL.ShoulderPos, INT16_MAX);
+}
+
+TEST_CASE(state32_buffer_is_little_endian)
+{
+	JointState32Union StateL;
+	uint8_t BufferL[sizeof(JointState32_t)];
+
+	memset(BufferL, 0, sizeof(BufferL));
+	BufferL[4] = 0x00;
+	BufferL[5] = 0x01;
+
+	ConvertJstate2Buff(StateL.Value, BufferL);
+	CHECK_EQ(StateL.Value.Axis[0].Speed, JOINT_SPEED_ONE);
+}
@@ -0,0 +1,174 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include <string>
+
+#include "DeferredLog.h"
+
+#include "LogDecoder.h"
+
+#include "TestHarness.h"
+
+/** @brief Text written to the stream so far.
+ *  @return std::string, Text.
+ */
+static std::string text_of(MemoryStream &stream)
+{
+	return std::string(stream.tx().begin(), stream.tx().end());
+}
+
+/** @brief Compare and print both texts on mismatch.
+ *  @return bool, Equal.
+ */
+static bool same_text(const std::string &actual, const std::string &expected)
+{
+	if (actual != expected)
+	{
+		fprintf(stderr, "  got      \"%s\"\n  expected \"%s\"\n", actual.c_str(), expected.c_str());
+		return false;
+	}
+	return true;
+}
+
+TEST_CASE(deferred_text_matches_printf)
+{
+	DeferredLogClass LogL;
+	MemoryStream OutL;
+	char ExpectedL[256];
+	char NameL[] = "Elbow";
+	long BigL = -1234567L;
+	uint8_t ByteL = 0xA5;
+	uint16_t WordL = 65000;
+
+	LogL.begin(OutL);
+	LogL.log("plain\r\n");
+	LogL.log("%d %u %02X %5s|%-4d|%%\r\n", -42, 7U, ByteL, NameL, 3);
+	LogL.log("%ld %lu %u %.2f %c\r\n", BigL, 4000000000UL, WordL, 3.14159, 'x');
+
+	// Nothing is printed from log().
+	CHECK_EQ(OutL.tx().size(), 0);
+	CHECK(LogL.pending() > 0);
+
+	// The string is copied, the buffer may change before drain().
+	NameL[0] = 'X';
+
+	CHECK_EQ(LogL.drain(), 3);
+	CHECK_EQ(LogL.pending(), 0);
+
+	snprintf(ExpectedL, sizeof(ExpectedL), "plain\r\n%d %u %02X %5s|%-4d|%%\r\n%ld %lu %u %.2f %c\r\n",
+		-42, 7U, ByteL, "Elbow", 3, BigL, 4000000000UL, WordL, 3.14159, 'x');
+	CHECK(same_text(text_of(OutL), ExpectedL));
+}
+
+TEST_CASE(deferred_truncated_record_prints_unknown)
+{
+	DeferredLogClass LogL;
+	MemoryStream OutL;
+	const char LongL[] = "0123456789ABCDEF0123456789ABCDEF";
+
+	LogL.begin(OutL);
+
+	// The second string does not fit, the short number after it must not take its place.
+	LogL.log("%s|%s|%d\r\n", LongL, LongL, 5);
+
+	// A width from '*' longer than the spec buffer is cut, not written past it.
+	LogL.log("%------------*d|\r\n", 12345, 5);
+
+	CHECK_EQ(LogL.drain(), 2);
+	CHECK(same_text(text_of(OutL), "0123456789ABCDEF0123456789ABCDEF|?|?\r\n5           |\r\n"));
+}
+
+TEST_CASE(deferred_counts_drops)
+{
+	DeferredLogClass LogL;
+	MemoryStream OutL;
+	uint16_t QueuedL = 0;
+
+	LogL.begin(OutL);
+	for (uint16_t index = 0; index < DEFERRED_LOG_SIZE; index++)
+	{
+		LogL.log("%u\r\n", index);
+	}
+
+	QueuedL = DEFERRED_LOG_SIZE - (uint16_t)LogL.dropped();
+	CHECK(LogL.dropped() > 0);
+	CHECK(LogL.pending() < DEFERRED_LOG_SIZE);
+
+	uint16_t DrainedL = 0;
+	uint16_t CountL;
+	while ((CountL = LogL.drain()) > 0)
+	{
+		DrainedL += CountL;
+	}
+	CHECK_EQ(DrainedL, QueuedL);
+
+	// Oldest records are kept, the report follows the first drain.
+	std::string TextL = text_of(OutL);
+	CHECK(TextL.compare(0, 6, "0\r\n1\r\n") == 0);
+	char ReportL[48];
+	snprintf(ReportL, sizeof(ReportL), "[log: %u dropped]\r\n", (unsigned)LogL.dropped());
+	CHECK(TextL.find(ReportL) != std::string::npos);
+	CHECK_EQ(TextL.find(ReportL), TextL.rfind(ReportL));
+}
+
+TEST_CASE(deferred_binary_round_trip)
+{
+	DeferredLogClass LogL;
+	MemoryStream TextOutL;
+	MemoryStream BinaryOutL;
+	MemoryStream DecodedL;
+	static const char * FormatL = "axis %d pos %ld\r\n";
+
+	// Same records through both modes.
+	LogL.begin(TextOutL);
+	for (int index = 0; index < 4; index++)
+	{
+		LogL.log(FormatL, index, -1000L * index);
+	}
+	LogL.log("%s\r\n", "done");
+	LogL.drain(16);
+
+	LogL.begin(BinaryOutL, DeferredLogModes::LogBinary);
+	for (int index = 0; index < 4; index++)
+	{
+		LogL.log(FormatL, index, -1000L * index);
+	}
+	LogL.log("%s\r\n", "done");
+	LogL.drain(16);
+
+	// Format strings go out once.
+	std::string BinaryL = text_of(BinaryOutL);
+	CHECK(BinaryL.find("axis %d") != std::string::npos);
+	CHECK_EQ(BinaryL.find("axis %d"), BinaryL.rfind("axis %d"));
+
+	// Split in two to cross a frame boundary.
+	LogDecoder DecoderL;
+	size_t HalfL = BinaryOutL.tx().size() / 2;
+	DecoderL.feed(BinaryOutL.tx().data(), HalfL, DecodedL);
+	DecoderL.feed(BinaryOutL.tx().data() + HalfL, BinaryOutL.tx().size() - HalfL, DecodedL);
+
+	CHECK_EQ(DecoderL.records(), 5);
+	CHECK_EQ(DecoderL.unknown(), 0);
+	CHECK_EQ(DecoderL.skipped(), 0);
+	CHECK(same_text(text_of(DecodedL), text_of(TextOutL)));
+}
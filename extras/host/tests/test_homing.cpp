@@ -0,0 +1,204 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "Homing.h"
+
+#include "TestHarness.h"
+
+/** @brief Switch inputs of the two test axes. */
+#define SWITCH_PIN_0 20
+#define SWITCH_PIN_1 21
+
+/** @brief Instance the switch ISRs latch into. */
+static HomingClass * Homing_g = NULL;
+
+/** @brief Real steps of the two shafts, setCurrentPosition() does not move them. */
+static long Shaft_g[2];
+
+/** @brief Shaft step where each switch closes. */
+static long SwitchAt_g[2];
+
+static void cbForward0() { Shaft_g[0]++; }
+static void cbBackward0() { Shaft_g[0]--; }
+static void cbForward1() { Shaft_g[1]++; }
+static void cbBackward1() { Shaft_g[1]--; }
+
+static void isrSwitch0() { Homing_g->latch(0); }
+static void isrSwitch1() { Homing_g->latch(1); }
+
+/** @brief Homing parameters toward the negative end, active low switch. */
+static HomingAxis_t test_axis(uint8_t pin)
+{
+	HomingAxis_t ConfigL;
+	ConfigL.Pin = pin;
+	ConfigL.ActiveLevel = LOW;
+	ConfigL.Direction = -1;
+	ConfigL.FastSpeed = 2000.0f;
+	ConfigL.SlowSpeed = 100.0f;
+	ConfigL.Backoff = 200;
+	ConfigL.MaxTravel = 5000;
+	ConfigL.Offset = -20;
+	return ConfigL;
+}
+
+/** @brief Run the steppers and the switches for a while.
+ *  @return uint8_t, Most axes moving at the same time.
+ */
+static uint8_t run_homing(HomingClass &homing, AccelStepper * steppers, unsigned long us)
+{
+	uint8_t OverlapL = 0;
+	const uint8_t PinsL[2] = { SWITCH_PIN_0, SWITCH_PIN_1 };
+
+	for (unsigned long elapsed = 0; elapsed < us; elapsed += 20)
+	{
+		host_advance_micros(20);
+		for (uint8_t axis = 0; axis < 2; axis++)
+		{
+			steppers[axis].run();
+			host_set_input(PinsL[axis], (Shaft_g[axis] <= SwitchAt_g[axis]) ? LOW : HIGH);
+		}
+		homing.update();
+
+		uint8_t CountL = steppers[0].isRunning() + steppers[1].isRunning();
+		if (CountL > OverlapL)
+		{
+			OverlapL = CountL;
+		}
+	}
+
+	return OverlapL;
+}
+
+/** @brief Two axes with their switches attached. */
+static void setup_axes(HomingClass &homing, AccelStepper * steppers)
+{
+	Homing_g = &homing;
+	memset(Shaft_g, 0, sizeof(Shaft_g));
+	SwitchAt_g[0] = -1500;
+	SwitchAt_g[1] = -700;
+
+	steppers[0] = AccelStepper(cbForward0, cbBackward0);
+	steppers[1] = AccelStepper(cbForward1, cbBackward1);
+	for (uint8_t axis = 0; axis < 2; axis++)
+	{
+		steppers[axis].setAcceleration(20000.0f);
+		steppers[axis].setMaxSpeed(500.0f);
+	}
+
+	host_set_input(SWITCH_PIN_0, HIGH);
+	host_set_input(SWITCH_PIN_1, HIGH);
+	attachInterrupt(digitalPinToInterrupt(SWITCH_PIN_0), isrSwitch0, FALLING);
+	attachInterrupt(digitalPinToInterrupt(SWITCH_PIN_1), isrSwitch1, FALLING);
+
+	CHECK(homing.attach(0, &steppers[0], test_axis(SWITCH_PIN_0)));
+	CHECK(homing.attach(1, &steppers[1], test_axis(SWITCH_PIN_1)));
+}
+
+TEST_CASE(homing_parallel_zeroes_at_switch_edge)
+{
+	HomingClass HomingL;
+	AccelStepper SteppersL[2];
+	setup_axes(HomingL, SteppersL);
+
+	// Axis 2 has no switch.
+	CHECK(!HomingL.start(0x04, HomeFlags::HomeParallel));
+	CHECK(HomingL.start(0x03, HomeFlags::HomeParallel));
+	CHECK(!HomingL.start(0x03, HomeFlags::HomeParallel));
+
+	uint8_t OverlapL = run_homing(HomingL, SteppersL, 3000000UL);
+	CHECK_EQ(OverlapL, 2);
+	CHECK_EQ(HomingL.get_active(), 0);
+	CHECK_EQ(HomingL.get_homed(), 0x03);
+	CHECK_EQ(HomingL.get_failed(), 0);
+
+	// The step that closed the switch is the offset, the fast overshoot does not count.
+	for (uint8_t axis = 0; axis < 2; axis++)
+	{
+		CHECK_EQ(SteppersL[axis].currentPosition() - Shaft_g[axis], -20 - SwitchAt_g[axis]);
+		CHECK_EQ(SteppersL[axis].maxSpeed(), 500.0f);
+	}
+}
+
+TEST_CASE(homing_sequential_one_axis_at_a_time)
+{
+	HomingClass HomingL;
+	AccelStepper SteppersL[2];
+	setup_axes(HomingL, SteppersL);
+
+	CHECK(HomingL.start(0x03, 0));
+	CHECK_EQ(HomingL.get_active(), 0x03);
+
+	uint8_t OverlapL = run_homing(HomingL, SteppersL, 5000000UL);
+	CHECK_EQ(OverlapL, 1);
+	CHECK_EQ(HomingL.get_homed(), 0x03);
+	CHECK_EQ(SteppersL[1].currentPosition() - Shaft_g[1], -20 - SwitchAt_g[1]);
+}
+
+TEST_CASE(homing_fails_without_switch)
+{
+	HomingClass HomingL;
+	AccelStepper SteppersL[2];
+	setup_axes(HomingL, SteppersL);
+
+	// Further than the travel.
+	SwitchAt_g[0] = -8000;
+	CHECK(HomingL.start(0x01, 0));
+	run_homing(HomingL, SteppersL, 5000000UL);
+	CHECK_EQ(HomingL.get_active(), 0);
+	CHECK_EQ(HomingL.get_homed(), 0);
+	CHECK_EQ(HomingL.get_failed(), 0x01);
+
+	// Starting on the switch backs off first.
+	SwitchAt_g[0] = Shaft_g[0] + 50;
+	CHECK(HomingL.start(0x01, 0));
+	run_homing(HomingL, SteppersL, 3000000UL);
+	CHECK_EQ(HomingL.get_homed(), 0x01);
+	CHECK_EQ(HomingL.get_failed(), 0);
+	CHECK_EQ(SteppersL[0].currentPosition() - Shaft_g[0], -20 - SwitchAt_g[0]);
+}
+
+TEST_CASE(homing_stop_during_fast_stop_leaves_axis_idle)
+{
+	HomingClass HomingL;
+	AccelStepper SteppersL[2];
+	setup_axes(HomingL, SteppersL);
+
+	// Up to the fast edge, the axis ramps down past the switch.
+	CHECK(HomingL.start(0x01, 0));
+	for (unsigned long elapsed = 0; (Shaft_g[0] > SwitchAt_g[0]) && (elapsed < 5000000UL); elapsed += 20)
+	{
+		run_homing(HomingL, SteppersL, 20);
+	}
+	CHECK(Shaft_g[0] <= SwitchAt_g[0]);
+	CHECK(SteppersL[0].distanceToGo() != 0);
+
+	// The Stop opcode, no back off or slow approach follows.
+	HomingL.abort();
+	SteppersL[0].stop();
+	run_homing(HomingL, SteppersL, 2000000UL);
+	CHECK_EQ(HomingL.get_active(), 0);
+	CHECK_EQ(HomingL.get_homed(), 0);
+	CHECK_EQ(HomingL.get_failed(), 0);
+	CHECK(!SteppersL[0].isRunning());
+	CHECK(Shaft_g[0] <= SwitchAt_g[0]);
+}
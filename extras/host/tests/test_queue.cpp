@@ -0,0 +1,193 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <thread>
+
+#include "HostHAL.h"
+
+#include "Robko01.h"
+
+#include "SPSCQueue.h"
+
+#include "TestBus.h"
+
+#include "TestHarness.h"
+
+/** @brief Commands pushed by the stress tests. */
+#define STRESS_COUNT 200000UL
+
+TEST_CASE(queue_keeps_order_and_capacity)
+{
+	SPSCQueue<uint16_t, 8> QueueL;
+	uint16_t ValueL = 0;
+
+	CHECK(QueueL.empty());
+	CHECK(!QueueL.pop(ValueL));
+
+	// One slot stays free.
+	for (uint16_t index = 0; index < QueueL.capacity(); index++)
+	{
+		CHECK(QueueL.push(100 + index));
+	}
+	CHECK(!QueueL.push(999));
+	CHECK_EQ(QueueL.count(), 7);
+
+	for (uint16_t index = 0; index < QueueL.capacity(); index++)
+	{
+		CHECK(QueueL.pop(ValueL));
+		CHECK_EQ(ValueL, 100 + index);
+	}
+	CHECK(QueueL.empty());
+}
+
+TEST_CASE(queue_wraps_around)
+{
+	SPSCQueue<uint32_t, 4> QueueL;
+	uint32_t ValueL = 0;
+	uint32_t PushedL = 0;
+	uint32_t PoppedL = 0;
+
+	// Indices pass the end of the ring many times, at every fill level.
+	for (uint32_t index = 0; index < 1000; index++)
+	{
+		uint8_t BatchL = 1 + (index % QueueL.capacity());
+		for (uint8_t item = 0; item < BatchL; item++)
+		{
+			CHECK(QueueL.push(PushedL++));
+		}
+		CHECK_EQ(QueueL.count(), BatchL);
+		while (QueueL.pop(ValueL))
+		{
+			CHECK_EQ(ValueL, PoppedL++);
+		}
+	}
+	CHECK_EQ(PoppedL, PushedL);
+
+	QueueL.push(1);
+	QueueL.push(2);
+	QueueL.clear();
+	CHECK(QueueL.empty());
+	CHECK(!QueueL.pop(ValueL));
+}
+
+TEST_CASE(queue_two_threads_keep_order)
+{
+	SPSCQueue<MotionCommand_t, 8> QueueL;
+	uint32_t ErrorsL = 0;
+	uint32_t PoppedL = 0;
+
+	// Every field carries the sequence, a torn copy does not match.
+	std::thread ProducerL([&QueueL]()
+	{
+		for (uint32_t index = 0; index < STRESS_COUNT; index++)
+		{
+			MotionCommand_t CommandL;
+			memset(&CommandL, 0, sizeof(CommandL));
+			CommandL.Type = (uint8_t)index;
+			CommandL.Value = (uint8_t)(index >> 8);
+			CommandL.State.Axis[0].Position = (int32_t)index;
+			CommandL.State.Axis[JOINTS_COUNT - 1].Speed = (int32_t)~index;
+			while (QueueL.push(CommandL) == false)
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	while (PoppedL < STRESS_COUNT)
+	{
+		MotionCommand_t CommandL;
+		if (QueueL.pop(CommandL) == false)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		if ((CommandL.Type != (uint8_t)PoppedL)
+			|| (CommandL.Value != (uint8_t)(PoppedL >> 8))
+			|| (CommandL.State.Axis[0].Position != (int32_t)PoppedL)
+			|| (CommandL.State.Axis[JOINTS_COUNT - 1].Speed != (int32_t)~PoppedL))
+		{
+			ErrorsL++;
+		}
+		PoppedL++;
+	}
+
+	ProducerL.join();
+
+	CHECK_EQ(ErrorsL, 0);
+	CHECK(QueueL.empty());
+}
+
+TEST_CASE(robot_executes_commands_from_other_thread)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	const uint32_t CountL = 2000;
+	volatile bool DoneL = false;
+	uint32_t RejectedL = 0;
+	uint32_t WrapsL = 0;
+	uint8_t LastL = 0;
+
+	RobotL.init(&ConfigL);
+
+	// Port A writes only, the bus stays idle and the slots stay short.
+	std::thread ProducerL([&RobotL, &DoneL, &RejectedL, CountL]()
+	{
+		for (uint32_t index = 0; index < CountL; index++)
+		{
+			while (RobotL.post(MotionCommands::CmdSetPortA, (uint8_t)index) == false)
+			{
+				RejectedL++;
+				std::this_thread::yield();
+			}
+		}
+		DoneL = true;
+	});
+
+	// Slot side, counts how far the executed counter went.
+	while ((DoneL == false) || (RobotL.commands_pending() != 0))
+	{
+		RobotL.update();
+		host_advance_micros(100);
+
+		uint8_t ExecutedL = RobotL.commands_executed();
+		if (ExecutedL < LastL)
+		{
+			WrapsL++;
+		}
+		LastL = ExecutedL;
+	}
+
+	ProducerL.join();
+
+	// One more whole cycle publishes the last command.
+	for (uint8_t index = 0; index < 100; index++)
+	{
+		RobotL.update();
+		host_advance_micros(100);
+	}
+
+	CHECK_EQ(WrapsL * 256UL + LastL, CountL);
+	CHECK_EQ(RobotL.commands_posted(), (uint8_t)CountL);
+	CHECK_EQ(RobotL.get_motor_state() & MOTOR_STATE_PENDING, 0);
+	CHECK(RejectedL > 0);
+}
@@ -0,0 +1,687 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "Robko01.h"
+#include "JointPositionDelta.h"
+
+#include "TestBus.h"
+
+#include "TestHarness.h"
+
+/** @brief Run the bus scheduler for the given virtual time.
+ *  @return Void.
+ */
+static void run_for(Robko01Class &robot, unsigned long us)
+{
+	unsigned long EndL = micros() + us;
+	while (micros() < EndL)
+	{
+		robot.update();
+		host_advance_micros(10);
+	}
+}
+
+TEST_CASE(init_configures_bus)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+
+	CHECK_EQ(host_pin_mode(ConfigL.IOW), OUTPUT);
+	CHECK_EQ(host_pin_mode(ConfigL.AO2), OUTPUT);
+	CHECK_EQ(host_pin_mode(ConfigL.DO0), INPUT);
+	// Strobes idle high.
+	CHECK_EQ(host_pin_level(ConfigL.IOW), HIGH);
+	CHECK_EQ(host_pin_level(ConfigL.IOR), HIGH);
+}
+
+TEST_CASE(move_absolute_reaches_target)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointPosition_t TargetL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.BasePos = 20;
+	TargetL.BaseSpeed = 100;
+	TargetL.GripperPos = -10;
+	TargetL.GripperSpeed = 100;
+	RobotL.move_absolute(TargetL);
+
+	run_for(RobotL, 5000000UL);
+
+	JointPosition_t PositionL = RobotL.get_position();
+	CHECK_EQ(PositionL.BasePos, 20);
+	CHECK_EQ(PositionL.GripperPos, -10);
+	CHECK_EQ(PositionL.ShoulderPos, 0);
+	CHECK_EQ(RobotL.get_motor_state(), 0);
+}
+
+TEST_CASE(state32_does_not_wrap)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	RobotL.init(&ConfigL);
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Elbow].Position = 40000;
+	TargetL.Axis[AddressIndex::Elbow].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+
+	// Far target, only check the command is kept in 32 bits.
+	run_for(RobotL, 100000UL);
+	JointState32_t StateL = RobotL.get_state32();
+	CHECK(StateL.Axis[AddressIndex::Elbow].Position > 0);
+	CHECK(StateL.Axis[AddressIndex::Elbow].Speed > 0);
+}
+
+TEST_CASE(stats_count_slots_and_overruns)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+	run_for(RobotL, 100000UL);
+
+	Robko01Stats_t StatsL = RobotL.get_stats();
+	CHECK(StatsL.Slots >= 95);
+	CHECK(StatsL.Slots <= 100);
+	CHECK(StatsL.Updates > StatsL.Slots);
+	CHECK_EQ(StatsL.Overruns, 0U);
+	// IOW and the IOR pulses of the Port A slots.
+	CHECK(StatsL.SlotTimeMean >= IOW_PULSE_TIME);
+	CHECK(StatsL.SlotTimeMax >= IOW_PULSE_TIME + IOR_PULSE_TIME);
+	CHECK_EQ(StatsL.Elapsed, 100U);
+
+	// The loop stalls for 5 ms.
+	host_advance_micros(5000);
+	RobotL.update();
+
+	StatsL = RobotL.get_stats();
+	CHECK_EQ(StatsL.Overruns, 1U);
+	CHECK(StatsL.LateMax >= 4000U);
+
+	RobotL.reset_stats();
+	StatsL = RobotL.get_stats();
+	CHECK_EQ(StatsL.Slots, 0U);
+	CHECK_EQ(StatsL.Overruns, 0U);
+	CHECK_EQ(StatsL.LateMax, 0U);
+}
+
+/** @brief Count of the slot callback calls. */
+static uint32_t SlotCalls_g;
+
+/** @brief Slot callback of slot_callback_runs_per_slot. */
+static void cbCountSlot()
+{
+	SlotCalls_g++;
+}
+
+TEST_CASE(slot_callback_runs_per_slot)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+	SlotCalls_g = 0;
+	RobotL.setCbSlot(cbCountSlot);
+	run_for(RobotL, 20000UL);
+
+	// Once per served slot, not per update() call.
+	CHECK(SlotCalls_g > 0);
+	CHECK_EQ(SlotCalls_g, RobotL.get_stats().Slots);
+
+	RobotL.setCbSlot(nullptr);
+	run_for(RobotL, 5000UL);
+	CHECK(RobotL.get_stats().Slots > SlotCalls_g);
+}
+
+TEST_CASE(posted_command_runs_at_next_slot)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+	CHECK(!RobotL.motors_enabled());
+
+	CHECK(RobotL.post(MotionCommands::CmdEnable));
+	CHECK_EQ(RobotL.commands_pending(), 1);
+	CHECK(RobotL.get_motor_state() & MOTOR_STATE_PENDING);
+	CHECK(!RobotL.motors_enabled());
+
+	// Executed at the next slot, published at the end of the cycle.
+	run_for(RobotL, 2000UL);
+	CHECK(RobotL.motors_enabled());
+	CHECK_EQ(RobotL.commands_pending(), 0);
+	CHECK(RobotL.get_motor_state() & MOTOR_STATE_PENDING);
+
+	run_for(RobotL, 10000UL);
+	CHECK_EQ(RobotL.commands_executed(), 1);
+	CHECK_EQ(RobotL.get_motor_state() & MOTOR_STATE_PENDING, 0);
+
+	// The ring keeps one entry free.
+	for (uint8_t index = 0; index < MOTION_COMMANDS_SIZE - 1; index++)
+	{
+		CHECK(RobotL.post(MotionCommands::CmdStop));
+	}
+	CHECK(!RobotL.post(MotionCommands::CmdStop));
+	CHECK_EQ(RobotL.commands_posted(), MOTION_COMMANDS_SIZE);
+}
+
+TEST_CASE(posted_limits_wait_in_the_argument_slot)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	AxisLimits_t LimitsL;
+
+	RobotL.init(&ConfigL);
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	LimitsL.MaxSpeed = 40;
+	LimitsL.MaxPosition = 500;
+	CHECK(RobotL.post(AddressIndex::Elbow, LimitsL));
+
+	// One slot, the second waits until the first ran.
+	LimitsL.MaxSpeed = 60;
+	CHECK(!RobotL.post(AddressIndex::Base, LimitsL));
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Elbow).MaxSpeed, 0);
+
+	run_for(RobotL, 2000UL);
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Elbow).MaxSpeed, 40);
+	CHECK_EQ(RobotL.get_limits().Axis[AddressIndex::Elbow].MaxPosition, 500);
+	CHECK(RobotL.post(AddressIndex::Base, LimitsL));
+
+	run_for(RobotL, 2000UL);
+	CHECK_EQ(RobotL.get_limits().Axis[AddressIndex::Base].MaxSpeed, 60);
+	CHECK_EQ(RobotL.get_limits().Axis[AddressIndex::Elbow].MaxSpeed, 40);
+}
+
+TEST_CASE(calibration_follows_slot_cost)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+
+	RobotL.init(&ConfigL);
+
+	// A fast core.
+	host_set_costs(100, 2000);
+	uint32_t FastL = RobotL.calibrate_update_rate();
+	Robko01Timing_t TimingL = RobotL.get_timing();
+	CHECK(TimingL.SlotCost > 0);
+	CHECK(FastL >= (uint32_t)TimingL.SlotCost * CALIBRATION_MARGIN);
+	CHECK(FastL < (uint32_t)TimingL.SlotCost * CALIBRATION_MARGIN + 10);
+	CHECK_EQ(FastL % 10, 0);
+	CHECK_EQ(RobotL.get_update_rate(), FastL);
+
+	// A Nano, digitalWrite() of some us and analogRead() of about 110 us.
+	host_set_costs(5000, 110000);
+	uint32_t SlowL = RobotL.calibrate_update_rate();
+	CHECK(SlowL > FastL);
+
+	// The calibrated period holds with the measured cost.
+	RobotL.reset_stats();
+	run_for(RobotL, 200000UL);
+	CHECK(RobotL.get_stats().Slots > 0);
+	CHECK_EQ(RobotL.get_stats().Overruns, 0);
+
+	RobotL.set_update_rate(1);
+	CHECK_EQ(RobotL.get_update_rate(), UPDATE_RATE_MIN);
+	RobotL.set_update_rate(0xFFFFFFFFUL);
+	CHECK_EQ(RobotL.get_update_rate(), UPDATE_RATE_MAX);
+}
+
+TEST_CASE(calibration_runs_as_posted_command)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	MotionCommand_t CommandL;
+
+	RobotL.init(&ConfigL);
+	host_set_costs(1000, 20000);
+
+	CHECK(RobotL.post(MotionCommands::CmdCalibrate));
+	run_for(RobotL, 2000UL);
+	CHECK(RobotL.get_timing().SlotCost > 0);
+	CHECK(RobotL.get_update_rate() != 1000);
+	CHECK_EQ(RobotL.get_stats().Overruns, 0);
+
+	memset(&CommandL, 0, sizeof(CommandL));
+	CommandL.Type = MotionCommands::CmdSetUpdateRate;
+	CommandL.Period = 750;
+	CHECK(RobotL.post(CommandL));
+	run_for(RobotL, 5000UL);
+	CHECK_EQ(RobotL.get_update_rate(), 750);
+}
+
+TEST_CASE(override_ramps_move_in_flight)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[0].Position = 900;
+	TargetL.Axis[0].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+
+	// Cruise first, one step per bus cycle at most, so below 125 steps/s.
+	run_for(RobotL, 1000000UL);
+	CHECK(fabs(RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE - 100.0f) < 1.0f);
+
+	// Down to 30 percent, one bus cycle of deceleration at a time.
+	RobotL.set_override(30);
+	float LastL = 100.0f;
+	float DropMaxL = 0.0f;
+	for (uint16_t cycle = 0; cycle < 50; cycle++)
+	{
+		run_for(RobotL, 8000UL);
+		float SpeedL = RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE;
+		if ((LastL - SpeedL) > DropMaxL)
+		{
+			DropMaxL = LastL - SpeedL;
+		}
+		LastL = SpeedL;
+	}
+	CHECK(fabs(LastL - 30.0f) < 1.0f);
+	CHECK(DropMaxL > 0.0f);
+	// 700 steps/s2 over one 8 ms cycle is 5.6 steps/s.
+	CHECK(DropMaxL < 6.0f);
+	CHECK_EQ(RobotL.get_override().Global, 30);
+	CHECK_EQ(RobotL.get_override().Effective[0], 30);
+
+	// The axis override stacks on the global one.
+	RobotL.set_axis_override(0, 50);
+	run_for(RobotL, 500000UL);
+	CHECK_EQ(RobotL.get_override().Effective[0], 15);
+	CHECK(fabs(RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE - 15.0f) < 1.0f);
+
+	// Back to full speed, the same move reaches the same target.
+	RobotL.set_override(OVERRIDE_MAX);
+	RobotL.set_axis_override(0, OVERRIDE_MAX);
+	run_for(RobotL, 20000000UL);
+	CHECK_EQ(RobotL.get_position().BasePos, 900);
+	CHECK_EQ(RobotL.get_override().Effective[0], 100);
+
+	RobotL.set_override(0);
+	CHECK_EQ(RobotL.get_override().Global, OVERRIDE_MIN);
+}
+
+TEST_CASE(jog_ramps_and_times_out)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointPosition_t JogL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+	CHECK_EQ(RobotL.get_jog_timeout(), JOG_TIMEOUT);
+
+	memset(&JogL, 0, sizeof(JogL));
+	JogL.BaseSpeed = 100;
+
+	// Setpoints at 50 Hz, the speed climbs one bus cycle of acceleration at a time.
+	float LastL = 0.0f;
+	float RiseMaxL = 0.0f;
+	for (uint8_t index = 0; index < 50; index++)
+	{
+		RobotL.move_speed(JogL);
+		run_for(RobotL, 20000UL);
+		float SpeedL = RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE;
+		if ((SpeedL - LastL) > RiseMaxL)
+		{
+			RiseMaxL = SpeedL - LastL;
+		}
+		LastL = SpeedL;
+	}
+	CHECK(fabs(LastL - 100.0f) < 0.5f);
+	// 20 ms hold three slots of the axis at most, 700 steps/s2 over 8 ms each.
+	CHECK(RiseMaxL < 3 * 5.61f);
+	CHECK(RobotL.get_motor_state() & 0x01);
+
+	// The client goes away, the axis ramps to a stop after the timeout.
+	int32_t PositionL = RobotL.get_state32().Axis[0].Position;
+	run_for(RobotL, (JOG_TIMEOUT - 50) * 1000UL);
+	CHECK(fabs(RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE - 100.0f) < 0.5f);
+	run_for(RobotL, 500000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[0].Speed, 0);
+	CHECK_EQ(RobotL.get_motor_state(), 0);
+	PositionL = RobotL.get_state32().Axis[0].Position;
+	run_for(RobotL, 100000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[0].Position, PositionL);
+
+	// Watchdog off, it keeps the last setpoint.
+	RobotL.set_jog_timeout(0);
+	RobotL.move_speed(JogL);
+	run_for(RobotL, 2000000UL);
+	CHECK(fabs(RobotL.get_state32().Axis[0].Speed / (float)JOINT_SPEED_ONE - 100.0f) < 0.5f);
+
+	// Stop ramps the speed mode down too.
+	RobotL.stop_motors();
+	run_for(RobotL, 500000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[0].Speed, 0);
+}
+
+TEST_CASE(limits_clamp_each_axis)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+	AxisLimits_t LimitsL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	// Slow base, gentle elbow, the shoulder keeps the defaults.
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	LimitsL.MaxSpeed = 40;
+	CHECK(RobotL.set_axis_limits(AddressIndex::Base, LimitsL));
+	LimitsL.MaxSpeed = 0;
+	LimitsL.MaxAcceleration = 100;
+	CHECK(RobotL.set_axis_limits(AddressIndex::Elbow, LimitsL));
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Elbow).MaxAcceleration, 100);
+
+	// The limits in effect follow the drive mode, a save stores them so.
+	LimitsL.MinPosition = -100;
+	LimitsL.MaxPosition = 100;
+	LimitsL.DriveMode = DriveModes::DriveHalf;
+	CHECK(RobotL.set_axis_limits(AddressIndex::Gripper, LimitsL));
+	CHECK(RobotL.set_drive_mode(AddressIndex::Gripper, DriveModes::DriveFull));
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Gripper).MinPosition, -50);
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Gripper).MaxPosition, 50);
+	CHECK_EQ(RobotL.get_axis_limits(AddressIndex::Gripper).DriveMode, DriveModes::DriveFull);
+	LimitsL.DriveMode = DriveModes::DriveFull;
+
+	// Soft limits the wrong way round.
+	LimitsL.MinPosition = 10;
+	LimitsL.MaxPosition = -10;
+	CHECK(!RobotL.set_axis_limits(AddressIndex::Gripper, LimitsL));
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		TargetL.Axis[axis].Position = 900;
+		TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+	}
+	RobotL.move_absolute32(TargetL);
+
+	// 100 steps/s2 take the elbow to 50 steps/s in half a second.
+	run_for(RobotL, 500000UL);
+	float ElbowL = RobotL.get_state32().Axis[AddressIndex::Elbow].Speed / (float)JOINT_SPEED_ONE;
+	CHECK(ElbowL > 40.0f);
+	CHECK(ElbowL < 60.0f);
+
+	run_for(RobotL, 1000000UL);
+	CHECK(fabs(RobotL.get_state32().Axis[AddressIndex::Base].Speed / (float)JOINT_SPEED_ONE - 40.0f) < 1.0f);
+	CHECK(fabs(RobotL.get_state32().Axis[AddressIndex::Shoulder].Speed / (float)JOINT_SPEED_ONE - 100.0f) < 1.0f);
+
+	// Not while the axis moves.
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	CHECK(!RobotL.set_axis_limits(AddressIndex::Base, LimitsL));
+}
+
+TEST_CASE(soft_limits_reject_clamp_and_brake)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t MoveL;
+	AxisLimits_t LimitsL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	LimitsL.MinPosition = -50;
+	LimitsL.MaxPosition = 300;
+	CHECK(RobotL.set_axis_limits(AddressIndex::Base, LimitsL));
+	CHECK_EQ(RobotL.get_limit_mode(), LimitModes::LimitReject);
+
+	// Absolute and relative targets checked against the snapshot position.
+	memset(&MoveL, 0, sizeof(MoveL));
+	MoveL.Axis[AddressIndex::Base].Position = 400;
+	CHECK(!RobotL.accept_move(MotionCommands::CmdMoveAbsolute32, MoveL));
+	MoveL.Axis[AddressIndex::Base].Position = 250;
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveRelative32, MoveL));
+	MoveL.Axis[AddressIndex::Base].Position = -60;
+	CHECK(!RobotL.accept_move(MotionCommands::CmdMoveRelative32, MoveL));
+
+	// Axes without soft limits take anything.
+	memset(&MoveL, 0, sizeof(MoveL));
+	MoveL.Axis[AddressIndex::Elbow].Position = 100000;
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveAbsolute32, MoveL));
+
+	// Clamp pulls the target to the limit, relative moves stay relative.
+	RobotL.set_limit_mode(LimitModes::LimitClamp);
+	JointPosition_t PositionL;
+	memset(&PositionL, 0, sizeof(PositionL));
+	PositionL.BasePos = 400;
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveAbsolute, PositionL));
+	CHECK_EQ(PositionL.BasePos, 300);
+	PositionL.BasePos = -60;
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveRelative, PositionL));
+	CHECK_EQ(PositionL.BasePos, -50);
+
+	// The slot clamps direct calls too.
+	memset(&MoveL, 0, sizeof(MoveL));
+	MoveL.Axis[AddressIndex::Base].Position = 400;
+	MoveL.Axis[AddressIndex::Base].Speed = 100 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(MoveL);
+	run_for(RobotL, 5000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 300);
+
+	// Jogging back, the ramp ends before the soft minimum.
+	JointPosition_t JogL;
+	memset(&JogL, 0, sizeof(JogL));
+	JogL.BaseSpeed = -100;
+	RobotL.set_jog_timeout(0);
+	RobotL.move_speed(JogL);
+	run_for(RobotL, 6000000UL);
+	int32_t StoppedL = RobotL.get_state32().Axis[AddressIndex::Base].Position;
+	CHECK(StoppedL >= -50);
+	CHECK(StoppedL < -30);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Speed, 0);
+}
+
+/** @brief Pin of the test stop input. */
+#define STOP_PIN 50
+
+/** @brief Robot the stop ISR latches into. */
+static Robko01Class * StopRobot_g = NULL;
+
+static void isrStop() { StopRobot_g->stop_inputs().latch(0x05); }
+
+TEST_CASE(clamped_move_keeps_the_delta_reference)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointPositionDelta ClientL;
+	JointPositionDelta DeviceL;
+	JointPosition_t SentL;
+	JointPosition_t MotionL;
+	AxisLimits_t LimitsL;
+	uint8_t FrameL[JPOS_DELTA_MAX_LEN];
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	LimitsL.MinPosition = -50;
+	LimitsL.MaxPosition = 300;
+	CHECK(RobotL.set_axis_limits(AddressIndex::Base, LimitsL));
+	RobotL.set_limit_mode(LimitModes::LimitClamp);
+
+	// MoveAbsolute past the limit, clamped, both sides keep the sent target.
+	memset(&SentL, 0, sizeof(SentL));
+	SentL.BasePos = 400;
+	SentL.BaseSpeed = 100;
+	MotionL = SentL;
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveAbsolute, MotionL));
+	CHECK_EQ(MotionL.BasePos, 300);
+	RobotL.move_absolute(MotionL);
+	run_for(RobotL, 5000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 300);
+	DeviceL.set_reference(SentL);
+	ClientL.set_reference(SentL);
+
+	// The next delta lands where the client meant it.
+	SentL.BasePos = 200;
+	uint8_t LengthL = ClientL.encode(SentL, FrameL, sizeof(FrameL));
+	CHECK(LengthL > 0);
+	CHECK_EQ(DeviceL.decode(FrameL, LengthL, MotionL), LengthL);
+	CHECK_EQ(MotionL.BasePos, 200);
+	CHECK(RobotL.accept_move(MotionCommands::CmdMoveAbsolute, MotionL));
+	RobotL.move_absolute(MotionL);
+	run_for(RobotL, 5000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 200);
+}
+
+TEST_CASE(stop_input_stops_axes_within_one_step)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+	StopRobot_g = &RobotL;
+	host_set_input(STOP_PIN, HIGH);
+	attachInterrupt(digitalPinToInterrupt(STOP_PIN), isrStop, FALLING);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		TargetL.Axis[axis].Position = 2000;
+		TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+	}
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 1000000UL);
+
+	// Base and elbow, mid slot.
+	host_advance_micros(300);
+	host_set_input(STOP_PIN, LOW);
+	JointState32_t AtL = RobotL.get_state32();
+
+	// One bus cycle at 1 ms slots, each axis serves the stop at its slot before another step.
+	run_for(RobotL, ADDRESS_COUNT * 1000UL + 100);
+	JointState32_t StoppedL = RobotL.get_state32();
+	CHECK(labs(StoppedL.Axis[AddressIndex::Base].Position - AtL.Axis[AddressIndex::Base].Position) <= 1);
+	CHECK(labs(StoppedL.Axis[AddressIndex::Elbow].Position - AtL.Axis[AddressIndex::Elbow].Position) <= 1);
+
+	run_for(RobotL, 500000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, StoppedL.Axis[AddressIndex::Base].Position);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Elbow].Position, StoppedL.Axis[AddressIndex::Elbow].Position);
+	CHECK(RobotL.get_state32().Axis[AddressIndex::Shoulder].Position > StoppedL.Axis[AddressIndex::Shoulder].Position);
+
+	StopStats_t StatsL = RobotL.stop_inputs().get_stats();
+	CHECK_EQ(StatsL.Count, 1);
+	CHECK_EQ(StatsL.Axes, 0x05);
+	CHECK(StatsL.LastLatency > 0);
+	CHECK(StatsL.LastLatency <= ADDRESS_COUNT * 1000UL);
+	CHECK_EQ(StatsL.MaxLatency, StatsL.LastLatency);
+	CHECK_EQ(RobotL.stop_inputs().pending(), 0);
+}
+
+/** @brief Pin of the test limit switch. */
+#define LIMIT_PIN 51
+
+static void isrStopInput() { StopRobot_g->stop_inputs().latch_input(0); }
+
+TEST_CASE(held_stop_input_refuses_moves)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+	StopRobot_g = &RobotL;
+
+	// E-stop on base and elbow, a limit switch at the negative end of the shoulder.
+	host_set_input(STOP_PIN, HIGH);
+	host_set_input(LIMIT_PIN, HIGH);
+	CHECK(RobotL.stop_inputs().attach(0, STOP_PIN, LOW, 0x05));
+	CHECK(RobotL.stop_inputs().attach(1, LIMIT_PIN, LOW, 0x02, -1));
+	CHECK(!RobotL.stop_inputs().attach(STOP_INPUTS_COUNT, LIMIT_PIN, LOW, 0x02));
+	attachInterrupt(digitalPinToInterrupt(STOP_PIN), isrStopInput, FALLING);
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		TargetL.Axis[axis].Position = 200;
+		TargetL.Axis[axis].Speed = 100 * JOINT_SPEED_ONE;
+	}
+	CHECK(!RobotL.inhibited(MotionCommands::CmdMoveAbsolute32, TargetL));
+
+	// The edge stops, the held button keeps refusing the next move.
+	host_set_input(STOP_PIN, LOW);
+	run_for(RobotL, ADDRESS_COUNT * 1000UL);
+	CHECK(RobotL.inhibited(MotionCommands::CmdMoveAbsolute32, TargetL));
+	CHECK(RobotL.post(MotionCommands::CmdMoveAbsolute32, TargetL));
+	run_for(RobotL, 6000000UL);
+	JointState32_t StateL = RobotL.get_state32();
+	CHECK_EQ(StateL.Axis[AddressIndex::Base].Position, 0);
+	CHECK_EQ(StateL.Axis[AddressIndex::Elbow].Position, 0);
+	CHECK_EQ(StateL.Axis[AddressIndex::Shoulder].Position, 200);
+
+	// Released, the level read clears it.
+	host_set_input(STOP_PIN, HIGH);
+	CHECK(!RobotL.inhibited(MotionCommands::CmdMoveAbsolute32, TargetL));
+	CHECK_EQ(RobotL.stop_inputs().inhibited(0), 0);
+	RobotL.move_absolute32(TargetL);
+	run_for(RobotL, 6000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Base].Position, 200);
+
+	// A closed limit switch refuses the moves toward it, not the ones away.
+	host_set_input(LIMIT_PIN, LOW);
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[AddressIndex::Shoulder].Position = -50;
+	TargetL.Axis[AddressIndex::Shoulder].Speed = 100 * JOINT_SPEED_ONE;
+	CHECK(RobotL.inhibited(MotionCommands::CmdMoveRelative32, TargetL));
+	RobotL.move_relative32(TargetL);
+	run_for(RobotL, 2000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Shoulder].Position, 200);
+	TargetL.Axis[AddressIndex::Shoulder].Position = 50;
+	CHECK(!RobotL.inhibited(MotionCommands::CmdMoveRelative32, TargetL));
+	RobotL.move_relative32(TargetL);
+	run_for(RobotL, 2000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Shoulder].Position, 250);
+
+	// Jogging into it stays at rest.
+	JointPosition_t JogL;
+	memset(&JogL, 0, sizeof(JogL));
+	JogL.ShoulderSpeed = -100;
+	CHECK(RobotL.inhibited(MotionCommands::CmdMoveSpeed, JogL));
+	RobotL.set_jog_timeout(0);
+	RobotL.move_speed(JogL);
+	run_for(RobotL, 1000000UL);
+	CHECK_EQ(RobotL.get_state32().Axis[AddressIndex::Shoulder].Position, 250);
+
+	detachInterrupt(digitalPinToInterrupt(STOP_PIN));
+}
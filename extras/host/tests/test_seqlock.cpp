@@ -0,0 +1,172 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include <thread>
+
+#include "HostHAL.h"
+
+#include "Robko01.h"
+
+#include "Seqlock.h"
+
+#include "TestBus.h"
+
+#include "TestHarness.h"
+
+/** @brief Snapshots written by the stress test. */
+#define STRESS_COUNT 200000UL
+
+TEST_CASE(seqlock_reads_last_write)
+{
+	Seqlock<JointState32_t> LockL;
+	JointState32_t StateL;
+
+	LockL.read(StateL);
+	CHECK_EQ(StateL.Axis[0].Position, 0);
+	CHECK_EQ(LockL.version(), 0);
+
+	StateL.Axis[0].Position = 12345;
+	StateL.Axis[JOINTS_COUNT - 1].Speed = -7;
+	LockL.write(StateL);
+
+	memset(&StateL, 0, sizeof(StateL));
+	CHECK(LockL.try_read(StateL));
+	CHECK_EQ(StateL.Axis[0].Position, 12345);
+	CHECK_EQ(StateL.Axis[JOINTS_COUNT - 1].Speed, -7);
+	CHECK_EQ(LockL.version(), 1);
+}
+
+TEST_CASE(seqlock_part_writes_in_place)
+{
+	Seqlock<JointState32_t> LockL;
+	JointState32_t StateL;
+	JointAxisState32_t AxisL;
+
+	// One axis changes, the others keep the published value.
+	memset(&StateL, 0, sizeof(StateL));
+	StateL.Axis[0].Position = 10;
+	LockL.write(StateL);
+	AxisL.Position = -20;
+	AxisL.Speed = 3;
+	LockL.write(2 * sizeof(JointAxisState32_t), &AxisL, sizeof(AxisL));
+	CHECK_EQ(LockL.value().Axis[2].Position, -20);
+	CHECK_EQ(LockL.version(), 2);
+
+	memset(&AxisL, 0, sizeof(AxisL));
+	LockL.read(2 * sizeof(JointAxisState32_t), &AxisL, sizeof(AxisL));
+	CHECK_EQ(AxisL.Position, -20);
+	CHECK_EQ(AxisL.Speed, 3);
+	LockL.read(StateL);
+	CHECK_EQ(StateL.Axis[0].Position, 10);
+	CHECK_EQ(StateL.Axis[2].Speed, 3);
+}
+
+TEST_CASE(seqlock_two_threads_never_torn)
+{
+	Seqlock<JointState32_t> LockL;
+	volatile bool DoneL = false;
+	uint32_t TornL = 0;
+	uint32_t BackwardsL = 0;
+	uint32_t ReadsL = 0;
+	int32_t LastL = 0;
+
+	// Every field carries the same sequence number.
+	std::thread WriterL([&LockL, &DoneL]()
+	{
+		JointState32_t StateL;
+		for (uint32_t index = 1; index <= STRESS_COUNT; index++)
+		{
+			for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+			{
+				StateL.Axis[axis].Position = (int32_t)index;
+				StateL.Axis[axis].Speed = -(int32_t)index;
+			}
+			LockL.write(StateL);
+		}
+		DoneL = true;
+	});
+
+	while (DoneL == false)
+	{
+		JointState32_t StateL;
+		LockL.read(StateL);
+		ReadsL++;
+
+		for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+		{
+			if ((StateL.Axis[axis].Position != StateL.Axis[0].Position)
+				|| (StateL.Axis[axis].Speed != -StateL.Axis[0].Position))
+			{
+				TornL++;
+				break;
+			}
+		}
+		if (StateL.Axis[0].Position < LastL)
+		{
+			BackwardsL++;
+		}
+		LastL = StateL.Axis[0].Position;
+	}
+
+	WriterL.join();
+
+	CHECK(ReadsL > 0);
+	CHECK_EQ(TornL, 0);
+	CHECK_EQ(BackwardsL, 0);
+	CHECK_EQ(LockL.version(), STRESS_COUNT);
+}
+
+TEST_CASE(robot_publishes_snapshot_per_cycle)
+{
+	Robko01Class RobotL;
+	BusConfig_t ConfigL = test_bus_config();
+	JointState32_t TargetL;
+
+	RobotL.init(&ConfigL);
+	RobotL.enable_motors();
+
+	memset(&TargetL, 0, sizeof(TargetL));
+	TargetL.Axis[0].Position = 1000;
+	TargetL.Axis[0].Speed = 200 * JOINT_SPEED_ONE;
+	RobotL.move_absolute32(TargetL);
+
+	// The slot side moves, readers see the whole cycles only.
+	int32_t LastL = 0;
+	uint32_t ChangesL = 0;
+	for (uint32_t index = 0; index < 2000; index++)
+	{
+		RobotL.update();
+		host_advance_micros(100);
+
+		RobotSnapshot_t SnapshotL = RobotL.get_snapshot();
+		if (SnapshotL.State.Axis[0].Position != LastL)
+		{
+			CHECK(SnapshotL.State.Axis[0].Position > LastL);
+			LastL = SnapshotL.State.Axis[0].Position;
+			ChangesL++;
+		}
+		CHECK_EQ(RobotL.get_state32().Axis[0].Position, SnapshotL.State.Axis[0].Position);
+	}
+
+	// 200 ms at 1 ms slots is 25 cycles, at most one change each.
+	CHECK(ChangesL > 0);
+	CHECK(ChangesL <= 26);
+}
@@ -0,0 +1,123 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "EEPROM.h"
+
+#include "Settings.h"
+
+#include "TestHarness.h"
+
+TEST_CASE(settings_blank_eeprom_keeps_defaults)
+{
+	SettingsClass SettingsL;
+	RobotLimits_t LimitsL;
+
+	CHECK(!SettingsL.load(LimitsL));
+	CHECK(!SettingsL.valid());
+	CHECK_EQ(SettingsL.get().UpdateRate, 0);
+}
+
+TEST_CASE(settings_round_trip)
+{
+	SettingsClass WriterL;
+	SettingsClass ReaderL;
+	RobotLimits_t LimitsL;
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	WriterL.get().UpdateRate = 420;
+	CHECK(WriterL.save(LimitsL));
+	uint32_t WritesL = EEPROM.writes();
+	CHECK(WritesL > 0);
+
+	CHECK(ReaderL.load(LimitsL));
+	CHECK_EQ(ReaderL.get().UpdateRate, 420);
+
+	// Saving the same record again does not wear the cells.
+	CHECK(WriterL.save(LimitsL));
+	CHECK_EQ(EEPROM.writes(), WritesL);
+}
+
+TEST_CASE(settings_reject_corrupt_record)
+{
+	SettingsClass WriterL;
+	SettingsClass ReaderL;
+	RobotLimits_t LimitsL;
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	WriterL.get().UpdateRate = 1000;
+	CHECK(WriterL.save(LimitsL));
+
+	// One flipped bit in the fields.
+	uint8_t ByteL = EEPROM.read(SETTINGS_ADDRESS + SETTINGS_HEADER_LEN);
+	EEPROM.write(SETTINGS_ADDRESS + SETTINGS_HEADER_LEN, ByteL ^ 0x04);
+	CHECK(!ReaderL.load(LimitsL));
+	CHECK_EQ(ReaderL.get().UpdateRate, 0);
+
+	// A newer layout is left alone.
+	CHECK(WriterL.save(LimitsL));
+	EEPROM.write(SETTINGS_ADDRESS + 2, SETTINGS_VERSION + 1);
+	CHECK(!ReaderL.load(LimitsL));
+}
+
+TEST_CASE(settings_older_record_keeps_new_fields)
+{
+	SettingsClass WriterL;
+	SettingsClass ReaderL;
+	RobotLimits_t LimitsL;
+
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	WriterL.get().UpdateRate = 640;
+	WriterL.get().LimitMode = 1;
+	LimitsL.Axis[1].MaxSpeed = 80;
+	LimitsL.Axis[1].MinPosition = -300;
+	LimitsL.Axis[1].MaxPosition = 450;
+	CHECK(WriterL.save(LimitsL));
+	memset(&LimitsL, 0, sizeof(LimitsL));
+	CHECK(ReaderL.load(LimitsL));
+	CHECK_EQ(LimitsL.Axis[1].MaxSpeed, 80);
+	CHECK_EQ(LimitsL.Axis[1].MinPosition, -300);
+	CHECK_EQ(LimitsL.Axis[1].MaxPosition, 450);
+	CHECK_EQ(ReaderL.get().LimitMode, 1);
+
+	// A record of the first layout, the update rate only.
+	uint8_t RecordL[] = { SETTINGS_MAGIC & 0xFF, SETTINGS_MAGIC >> 8, 1, 4, 0x80, 0x02, 0x00, 0x00, 0, 0 };
+	uint8_t LowL = 0;
+	uint8_t HighL = 0;
+	for (uint8_t index = 2; index < 8; index++)
+	{
+		LowL = (uint8_t)(((uint16_t)LowL + RecordL[index]) % 255);
+		HighL = (uint8_t)(((uint16_t)HighL + LowL) % 255);
+	}
+	RecordL[8] = LowL;
+	RecordL[9] = HighL;
+	for (uint8_t index = 0; index < sizeof(RecordL); index++)
+	{
+		EEPROM.write(SETTINGS_ADDRESS + index, RecordL[index]);
+	}
+
+	CHECK(ReaderL.load(LimitsL));
+	CHECK_EQ(ReaderL.get().UpdateRate, 640);
+	CHECK_EQ(LimitsL.Axis[1].MaxSpeed, 0);
+	CHECK_EQ(LimitsL.Axis[1].MaxPosition, 0);
+	CHECK_EQ(ReaderL.get().LimitMode, 0);
+}
@@ -0,0 +1,272 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "HostHAL.h"
+
+#include "SUPER.h"
+
+#include "OperationsCodes.h"
+
+#include "TestHarness.h"
+
+#pragma region Variables
+
+/** @brief SUPER instance under test. */
+static SUPERClass * Super_g;
+
+/** @brief Count of the callback calls. */
+static int Requests_g;
+
+/** @brief Operation code of the last callback. */
+static uint8_t LastOpCode_g;
+
+/** @brief Size of the last callback. */
+static uint8_t LastSize_g;
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Echo handler, like the Ping branch of the sketches. */
+static void cbEcho(uint8_t opcode, uint8_t size, uint8_t * payload)
+{
+	Requests_g++;
+	LastOpCode_g = opcode;
+	LastSize_g = size;
+
+	Super_g->send_raw_response(opcode, StatusCodes::Ok, payload, size - 1);
+}
+
+/** @brief Build a request frame the way the host clients do.
+ *  @return size_t, Frame length.
+ */
+static size_t build_request(uint8_t opcode, const uint8_t * payload, uint8_t length, uint8_t * frame)
+{
+	frame[0] = FRAME_SENTINEL;
+	frame[1] = 1;
+	frame[2] = length + 1;
+	frame[3] = opcode;
+	memcpy(&frame[4], payload, length);
+
+	uint8_t CRCL[FRAME_CRC_LEN] = { 0, 0 };
+	for (uint8_t index = 0; index < length + 4; index++)
+	{
+		CRCL[index % 2] ^= frame[index];
+	}
+	frame[length + 4] = CRCL[0];
+	frame[length + 5] = CRCL[1];
+
+	return length + 6;
+}
+
+/** @brief Poll the parser past its update rate.
+ *  @return Void.
+ */
+static void poll(SUPERClass &super)
+{
+	host_advance_micros(UPDATE_RATE * 1000UL);
+	super.update();
+}
+
+#pragma endregion
+
+TEST_CASE(ping_round_trip)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	const uint8_t PayloadL[] = { 0x12, 0x34, 0x56 };
+
+	Super_g = &SuperL;
+	Requests_g = 0;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+
+	size_t LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	CHECK_EQ(Requests_g, 1);
+	CHECK_EQ(LastOpCode_g, OpCodes::Ping);
+	CHECK_EQ(LastSize_g, sizeof(PayloadL) + 1);
+
+	// Response: sentinel, type, length, opcode, status, payload, CRC.
+	std::vector<uint8_t> &TxL = PortL.tx();
+	CHECK_EQ(TxL.size(), sizeof(PayloadL) + 7);
+	CHECK_EQ(TxL[0], FRAME_SENTINEL);
+	CHECK_EQ(TxL[1], 2);
+	CHECK_EQ(TxL[2], sizeof(PayloadL) + 2);
+	CHECK_EQ(TxL[3], OpCodes::Ping);
+	CHECK_EQ(TxL[4], StatusCodes::Ok);
+	CHECK(memcmp(&TxL[5], PayloadL, sizeof(PayloadL)) == 0);
+}
+
+TEST_CASE(bad_crc_is_dropped)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	const uint8_t PayloadL[] = { 0x01 };
+
+	Super_g = &SuperL;
+	Requests_g = 0;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+
+	size_t LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	FrameL[LengthL - 1] ^= 0xFF;
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	CHECK_EQ(Requests_g, 0);
+
+	// The parser resynchronises on the next good frame.
+	LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	CHECK_EQ(Requests_g, 1);
+}
+
+TEST_CASE(largest_payload_fits)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	uint8_t PayloadL[FRAME_MAX_DATA_LEN];
+
+	for (uint8_t index = 0; index < sizeof(PayloadL); index++)
+	{
+		PayloadL[index] = index;
+	}
+
+	Super_g = &SuperL;
+	Requests_g = 0;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+
+	size_t LengthL = build_request(OpCodes::MoveAbsolute32, PayloadL, sizeof(PayloadL), FrameL);
+	CHECK(LengthL <= FRAME_MAX_LEN);
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	CHECK_EQ(Requests_g, 1);
+	CHECK_EQ(LastSize_g, FRAME_MAX_DATA_LEN + 1);
+}
+
+TEST_CASE(stats_count_bytes_frames_and_errors)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	const uint8_t PayloadL[] = { 0x01, 0x02 };
+
+	Super_g = &SuperL;
+	Requests_g = 0;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+
+	size_t LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	PortL.feed(FrameL, LengthL);
+	PortL.feed(FrameL, LengthL);
+	FrameL[LengthL - 1] ^= 0xFF;
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	SUPERStats_t StatsL = SuperL.get_stats();
+	CHECK_EQ(StatsL.Bytes, 3 * LengthL);
+	CHECK_EQ(StatsL.Frames, 2U);
+	CHECK_EQ(StatsL.CRCErrors, 1U);
+
+	SUPEROpcodeStats_t OpcodeL = SuperL.get_opcode_stats(OpCodes::Ping);
+	CHECK_EQ(OpcodeL.Count, 2);
+	CHECK_EQ(SuperL.get_opcode_stats(OpCodes::Stop).Count, 0);
+
+	SuperL.reset_stats();
+	StatsL = SuperL.get_stats();
+	CHECK_EQ(StatsL.Bytes, 0U);
+	CHECK_EQ(SuperL.get_opcode_stats(OpCodes::Ping).Count, 0);
+}
+
+TEST_CASE(trace_records_parser_states)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	uint8_t RecordsL[FRAME_TRACE_RECORD_LEN * 16];
+	const uint8_t PayloadL[] = { 0x42 };
+	const uint8_t NoiseL[] = { 0x55 };
+
+	Super_g = &SuperL;
+	Requests_g = 0;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+	SuperL.trace().enable(true);
+
+	size_t LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	PortL.feed(NoiseL, sizeof(NoiseL));
+	PortL.feed(FrameL, LengthL);
+	FrameL[LengthL - 1] ^= 0xFF;
+	PortL.feed(FrameL, LengthL);
+	poll(SuperL);
+
+	CHECK_EQ(Requests_g, 1);
+	CHECK_EQ(SuperL.trace().count(), 1 + 2 * LengthL);
+	CHECK_EQ(SuperL.trace().read(0, RecordsL, sizeof(RecordsL)), 1 + 2 * LengthL);
+
+	// Noise keeps the sentinel state, the sentinel moves on.
+	CHECK_EQ(RecordsL[2], 0x00);
+	CHECK_EQ(RecordsL[3], 0x55);
+	CHECK_EQ(RecordsL[FRAME_TRACE_RECORD_LEN + 2], 0x01);
+	CHECK_EQ(RecordsL[FRAME_TRACE_RECORD_LEN + 3], FRAME_SENTINEL);
+
+	// Last byte of each frame closes it.
+	CHECK_EQ(RecordsL[LengthL * FRAME_TRACE_RECORD_LEN + 2], FrameTraceEvents::EventFrame << 4);
+	CHECK_EQ(RecordsL[2 * LengthL * FRAME_TRACE_RECORD_LEN + 2], FrameTraceEvents::EventCRCError << 4);
+}
+
+TEST_CASE(trace_stops_after_error)
+{
+	MemoryStream PortL;
+	SUPERClass SuperL;
+	uint8_t FrameL[FRAME_MAX_LEN];
+	const uint8_t PayloadL[] = { 0x42 };
+
+	Super_g = &SuperL;
+	SuperL.init(PortL);
+	SuperL.setCbRequest(cbEcho);
+	SuperL.trace().enable(true, true);
+
+	size_t LengthL = build_request(OpCodes::Ping, PayloadL, sizeof(PayloadL), FrameL);
+	FrameL[LengthL - 1] ^= 0xFF;
+	PortL.feed(FrameL, LengthL);
+	FrameL[LengthL - 1] ^= 0xFF;
+	for (uint16_t index = 0; index < FRAME_TRACE_SIZE; index++)
+	{
+		PortL.feed(FrameL, LengthL);
+	}
+	poll(SuperL);
+
+	// The error stays in the ring, half a ring after it.
+	CHECK(!SuperL.trace().enabled());
+	CHECK_EQ(SuperL.trace().count(), LengthL + FRAME_TRACE_SIZE / 2);
+	CHECK_EQ(SuperL.trace().overwritten(), 0U);
+}
@@ -0,0 +1,95 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+/*
+	Replays a bus trace dump through the simulator.
+
+	Usage: bus_trace_replay [--bin-width US] [--min-step-period US] [--align] [FILE]
+
+	FILE is the debug port capture holding a BUSTRACE ... END block,
+	standard input when omitted. Other log lines are skipped. --align
+	starts every rotor at its first traced phase, use it when the trace
+	was started during a move.
+*/
+
+#include "BusTraceReplay.h"
+
+int main(int argc, char ** argv)
+{
+	BusTraceReplay ReplayL;
+	BusSimulator SimL;
+	const char * PathL = NULL;
+	bool AlignL = false;
+
+	for (int index = 1; index < argc; index++)
+	{
+		if ((strcmp(argv[index], "--bin-width") == 0) && (index + 1 < argc))
+		{
+			unsigned long WidthL = strtoul(argv[++index], NULL, 10);
+			ReplayL.set_bin_width((WidthL > 0) ? WidthL : REPLAY_DEFAULT_BIN_WIDTH);
+		}
+		else if ((strcmp(argv[index], "--min-step-period") == 0) && (index + 1 < argc))
+		{
+			SimL.set_min_step_period(strtoul(argv[++index], NULL, 10));
+		}
+		else if (strcmp(argv[index], "--align") == 0)
+		{
+			AlignL = true;
+		}
+		else if (PathL == NULL)
+		{
+			PathL = argv[index];
+		}
+		else
+		{
+			fprintf(stderr, "Unknown argument %s\n", argv[index]);
+			return 2;
+		}
+	}
+
+	FILE * FileL = stdin;
+	if (PathL != NULL)
+	{
+		FileL = fopen(PathL, "r");
+		if (FileL == NULL)
+		{
+			fprintf(stderr, "Can not open %s\n", PathL);
+			return 2;
+		}
+	}
+
+	ReplayL.load(FileL);
+	if (FileL != stdin)
+	{
+		fclose(FileL);
+	}
+
+	if (ReplayL.count() == 0)
+	{
+		fprintf(stderr, "No BUSTRACE records found\n");
+		return 1;
+	}
+
+	ReplayL.replay(SimL, AlignL);
+	ReplayL.report(SimL, stdout);
+
+	return 0;
+}
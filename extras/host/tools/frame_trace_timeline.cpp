@@ -0,0 +1,255 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+/*
+	Renders a SUPER parser state trace as a timeline.
+
+	Usage: frame_trace_timeline [--frames] [FILE]
+
+	FILE is the debug port capture holding a FRAMETRACE ... END block,
+	standard input when omitted. Other log lines are skipped. --frames
+	prints one line per frame instead of one line per byte.
+*/
+
+#include <stdio.h>
+
+#include <ctype.h>
+
+#include <vector>
+
+#include "FrameTrace.h"
+
+#pragma region Variables
+
+/** @brief Names of the SUPERClass parser states. */
+static const char * StateNames_g[] =
+{
+	"fsSentinel",
+	"fsRequestResponse",
+	"fsLength",
+	"fsOperationCode",
+	"fsData",
+	"fsCRC",
+};
+
+/** @brief Names of the FrameTraceEvents. */
+static const char * EventNames_g[] =
+{
+	"",
+	"REJECT",
+	"FRAME",
+	"CRC ERROR",
+};
+
+#pragma endregion
+
+#pragma region Functions
+
+static const char * state_name(uint8_t state)
+{
+	return (state < sizeof(StateNames_g) / sizeof(StateNames_g[0])) ? StateNames_g[state] : "?";
+}
+
+static const char * event_name(uint8_t event)
+{
+	return (event < sizeof(EventNames_g) / sizeof(EventNames_g[0])) ? EventNames_g[event] : "?";
+}
+
+static int hex_value(char c)
+{
+	if ((c >= '0') && (c <= '9')) return c - '0';
+	if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+	if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	return -1;
+}
+
+/** @brief Collect the records of the last dump in the input.
+ *  @return bool, A dump was found.
+ */
+static bool load(FILE * file, std::vector<FrameTraceRecord_t> &records, unsigned long &overwritten)
+{
+	char LineL[1024];
+	bool InDumpL = false;
+	bool FoundL = false;
+
+	while (fgets(LineL, sizeof(LineL), file) != NULL)
+	{
+		unsigned long CountL;
+		if (sscanf(LineL, "FRAMETRACE %lu %lu", &CountL, &overwritten) == 2)
+		{
+			records.clear();
+			InDumpL = true;
+			FoundL = true;
+			continue;
+		}
+
+		if (!InDumpL)
+		{
+			continue;
+		}
+
+		if (strncmp(LineL, "END", 3) == 0)
+		{
+			InDumpL = false;
+			continue;
+		}
+
+		uint8_t BytesL[FRAME_TRACE_RECORD_LEN];
+		uint8_t CountBytesL = 0;
+		for (const char * ptr = LineL; isxdigit((unsigned char)ptr[0]) && isxdigit((unsigned char)ptr[1]); ptr += 2)
+		{
+			BytesL[CountBytesL++] = (uint8_t)((hex_value(ptr[0]) << 4) | hex_value(ptr[1]));
+			if (CountBytesL == FRAME_TRACE_RECORD_LEN)
+			{
+				FrameTraceRecord_t RecordL;
+				RecordL.Delta = (uint16_t)(BytesL[0] | (BytesL[1] << 8));
+				RecordL.State = BytesL[2];
+				RecordL.Input = BytesL[3];
+				records.push_back(RecordL);
+				CountBytesL = 0;
+			}
+		}
+	}
+
+	return FoundL;
+}
+
+#pragma endregion
+
+int main(int argc, char ** argv)
+{
+	const char * PathL = NULL;
+	bool FramesL = false;
+
+	for (int index = 1; index < argc; index++)
+	{
+		if (strcmp(argv[index], "--frames") == 0)
+		{
+			FramesL = true;
+		}
+		else if (PathL == NULL)
+		{
+			PathL = argv[index];
+		}
+		else
+		{
+			fprintf(stderr, "Unknown argument %s\n", argv[index]);
+			return 2;
+		}
+	}
+
+	FILE * FileL = stdin;
+	if (PathL != NULL)
+	{
+		FileL = fopen(PathL, "r");
+		if (FileL == NULL)
+		{
+			fprintf(stderr, "Can not open %s\n", PathL);
+			return 2;
+		}
+	}
+
+	std::vector<FrameTraceRecord_t> RecordsL;
+	unsigned long OverwrittenL = 0;
+	bool FoundL = load(FileL, RecordsL, OverwrittenL);
+	if (FileL != stdin)
+	{
+		fclose(FileL);
+	}
+
+	if (!FoundL)
+	{
+		fprintf(stderr, "No FRAMETRACE block found\n");
+		return 1;
+	}
+
+	unsigned long TimeL = 0;
+	unsigned long FrameStartL = 0;
+	unsigned long GapMaxL = 0;
+	uint16_t FrameBytesL = 0;
+	uint32_t CountsL[4] = { 0, 0, 0, 0 };
+
+	if (!FramesL)
+	{
+		printf("%10s %6s %4s  %-18s %s\n", "time", "delta", "byte", "state", "event");
+	}
+
+	for (size_t index = 0; index < RecordsL.size(); index++)
+	{
+		const FrameTraceRecord_t &RecordL = RecordsL[index];
+		uint8_t StateL = RecordL.State & 0x0F;
+		uint8_t EventL = RecordL.State >> 4;
+		bool RestartL = (RecordL.Delta == FRAME_TRACE_DELTA_MAX);
+
+		if (!RestartL)
+		{
+			TimeL += RecordL.Delta;
+		}
+
+		// Inter-byte gap inside a frame, the line or the sender stalled.
+		if ((FrameBytesL > 0) && !RestartL && (RecordL.Delta > GapMaxL))
+		{
+			GapMaxL = RecordL.Delta;
+		}
+
+		if ((FrameBytesL == 0) && (StateL != 0))
+		{
+			FrameStartL = TimeL;
+		}
+		if ((FrameBytesL > 0) || (StateL != 0))
+		{
+			FrameBytesL++;
+		}
+
+		if (EventL < 4)
+		{
+			CountsL[EventL]++;
+		}
+
+		if (!FramesL)
+		{
+			if (RestartL)
+			{
+				printf("%10lu %6s   %02X  %-18s %s\n", TimeL, "-", RecordL.Input, state_name(StateL), event_name(EventL));
+			}
+			else
+			{
+				printf("%10lu %6u   %02X  %-18s %s\n", TimeL, RecordL.Delta, RecordL.Input, state_name(StateL), event_name(EventL));
+			}
+		}
+		else if (EventL != FrameTraceEvents::EventByte)
+		{
+			printf("%10lu %6lu us %3u bytes  %s\n", FrameStartL, TimeL - FrameStartL, FrameBytesL, event_name(EventL));
+		}
+
+		if (StateL == 0)
+		{
+			FrameBytesL = 0;
+		}
+	}
+
+	printf("\n%lu records, %lu overwritten, %u frames, %u rejects, %u CRC errors, longest gap in a frame %lu us\n",
+		(unsigned long)RecordsL.size(), OverwrittenL,
+		(unsigned)CountsL[FrameTraceEvents::EventFrame], (unsigned)CountsL[FrameTraceEvents::EventReject],
+		(unsigned)CountsL[FrameTraceEvents::EventCRCError], GapMaxL);
+
+	return 0;
+}
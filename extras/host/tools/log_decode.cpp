@@ -0,0 +1,107 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+/*
+	Renders a binary mode DeferredLog capture as text.
+
+	Usage: log_decode [--timestamps] [FILE]
+
+	FILE is the raw debug port capture, standard input when omitted.
+	--timestamps prefixes every line with the device micros().
+*/
+
+#include <stdio.h>
+
+#include "LogDecoder.h"
+
+/** @brief Print that writes to a C stream. */
+class FilePrint : public Print
+{
+
+	protected:
+
+	FILE * m_file;
+
+	public:
+
+	FilePrint(FILE * file) : m_file(file) {}
+
+	using Print::write;
+
+	size_t write(uint8_t data) override
+	{
+		return (fputc(data, m_file) == EOF) ? 0 : 1;
+	}
+
+};
+
+int main(int argc, char ** argv)
+{
+	LogDecoder DecoderL;
+	const char * PathL = NULL;
+
+	for (int index = 1; index < argc; index++)
+	{
+		if (strcmp(argv[index], "--timestamps") == 0)
+		{
+			DecoderL.set_timestamps(true);
+		}
+		else if (PathL == NULL)
+		{
+			PathL = argv[index];
+		}
+		else
+		{
+			fprintf(stderr, "Unknown argument %s\n", argv[index]);
+			return 2;
+		}
+	}
+
+	FILE * FileL = stdin;
+	if (PathL != NULL)
+	{
+		FileL = fopen(PathL, "rb");
+		if (FileL == NULL)
+		{
+			fprintf(stderr, "Can not open %s\n", PathL);
+			return 2;
+		}
+	}
+
+	FilePrint OutL(stdout);
+	uint8_t BufferL[512];
+	size_t SizeL;
+	while ((SizeL = fread(BufferL, 1, sizeof(BufferL), FileL)) > 0)
+	{
+		DecoderL.feed(BufferL, SizeL, OutL);
+	}
+
+	if (FileL != stdin)
+	{
+		fclose(FileL);
+	}
+
+	fprintf(stderr, "%u records, %u dropped, %u unknown, %u bytes skipped\n",
+		(unsigned)DecoderL.records(), (unsigned)DecoderL.dropped(),
+		(unsigned)DecoderL.unknown(), (unsigned)DecoderL.skipped());
+
+	return 0;
+}
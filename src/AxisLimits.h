@@ -0,0 +1,59 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// AxisLimits.h
+
+#ifndef _AXISLIMITS_h
+#define _AXISLIMITS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "JointState32.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Kinematic limits of one axis, in steps of its drive mode, zero takes the default. */
+typedef struct __attribute__((packed))
+{
+	uint16_t MaxSpeed; ///< Steps per second, 0 is DEFAULT_SPEED.
+	uint16_t MaxAcceleration; ///< Steps per second squared, 0 is DEFAULT_ACCELERATION.
+	int32_t MinPosition; ///< Soft limit in steps.
+	int32_t MaxPosition; ///< Soft limit in steps, equal to MinPosition turns the soft limits off.
+	uint8_t DriveMode; ///< DriveModes value.
+} AxisLimits_t;
+
+/** @brief Limits of all axes, same order as JointState32_t. */
+typedef struct __attribute__((packed))
+{
+	AxisLimits_t Axis[JOINTS_COUNT]; ///< Base, Shoulder, Elbow, Left Diff, Right Diff, Gripper.
+} RobotLimits_t;
+
+#pragma endregion
+
+#endif
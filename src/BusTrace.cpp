@@ -0,0 +1,169 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "BusTrace.h"
+
+/**
+ * @brief Construct a new BusTraceClass object
+ *
+ */
+BusTraceClass::BusTraceClass()
+{
+	m_enabled = false;
+	clear();
+}
+
+/** @brief Drop all records.
+ *  @return Void.
+ */
+void BusTraceClass::clear()
+{
+	m_tail = 0;
+	m_count = 0;
+	m_overwritten = 0;
+	m_lastTime = 0;
+	m_restart = true;
+}
+
+/** @brief Start or stop recording.
+ *  @param enabled bool, Recording flag.
+ *  @return Void.
+ */
+void BusTraceClass::enable(bool enabled)
+{
+	if (enabled && !m_enabled)
+	{
+		// The gap while stopped is not a bus delay.
+		m_restart = true;
+	}
+
+	m_enabled = enabled;
+}
+
+/** @brief Add one transaction, the oldest is overwritten when full.
+ *  @param timestamp unsigned long, Time in us.
+ *  @param strobe uint8_t, BusStrobes value.
+ *  @param address uint8_t, Address bus value.
+ *  @param di uint8_t, DI pin levels.
+ *  @param dout uint8_t, DO nibble.
+ *  @return Void.
+ */
+void BusTraceClass::record(unsigned long timestamp, uint8_t strobe, uint8_t address, uint8_t di, uint8_t dout)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	uint16_t IndexL;
+	if (m_count < BUS_TRACE_SIZE)
+	{
+		IndexL = m_tail + m_count;
+		if (IndexL >= BUS_TRACE_SIZE)
+		{
+			IndexL -= BUS_TRACE_SIZE;
+		}
+		m_count++;
+	}
+	else
+	{
+		IndexL = m_tail;
+		m_tail++;
+		if (m_tail >= BUS_TRACE_SIZE)
+		{
+			m_tail = 0;
+		}
+		m_overwritten++;
+	}
+
+	unsigned long DeltaL = timestamp - m_lastTime;
+	if (m_restart || (DeltaL > BUS_TRACE_DELTA_MAX))
+	{
+		DeltaL = BUS_TRACE_DELTA_MAX;
+		m_restart = false;
+	}
+	m_lastTime = timestamp;
+
+	m_records[IndexL].Delta = (uint16_t)DeltaL;
+	m_records[IndexL].Control = (uint8_t)((strobe << 4) | (address & 0x07));
+	m_records[IndexL].Data = (uint8_t)((dout << 4) | (di & 0x0F));
+}
+
+/** @brief Serialise records, oldest first.
+ *  @param offset uint16_t, Index of the first record.
+ *  @param out uint8_t *, Output buffer.
+ *  @param size uint8_t, Size of the output buffer.
+ *  @return uint8_t, Count of the serialised records.
+ */
+uint8_t BusTraceClass::read(uint16_t offset, uint8_t * out, uint8_t size)
+{
+	uint8_t CountL = 0;
+
+	while ((offset < m_count) && ((uint8_t)(CountL + 1) * BUS_TRACE_RECORD_LEN <= size))
+	{
+		uint16_t IndexL = m_tail + offset;
+		if (IndexL >= BUS_TRACE_SIZE)
+		{
+			IndexL -= BUS_TRACE_SIZE;
+		}
+
+		const BusTraceRecord_t &RecordL = m_records[IndexL];
+		out[0] = (uint8_t)(RecordL.Delta & 0xFF);
+		out[1] = (uint8_t)(RecordL.Delta >> 8);
+		out[2] = RecordL.Control;
+		out[3] = RecordL.Data;
+
+		out += BUS_TRACE_RECORD_LEN;
+		offset++;
+		CountL++;
+	}
+
+	return CountL;
+}
+
+/** @brief Dump the ring as hex text, one BUS_TRACE_DUMP_LINE per line.
+ *  @param port Print, Output.
+ *  @return Void.
+ */
+void BusTraceClass::dump(Print &port)
+{
+	uint8_t LineL[BUS_TRACE_RECORD_LEN * BUS_TRACE_DUMP_LINE];
+	char HexL[3];
+
+	port.print("BUSTRACE ");
+	port.print(m_count);
+	port.print(" ");
+	port.print(m_overwritten);
+	port.print("\r\n");
+
+	for (uint16_t offset = 0; offset < m_count; offset += BUS_TRACE_DUMP_LINE)
+	{
+		uint8_t CountL = read(offset, LineL, sizeof(LineL));
+		for (uint8_t index = 0; index < CountL * BUS_TRACE_RECORD_LEN; index++)
+		{
+			snprintf(HexL, sizeof(HexL), "%02X", LineL[index]);
+			port.print(HexL);
+		}
+		port.print("\r\n");
+	}
+
+	port.print("END\r\n");
+}
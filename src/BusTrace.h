@@ -0,0 +1,191 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// BusTrace.h
+
+/*
+	Record layout, 4 bytes, little endian:
+
+	+---------+---------+---------------------+---------------------+
+	| Byte 0  | Byte 1  | Byte 2              | Byte 3              |
+	+---------+---------+---------------------+---------------------+
+	| Delta L | Delta H | Strobe << 4 | Addr. | DO << 4 | DI pins   |
+	+---------+---------+---------------------+---------------------+
+
+	Delta is the time from the previous record in us, saturated at
+	0xFFFF, the first record after clear or enable is always 0xFFFF.
+	DI holds the data pin levels at the strobe, DO the nibble the last
+	read_do() returned (IOR records only).
+*/
+
+#ifndef _BUSTRACE_h
+#define _BUSTRACE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/** @brief Length of one serialised record. */
+#define BUS_TRACE_RECORD_LEN 4
+
+/** @brief Count of the records in the ring. */
+#ifndef BUS_TRACE_SIZE
+#if defined(__AVR__)
+#define BUS_TRACE_SIZE 64
+#else
+#define BUS_TRACE_SIZE 1024
+#endif
+#endif
+
+/** @brief Saturated time delta, also marks the start of a trace. */
+#define BUS_TRACE_DELTA_MAX 0xFFFF
+
+/** @brief Records in one dump line. */
+#define BUS_TRACE_DUMP_LINE 8
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Bus strobe of the record. */
+enum BusStrobes : uint8_t
+{
+	StrobeIOW = 1U, ///< IO Write, the addressed register latches DI.
+	StrobeIOR, ///< IO Read.
+};
+
+/** @brief Flags of the BusTraceControl request. */
+enum BusTraceFlags : uint8_t
+{
+	TraceEnable = 0x01, ///< Record the transactions.
+	TraceClear = 0x02, ///< Drop the recorded transactions.
+	TraceDump = 0x04, ///< Dump the ring to the debug port.
+};
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief One bus transaction. */
+typedef struct __attribute__((packed))
+{
+	uint16_t Delta; ///< Time from the previous record in us.
+	uint8_t Control; ///< Strobe in the high nibble, address in the low.
+	uint8_t Data; ///< DO in the high nibble, DI pins in the low.
+} BusTraceRecord_t;
+
+#pragma endregion
+
+class BusTraceClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Record ring. */
+	BusTraceRecord_t m_records[BUS_TRACE_SIZE];
+
+	/** @brief Index of the oldest record. */
+	uint16_t m_tail;
+
+	/** @brief Count of the records in the ring. */
+	uint16_t m_count;
+
+	/** @brief Count of the records overwritten since clear. */
+	uint32_t m_overwritten;
+
+	/** @brief Time of the last record. */
+	unsigned long m_lastTime;
+
+	/** @brief Next record starts a new time base. */
+	bool m_restart;
+
+	/** @brief Recording flag. */
+	bool m_enabled;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	BusTraceClass();
+
+	/** @brief Drop all records.
+	 *  @return Void.
+	 */
+	void clear();
+
+	/** @brief Start or stop recording.
+	 *  @param enabled bool, Recording flag.
+	 *  @return Void.
+	 */
+	void enable(bool enabled);
+
+	/** @brief Recording flag.
+	 *  @return bool, True while recording.
+	 */
+	inline bool enabled() { return m_enabled; }
+
+	/** @brief Add one transaction, the oldest is overwritten when full.
+	 *  @param timestamp unsigned long, Time in us.
+	 *  @param strobe uint8_t, BusStrobes value.
+	 *  @param address uint8_t, Address bus value.
+	 *  @param di uint8_t, DI pin levels.
+	 *  @param dout uint8_t, DO nibble.
+	 *  @return Void.
+	 */
+	void record(unsigned long timestamp, uint8_t strobe, uint8_t address, uint8_t di, uint8_t dout);
+
+	/** @brief Count of the records in the ring.
+	 *  @return uint16_t, Count.
+	 */
+	inline uint16_t count() { return m_count; }
+
+	/** @brief Count of the records lost to the ring wrap.
+	 *  @return uint32_t, Count.
+	 */
+	inline uint32_t overwritten() { return m_overwritten; }
+
+	/** @brief Serialise records, oldest first.
+	 *  @param offset uint16_t, Index of the first record.
+	 *  @param out uint8_t *, Output buffer.
+	 *  @param size uint8_t, Size of the output buffer.
+	 *  @return uint8_t, Count of the serialised records.
+	 */
+	uint8_t read(uint16_t offset, uint8_t * out, uint8_t size);
+
+	/** @brief Dump the ring as hex text, one BUS_TRACE_DUMP_LINE per line.
+	 *  @param port Print, Output.
+	 *  @return Void.
+	 */
+	void dump(Print &port);
+
+#pragma endregion
+
+};
+
+#endif
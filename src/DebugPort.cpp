@@ -37,6 +37,13 @@ void setup_debug_port(unsigned long baud)
 	DBG_OUTPUT_PORT.setDebugOutput(true);
 #endif // defined(ENABLE_DEBUG_PORT) && defined(ESP32)
 
+#if defined(ENABLE_DEBUG_PORT) && defined(ENABLE_DEFERRED_LOG)
+	DeferredLog.begin(DBG_OUTPUT_PORT);
+#if defined(ESP32)
+	DeferredLog.start_task();
+#endif // defined(ESP32)
+#endif // defined(ENABLE_DEBUG_PORT) && defined(ENABLE_DEFERRED_LOG)
+
 #ifdef SHOW_FUNC_NAMES
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
@@ -44,8 +44,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define DBG_OUTPUT_PORT Serial
 #endif
 
+// Queue DEBUGLOG() lines and print them from drain(), default on ESP32.
+// #define ENABLE_DEFERRED_LOG
+
+#if !defined(ENABLE_DEFERRED_LOG) && defined(ESP32)
+#define ENABLE_DEFERRED_LOG
+#endif
+
 #if !defined(ENABLE_DEBUG_PORT)
 #define DEBUGLOG(...)
+#elif defined(ENABLE_DEFERRED_LOG)
+#include "DeferredLog.h"
+#define DEBUGLOG(...) DeferredLog.log(__VA_ARGS__)
 #else
 #define DEBUGLOG(...) DBG_OUTPUT_PORT.printf(__VA_ARGS__)
 #endif
@@ -0,0 +1,595 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "DeferredLog.h"
+
+#include "DebugPort.h"
+
+#pragma region Definitions
+
+/** @brief Length modifier and type of the rendered integers. */
+#if defined(__AVR__)
+#define DEFERRED_LOG_INT_MODIFIER "l"
+typedef long DeferredInt_t;
+typedef unsigned long DeferredUInt_t;
+#else
+#define DEFERRED_LOG_INT_MODIFIER "ll"
+typedef long long DeferredInt_t;
+typedef unsigned long long DeferredUInt_t;
+#endif
+
+/** @brief Longest conversion specification. */
+#define DEFERRED_LOG_SPEC_MAX 16
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Decoded argument. */
+typedef struct
+{
+	uint8_t Tag;
+	DeferredInt_t Int;
+	double Float;
+	char Str[DEFERRED_LOG_STRING_MAX + 1];
+} DeferredArg_t;
+
+/** @brief Read the next tagged argument.
+ *  @return bool, False when no argument is left.
+ */
+static bool next_arg(const uint8_t * args, uint8_t length, uint8_t &index, DeferredArg_t &arg)
+{
+	if (index >= length)
+	{
+		return false;
+	}
+
+	arg.Tag = args[index++];
+	arg.Int = 0;
+	arg.Float = 0.0;
+	arg.Str[0] = '\0';
+
+	uint8_t SizeL = 0;
+	switch (arg.Tag)
+	{
+	case ArgI32:
+	case ArgU32:
+	case ArgF32:
+		SizeL = 4;
+		break;
+	case ArgI64:
+	case ArgU64:
+	case ArgF64:
+		SizeL = 8;
+		break;
+	case ArgStr:
+		SizeL = (index < length) ? args[index++] : 0;
+		break;
+	default:
+		index = length;
+		return false;
+	}
+
+	if ((uint16_t)index + SizeL > length)
+	{
+		index = length;
+		return false;
+	}
+
+	const uint8_t * ValueL = &args[index];
+	index += SizeL;
+
+	if (arg.Tag == ArgI32)
+	{
+		int32_t ValueI32L;
+		memcpy(&ValueI32L, ValueL, 4);
+		arg.Int = ValueI32L;
+	}
+	else if (arg.Tag == ArgU32)
+	{
+		uint32_t ValueU32L;
+		memcpy(&ValueU32L, ValueL, 4);
+		arg.Int = (DeferredInt_t)ValueU32L;
+	}
+	else if ((arg.Tag == ArgI64) || (arg.Tag == ArgU64))
+	{
+		int64_t ValueI64L;
+		memcpy(&ValueI64L, ValueL, 8);
+		arg.Int = (DeferredInt_t)ValueI64L;
+	}
+	else if (arg.Tag == ArgF32)
+	{
+		float ValueF32L;
+		memcpy(&ValueF32L, ValueL, 4);
+		arg.Float = ValueF32L;
+	}
+	else if (arg.Tag == ArgF64)
+	{
+		// Only reached where double is 8 bytes, AVR writes ArgF32.
+		memcpy(&arg.Float, ValueL, (sizeof(double) < 8) ? sizeof(double) : 8);
+	}
+	else
+	{
+		memcpy(arg.Str, ValueL, SizeL);
+		arg.Str[SizeL] = '\0';
+	}
+
+	if ((arg.Tag == ArgF32) || (arg.Tag == ArgF64))
+	{
+		arg.Int = (DeferredInt_t)arg.Float;
+	}
+	else if (arg.Tag != ArgStr)
+	{
+		arg.Float = (double)arg.Int;
+	}
+
+	return true;
+}
+
+#pragma endregion
+
+/**
+ * @brief Construct a new DeferredLogClass object
+ *
+ */
+DeferredLogClass::DeferredLogClass()
+{
+	m_head = 0;
+	m_tail = 0;
+	m_dropped = 0;
+	m_droppedReported = 0;
+	m_port = NULL;
+	m_mode = DeferredLogModes::LogText;
+	m_formatsCount = 0;
+#if defined(ESP32)
+	m_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+}
+
+/** @brief Set the output of drain().
+ *  @param port Print, Output.
+ *  @param mode uint8_t, DeferredLogModes value.
+ *  @return Void.
+ */
+void DeferredLogClass::begin(Print &port, uint8_t mode)
+{
+	m_port = &port;
+	m_mode = mode;
+	m_formatsCount = 0;
+
+	if (m_mode == DeferredLogModes::LogBinary)
+	{
+		m_port->write((uint8_t)DEFERRED_LOG_MARK_RESTART);
+	}
+}
+
+void DeferredLogClass::add(uint8_t * record, uint8_t &length, uint8_t tag, const void * value, uint8_t size)
+{
+	// Arguments that do not fit are left out, render() prints them as "?".
+	if ((length & DEFERRED_LOG_TRUNCATED) || ((uint16_t)length + 1 + size > DEFERRED_LOG_RECORD_MAX))
+	{
+		truncate(record, length);
+		return;
+	}
+
+	record[length++] = tag;
+	memcpy(&record[length], value, size);
+	length += size;
+}
+
+void DeferredLogClass::add_arg(uint8_t * record, uint8_t &length, long value)
+{
+	if (sizeof(long) > 4)
+	{
+		add_arg(record, length, (long long)value);
+		return;
+	}
+
+	int32_t ValueL = (int32_t)value;
+	add(record, length, ArgI32, &ValueL, 4);
+}
+
+void DeferredLogClass::add_arg(uint8_t * record, uint8_t &length, unsigned long value)
+{
+	if (sizeof(unsigned long) > 4)
+	{
+		add_arg(record, length, (unsigned long long)value);
+		return;
+	}
+
+	uint32_t ValueL = (uint32_t)value;
+	add(record, length, ArgU32, &ValueL, 4);
+}
+
+void DeferredLogClass::add_arg(uint8_t * record, uint8_t &length, double value)
+{
+	if (sizeof(double) < 8)
+	{
+		float ValueL = (float)value;
+		add(record, length, ArgF32, &ValueL, 4);
+		return;
+	}
+
+	add(record, length, ArgF64, &value, 8);
+}
+
+void DeferredLogClass::add_arg(uint8_t * record, uint8_t &length, const char * value)
+{
+	uint8_t SizeL = 0;
+
+	if (value == NULL)
+	{
+		value = "(null)";
+	}
+
+	while ((SizeL < DEFERRED_LOG_STRING_MAX) && (value[SizeL] != '\0'))
+	{
+		SizeL++;
+	}
+
+	if ((length & DEFERRED_LOG_TRUNCATED) || ((uint16_t)length + 2 + SizeL > DEFERRED_LOG_RECORD_MAX))
+	{
+		truncate(record, length);
+		return;
+	}
+
+	record[length++] = ArgStr;
+	record[length++] = SizeL;
+	memcpy(&record[length], value, SizeL);
+	length += SizeL;
+}
+
+/** @brief Close the record after the last argument that fit. */
+void DeferredLogClass::truncate(uint8_t * record, uint8_t &length)
+{
+	if (length & DEFERRED_LOG_TRUNCATED)
+	{
+		return;
+	}
+
+	// A later, shorter argument must not take the place of this one.
+	if (length < DEFERRED_LOG_RECORD_MAX)
+	{
+		record[length++] = ArgEnd;
+	}
+	length |= DEFERRED_LOG_TRUNCATED;
+}
+
+/** @brief Copy a record into the ring or count it as dropped. */
+void DeferredLogClass::push(const uint8_t * record, uint8_t length)
+{
+#if defined(ESP32)
+	portENTER_CRITICAL_SAFE(&m_mux);
+#elif defined(__AVR__)
+	uint8_t SregL = SREG;
+	cli();
+#endif
+
+	uint16_t HeadL = m_head;
+	uint16_t FreeL = (uint16_t)((m_tail + DEFERRED_LOG_SIZE - HeadL - 1) % DEFERRED_LOG_SIZE);
+
+	if (length > FreeL)
+	{
+		m_dropped++;
+	}
+	else
+	{
+		for (uint8_t index = 0; index < length; index++)
+		{
+			m_ring[HeadL] = record[index];
+			HeadL++;
+			if (HeadL >= DEFERRED_LOG_SIZE)
+			{
+				HeadL = 0;
+			}
+		}
+
+		// Publish the record after its bytes.
+		__sync_synchronize();
+		m_head = HeadL;
+	}
+
+#if defined(ESP32)
+	portEXIT_CRITICAL_SAFE(&m_mux);
+#elif defined(__AVR__)
+	SREG = SregL;
+#endif
+}
+
+/** @brief Write the format string definition if not sent yet.
+ *  @return uint8_t, Id of the format.
+ */
+uint8_t DeferredLogClass::format_id(const char * format)
+{
+	for (uint8_t index = 0; index < m_formatsCount; index++)
+	{
+		if (m_formats[index] == format)
+		{
+			return index;
+		}
+	}
+
+	// Table full, the host drops its table too.
+	if (m_formatsCount >= DEFERRED_LOG_FORMATS)
+	{
+		m_port->write((uint8_t)DEFERRED_LOG_MARK_RESTART);
+		m_formatsCount = 0;
+	}
+
+	size_t LengthL = strlen(format);
+	if (LengthL > 0xFF)
+	{
+		LengthL = 0xFF;
+	}
+
+	uint8_t IdL = m_formatsCount++;
+	m_formats[IdL] = format;
+
+	m_port->write((uint8_t)DEFERRED_LOG_MARK_FORMAT);
+	m_port->write(IdL);
+	m_port->write((uint8_t)LengthL);
+	m_port->write((const uint8_t *)format, LengthL);
+
+	return IdL;
+}
+
+/** @brief Render queued records to the output.
+ *  @param budget uint16_t, Maximum count of the records.
+ *  @return uint16_t, Count of the rendered records.
+ */
+uint16_t DeferredLogClass::drain(uint16_t budget)
+{
+	uint16_t CountL = 0;
+
+	if (m_port == NULL)
+	{
+		return 0;
+	}
+
+	while ((CountL < budget) && (m_tail != m_head))
+	{
+		uint8_t RecordL[DEFERRED_LOG_RECORD_MAX];
+		uint16_t TailL = m_tail;
+		uint8_t LengthL = m_ring[TailL];
+
+		for (uint8_t index = 0; index < LengthL; index++)
+		{
+			RecordL[index] = m_ring[TailL];
+			TailL++;
+			if (TailL >= DEFERRED_LOG_SIZE)
+			{
+				TailL = 0;
+			}
+		}
+
+		// Free the space only after the copy.
+		__sync_synchronize();
+		m_tail = TailL;
+
+		uint32_t TimestampL;
+		const char * FormatL;
+		memcpy(&TimestampL, &RecordL[1], sizeof(TimestampL));
+		memcpy(&FormatL, &RecordL[1 + sizeof(TimestampL)], sizeof(FormatL));
+
+		if (m_mode == DeferredLogModes::LogBinary)
+		{
+			uint8_t IdL = format_id(FormatL);
+			m_port->write((uint8_t)DEFERRED_LOG_MARK_RECORD);
+			m_port->write(IdL);
+			m_port->write((uint8_t)(sizeof(TimestampL) + LengthL - DEFERRED_LOG_HEADER_LEN));
+			m_port->write((const uint8_t *)&TimestampL, sizeof(TimestampL));
+			m_port->write(&RecordL[DEFERRED_LOG_HEADER_LEN], LengthL - DEFERRED_LOG_HEADER_LEN);
+		}
+		else
+		{
+			render(*m_port, FormatL, &RecordL[DEFERRED_LOG_HEADER_LEN], LengthL - DEFERRED_LOG_HEADER_LEN);
+		}
+
+		CountL++;
+	}
+
+	uint32_t DroppedL = m_dropped;
+	if (DroppedL != m_droppedReported)
+	{
+		uint32_t LostL = DroppedL - m_droppedReported;
+		m_droppedReported = DroppedL;
+
+		if (m_mode == DeferredLogModes::LogBinary)
+		{
+			m_port->write((uint8_t)DEFERRED_LOG_MARK_DROPPED);
+			m_port->write((const uint8_t *)&LostL, sizeof(LostL));
+		}
+		else
+		{
+			m_port->print("[log: ");
+			m_port->print((unsigned long)LostL);
+			m_port->print(" dropped]\r\n");
+		}
+	}
+
+	return CountL;
+}
+
+/** @brief Bytes waiting in the ring.
+ *  @return uint16_t, Count.
+ */
+uint16_t DeferredLogClass::pending()
+{
+	return (uint16_t)((m_head + DEFERRED_LOG_SIZE - m_tail) % DEFERRED_LOG_SIZE);
+}
+
+#if defined(ESP32)
+/** @brief Body of the drain task. */
+static void deferred_log_task(void * parameter)
+{
+	DeferredLogClass * LogL = (DeferredLogClass *)parameter;
+
+	for (;;)
+	{
+		if (LogL->drain() == 0)
+		{
+			vTaskDelay(1);
+		}
+	}
+}
+
+/** @brief Drain from a low priority task.
+ *  @param priority uint8_t, FreeRTOS priority, above idle.
+ *  @param core uint8_t, Core to pin the task to.
+ *  @return Void.
+ */
+void DeferredLogClass::start_task(uint8_t priority, uint8_t core)
+{
+	xTaskCreatePinnedToCore(deferred_log_task, "DeferredLog", 4096, this, priority, NULL, core);
+}
+#endif
+
+/** @brief Print a format string with serialised arguments.
+ *  @param port Print, Output.
+ *  @param format const char *, Format string.
+ *  @param args const uint8_t *, Tagged arguments.
+ *  @param length uint8_t, Length of the arguments.
+ *  @return Void.
+ */
+void DeferredLogClass::render(Print &port, const char * format, const uint8_t * args, uint8_t length)
+{
+	char SpecL[DEFERRED_LOG_SPEC_MAX + 4];
+	char OutL[DEFERRED_LOG_STRING_MAX + 32];
+	DeferredArg_t ArgL;
+	uint8_t IndexL = 0;
+
+	while (*format != '\0')
+	{
+		// Literal run.
+		const char * StartL = format;
+		while ((*format != '\0') && (*format != '%'))
+		{
+			format++;
+		}
+		if (format != StartL)
+		{
+			port.write((const uint8_t *)StartL, format - StartL);
+		}
+		if (*format == '\0')
+		{
+			break;
+		}
+
+		if (format[1] == '%')
+		{
+			port.write((uint8_t)'%');
+			format += 2;
+			continue;
+		}
+
+		// Flags, width and precision, '*' takes an argument.
+		uint8_t SpecLengthL = 0;
+		SpecL[SpecLengthL++] = *format++;
+		while ((*format != '\0') && (strchr("-+ #0123456789.*", *format) != NULL))
+		{
+			if (*format == '*')
+			{
+				long StarL = next_arg(args, length, IndexL, ArgL) ? (long)ArgL.Int : 0;
+				if (SpecLengthL < DEFERRED_LOG_SPEC_MAX)
+				{
+					// snprintf returns the length it wanted, not the one it wrote.
+					int WrittenL = snprintf(&SpecL[SpecLengthL], DEFERRED_LOG_SPEC_MAX - SpecLengthL, "%ld", StarL);
+					if (WrittenL > 0)
+					{
+						SpecLengthL = ((SpecLengthL + WrittenL) < DEFERRED_LOG_SPEC_MAX) ? (SpecLengthL + WrittenL) : (DEFERRED_LOG_SPEC_MAX - 1);
+					}
+				}
+			}
+			else if (SpecLengthL < DEFERRED_LOG_SPEC_MAX)
+			{
+				SpecL[SpecLengthL++] = *format;
+			}
+			format++;
+		}
+
+		// The stored width replaces the length modifiers.
+		while ((*format != '\0') && (strchr("hlLqjzt", *format) != NULL))
+		{
+			format++;
+		}
+
+		char ConversionL = *format;
+		if (ConversionL == '\0')
+		{
+			break;
+		}
+		format++;
+
+		if (!next_arg(args, length, IndexL, ArgL))
+		{
+			port.write((uint8_t)'?');
+			continue;
+		}
+
+		if (strchr("diouxX", ConversionL) != NULL)
+		{
+			memcpy(&SpecL[SpecLengthL], DEFERRED_LOG_INT_MODIFIER, sizeof(DEFERRED_LOG_INT_MODIFIER) - 1);
+			SpecLengthL += sizeof(DEFERRED_LOG_INT_MODIFIER) - 1;
+			SpecL[SpecLengthL++] = ConversionL;
+			SpecL[SpecLengthL] = '\0';
+			if ((ConversionL == 'd') || (ConversionL == 'i'))
+			{
+				snprintf(OutL, sizeof(OutL), SpecL, ArgL.Int);
+			}
+			else
+			{
+				snprintf(OutL, sizeof(OutL), SpecL, (DeferredUInt_t)ArgL.Int);
+			}
+		}
+		else if (strchr("fFeEgGaA", ConversionL) != NULL)
+		{
+			SpecL[SpecLengthL++] = ConversionL;
+			SpecL[SpecLengthL] = '\0';
+			snprintf(OutL, sizeof(OutL), SpecL, ArgL.Float);
+		}
+		else if (ConversionL == 'c')
+		{
+			SpecL[SpecLengthL++] = 'c';
+			SpecL[SpecLengthL] = '\0';
+			snprintf(OutL, sizeof(OutL), SpecL, (int)ArgL.Int);
+		}
+		else if (ConversionL == 's')
+		{
+			SpecL[SpecLengthL++] = 's';
+			SpecL[SpecLengthL] = '\0';
+			snprintf(OutL, sizeof(OutL), SpecL, (ArgL.Tag == ArgStr) ? ArgL.Str : "?");
+		}
+		else if (ConversionL == 'p')
+		{
+			snprintf(OutL, sizeof(OutL), "0x%" DEFERRED_LOG_INT_MODIFIER "x", (DeferredUInt_t)ArgL.Int);
+		}
+		else
+		{
+			OutL[0] = '\0';
+		}
+
+		port.print(OutL);
+	}
+}
+
+#if defined(ENABLE_DEFERRED_LOG)
+DeferredLogClass DeferredLog;
+#endif
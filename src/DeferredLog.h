@@ -0,0 +1,276 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// DeferredLog.h
+
+/*
+	DEBUGLOG() through this logger only copies the format pointer, a
+	timestamp and the raw arguments into a byte ring, the formatting
+	and the UART wait happen later in drain().
+
+	Ring record:
+
+	+--------+-----------+----------------+-----------------------------+
+	| Length | Timestamp | Format pointer | Tag and value per argument. |
+	+--------+-----------+----------------+-----------------------------+
+
+	Strings are copied, up to DEFERRED_LOG_STRING_MAX characters, the
+	format string must stay valid (literals, __PRETTY_FUNCTION__).
+
+	Binary mode stream, decoded by extras/host/tools/log_decode:
+
+	+------+----+--------+---------------------------------------------+
+	| 0xFD | Id | Length | Format string, sent once per Id.            |
+	| 0xFE | Id | Length | Timestamp, arguments.                       |
+	| 0xFC |    |        | Id table restarted.                         |
+	| 0xFB | Count (4)   | Records dropped because the ring was full.  |
+	+------+----+--------+---------------------------------------------+
+*/
+
+#ifndef _DEFERREDLOG_h
+#define _DEFERREDLOG_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/** @brief Size of the byte ring. */
+#ifndef DEFERRED_LOG_SIZE
+#if defined(__AVR__)
+#define DEFERRED_LOG_SIZE 128
+#else
+#define DEFERRED_LOG_SIZE 2048
+#endif
+#endif
+
+/** @brief Longest record, arguments that do not fit are left out. */
+#define DEFERRED_LOG_RECORD_MAX 64
+
+/** @brief Length bit set once an argument did not fit, while the record is built. */
+#define DEFERRED_LOG_TRUNCATED 0x80
+
+/** @brief Longest copied string argument. */
+#define DEFERRED_LOG_STRING_MAX 32
+
+/** @brief Format strings remembered by the binary mode. */
+#define DEFERRED_LOG_FORMATS 32
+
+/** @brief Records rendered by one drain() call. */
+#define DEFERRED_LOG_DRAIN_BUDGET 8
+
+/** @brief Length of the record header. */
+#define DEFERRED_LOG_HEADER_LEN (1 + sizeof(uint32_t) + sizeof(const char *))
+
+/** @brief Binary mode markers. */
+#define DEFERRED_LOG_MARK_FORMAT 0xFD
+#define DEFERRED_LOG_MARK_RECORD 0xFE
+#define DEFERRED_LOG_MARK_RESTART 0xFC
+#define DEFERRED_LOG_MARK_DROPPED 0xFB
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Output of drain(). */
+enum DeferredLogModes : uint8_t
+{
+	LogText = 0U, ///< Same text printf would have written.
+	LogBinary, ///< Format once, then records, decoded on the host.
+};
+
+/** @brief Argument tags. */
+enum DeferredLogArgs : uint8_t
+{
+	ArgI32 = 1U, ///< Signed, 4 bytes.
+	ArgU32, ///< Unsigned, 4 bytes.
+	ArgI64, ///< Signed, 8 bytes.
+	ArgU64, ///< Unsigned, 8 bytes.
+	ArgF32, ///< float, 4 bytes.
+	ArgF64, ///< double, 8 bytes.
+	ArgStr, ///< Length byte and characters.
+	ArgEnd = 0xFFU, ///< The arguments from here on did not fit.
+};
+
+#pragma endregion
+
+class DeferredLogClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Byte ring. */
+	uint8_t m_ring[DEFERRED_LOG_SIZE];
+
+	/** @brief Write index, only the producer moves it. */
+	volatile uint16_t m_head;
+
+	/** @brief Read index, only drain() moves it. */
+	volatile uint16_t m_tail;
+
+	/** @brief Count of the records that did not fit. */
+	volatile uint32_t m_dropped;
+
+	/** @brief Dropped count already reported. */
+	uint32_t m_droppedReported;
+
+	/** @brief Output of drain(). */
+	Print * m_port;
+
+	/** @brief Output mode. */
+	uint8_t m_mode;
+
+	/** @brief Format strings already sent in binary mode. */
+	const char * m_formats[DEFERRED_LOG_FORMATS];
+
+	/** @brief Count of the sent format strings. */
+	uint8_t m_formatsCount;
+
+#if defined(ESP32)
+	/** @brief Serialises the producers of both cores and the ISRs. */
+	portMUX_TYPE m_mux;
+#endif
+
+#pragma endregion
+
+#pragma region Methods
+
+	/** @brief Copy a record into the ring or count it as dropped. */
+	void push(const uint8_t * record, uint8_t length);
+
+	/** @brief Write the format string definition if not sent yet.
+	 *  @return uint8_t, Id of the format.
+	 */
+	uint8_t format_id(const char * format);
+
+	void add(uint8_t * record, uint8_t &length, uint8_t tag, const void * value, uint8_t size);
+
+	/** @brief Close the record after the last argument that fit. */
+	void truncate(uint8_t * record, uint8_t &length);
+
+	void add_arg(uint8_t * record, uint8_t &length, long long value) { add(record, length, ArgI64, &value, 8); }
+	void add_arg(uint8_t * record, uint8_t &length, unsigned long long value) { add(record, length, ArgU64, &value, 8); }
+	void add_arg(uint8_t * record, uint8_t &length, long value);
+	void add_arg(uint8_t * record, uint8_t &length, unsigned long value);
+	void add_arg(uint8_t * record, uint8_t &length, int value) { add_arg(record, length, (long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, unsigned int value) { add_arg(record, length, (unsigned long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, short value) { add_arg(record, length, (long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, unsigned short value) { add_arg(record, length, (unsigned long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, char value) { add_arg(record, length, (long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, signed char value) { add_arg(record, length, (long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, unsigned char value) { add_arg(record, length, (unsigned long)value); }
+	void add_arg(uint8_t * record, uint8_t &length, double value);
+	void add_arg(uint8_t * record, uint8_t &length, float value) { add_arg(record, length, (double)value); }
+	void add_arg(uint8_t * record, uint8_t &length, const char * value);
+	void add_arg(uint8_t * record, uint8_t &length, char * value) { add_arg(record, length, (const char *)value); }
+	void add_arg(uint8_t * record, uint8_t &length, const void * value) { add_arg(record, length, (unsigned long)(uintptr_t)value); }
+
+	inline void add_args(uint8_t * record, uint8_t &length) { (void)record; (void)length; }
+
+	template<typename T, typename... Args>
+	inline void add_args(uint8_t * record, uint8_t &length, T value, Args... args)
+	{
+		add_arg(record, length, value);
+		add_args(record, length, args...);
+	}
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	DeferredLogClass();
+
+	/** @brief Set the output of drain().
+	 *  @param port Print, Output.
+	 *  @param mode uint8_t, DeferredLogModes value.
+	 *  @return Void.
+	 */
+	void begin(Print &port, uint8_t mode = DeferredLogModes::LogText);
+
+	/** @brief Queue one log line, the same arguments as printf.
+	 *  @param format const char *, Format string, must stay valid.
+	 *  @return Void.
+	 */
+	template<typename... Args>
+	void log(const char * format, Args... args)
+	{
+		uint8_t RecordL[DEFERRED_LOG_RECORD_MAX];
+		uint32_t TimestampL = micros();
+		uint8_t LengthL = DEFERRED_LOG_HEADER_LEN;
+
+		memcpy(&RecordL[1], &TimestampL, sizeof(TimestampL));
+		memcpy(&RecordL[1 + sizeof(TimestampL)], &format, sizeof(format));
+		add_args(RecordL, LengthL, args...);
+		LengthL &= ~DEFERRED_LOG_TRUNCATED;
+		RecordL[0] = LengthL;
+
+		push(RecordL, LengthL);
+	}
+
+	/** @brief Render queued records to the output.
+	 *  @param budget uint16_t, Maximum count of the records.
+	 *  @return uint16_t, Count of the rendered records.
+	 */
+	uint16_t drain(uint16_t budget = DEFERRED_LOG_DRAIN_BUDGET);
+
+	/** @brief Count of the records that did not fit.
+	 *  @return uint32_t, Count.
+	 */
+	inline uint32_t dropped() { return m_dropped; }
+
+	/** @brief Bytes waiting in the ring.
+	 *  @return uint16_t, Count.
+	 */
+	uint16_t pending();
+
+#if defined(ESP32)
+	/** @brief Drain from a low priority task.
+	 *  @param priority uint8_t, FreeRTOS priority, above idle.
+	 *  @param core uint8_t, Core to pin the task to.
+	 *  @return Void.
+	 */
+	void start_task(uint8_t priority = 1, uint8_t core = 0);
+#endif
+
+	/** @brief Print a format string with serialised arguments.
+	 *  @param port Print, Output.
+	 *  @param format const char *, Format string.
+	 *  @param args const uint8_t *, Tagged arguments.
+	 *  @param length uint8_t, Length of the arguments.
+	 *  @return Void.
+	 */
+	static void render(Print &port, const char * format, const uint8_t * args, uint8_t length);
+
+#pragma endregion
+
+};
+
+/** @brief Instance of the deferred logger, exists with ENABLE_DEFERRED_LOG. */
+extern DeferredLogClass DeferredLog;
+
+#endif
@@ -0,0 +1,186 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "FrameTrace.h"
+
+/**
+ * @brief Construct a new FrameTraceClass object
+ *
+ */
+FrameTraceClass::FrameTraceClass()
+{
+	m_enabled = false;
+	m_stopOnError = false;
+	clear();
+}
+
+/** @brief Drop all records.
+ *  @return Void.
+ */
+void FrameTraceClass::clear()
+{
+	m_tail = 0;
+	m_count = 0;
+	m_overwritten = 0;
+	m_lastTime = 0;
+	m_restart = true;
+	m_stopCountdown = 0;
+}
+
+/** @brief Start or stop recording.
+ *  @param enabled bool, Recording flag.
+ *  @param stop_on_error bool, Keep the error in the middle of the ring and stop.
+ *  @return Void.
+ */
+void FrameTraceClass::enable(bool enabled, bool stop_on_error)
+{
+	if (enabled && !m_enabled)
+	{
+		// The gap while stopped is not a line delay.
+		m_restart = true;
+	}
+
+	m_enabled = enabled;
+	m_stopOnError = stop_on_error;
+	m_stopCountdown = 0;
+}
+
+/** @brief Add one parsed byte, the oldest is overwritten when full.
+ *  @param timestamp unsigned long, Time in us.
+ *  @param state uint8_t, Parser state after the byte.
+ *  @param event uint8_t, FrameTraceEvents value.
+ *  @param input uint8_t, Byte read from the port.
+ *  @return Void.
+ */
+void FrameTraceClass::record(unsigned long timestamp, uint8_t state, uint8_t event, uint8_t input)
+{
+	if (!m_enabled)
+	{
+		return;
+	}
+
+	uint16_t IndexL;
+	if (m_count < FRAME_TRACE_SIZE)
+	{
+		IndexL = m_tail + m_count;
+		if (IndexL >= FRAME_TRACE_SIZE)
+		{
+			IndexL -= FRAME_TRACE_SIZE;
+		}
+		m_count++;
+	}
+	else
+	{
+		IndexL = m_tail;
+		m_tail++;
+		if (m_tail >= FRAME_TRACE_SIZE)
+		{
+			m_tail = 0;
+		}
+		m_overwritten++;
+	}
+
+	unsigned long DeltaL = timestamp - m_lastTime;
+	if (m_restart || (DeltaL > FRAME_TRACE_DELTA_MAX))
+	{
+		DeltaL = FRAME_TRACE_DELTA_MAX;
+		m_restart = false;
+	}
+	m_lastTime = timestamp;
+
+	m_records[IndexL].Delta = (uint16_t)DeltaL;
+	m_records[IndexL].State = (uint8_t)((event << 4) | (state & 0x0F));
+	m_records[IndexL].Input = input;
+
+	if (m_stopCountdown > 0)
+	{
+		if (--m_stopCountdown == 0)
+		{
+			m_enabled = false;
+		}
+	}
+	else if (m_stopOnError && ((event == FrameTraceEvents::EventReject) || (event == FrameTraceEvents::EventCRCError)))
+	{
+		// Half a ring of history before the error, half after it.
+		m_stopCountdown = FRAME_TRACE_SIZE / 2;
+	}
+}
+
+/** @brief Serialise records, oldest first.
+ *  @param offset uint16_t, Index of the first record.
+ *  @param out uint8_t *, Output buffer.
+ *  @param size uint8_t, Size of the output buffer.
+ *  @return uint8_t, Count of the serialised records.
+ */
+uint8_t FrameTraceClass::read(uint16_t offset, uint8_t * out, uint8_t size)
+{
+	uint8_t CountL = 0;
+
+	while ((offset < m_count) && ((uint8_t)(CountL + 1) * FRAME_TRACE_RECORD_LEN <= size))
+	{
+		uint16_t IndexL = m_tail + offset;
+		if (IndexL >= FRAME_TRACE_SIZE)
+		{
+			IndexL -= FRAME_TRACE_SIZE;
+		}
+
+		const FrameTraceRecord_t &RecordL = m_records[IndexL];
+		out[0] = (uint8_t)(RecordL.Delta & 0xFF);
+		out[1] = (uint8_t)(RecordL.Delta >> 8);
+		out[2] = RecordL.State;
+		out[3] = RecordL.Input;
+
+		out += FRAME_TRACE_RECORD_LEN;
+		offset++;
+		CountL++;
+	}
+
+	return CountL;
+}
+
+/** @brief Dump the ring as hex text, one FRAME_TRACE_DUMP_LINE per line.
+ *  @param port Print, Output.
+ *  @return Void.
+ */
+void FrameTraceClass::dump(Print &port)
+{
+	uint8_t LineL[FRAME_TRACE_RECORD_LEN * FRAME_TRACE_DUMP_LINE];
+	char HexL[3];
+
+	port.print("FRAMETRACE ");
+	port.print(m_count);
+	port.print(" ");
+	port.print(m_overwritten);
+	port.print("\r\n");
+
+	for (uint16_t offset = 0; offset < m_count; offset += FRAME_TRACE_DUMP_LINE)
+	{
+		uint8_t CountL = read(offset, LineL, sizeof(LineL));
+		for (uint8_t index = 0; index < CountL * FRAME_TRACE_RECORD_LEN; index++)
+		{
+			snprintf(HexL, sizeof(HexL), "%02X", LineL[index]);
+			port.print(HexL);
+		}
+		port.print("\r\n");
+	}
+
+	port.print("END\r\n");
+}
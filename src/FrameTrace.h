@@ -0,0 +1,200 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// FrameTrace.h
+
+/*
+	Record layout, 4 bytes, little endian:
+
+	+---------+---------+----------------------+-----------+
+	| Byte 0  | Byte 1  | Byte 2               | Byte 3    |
+	+---------+---------+----------------------+-----------+
+	| Delta L | Delta H | Event << 4 | State   | Input     |
+	+---------+---------+----------------------+-----------+
+
+	One record per byte read by SUPERClass::read_frame(). State is the
+	parser state after the byte, Event tells why the state changed.
+	Delta is the time from the previous record in us, saturated at
+	0xFFFF, the first record after clear or enable is always 0xFFFF.
+*/
+
+#ifndef _FRAMETRACE_h
+#define _FRAMETRACE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/** @brief Length of one serialised record. */
+#define FRAME_TRACE_RECORD_LEN 4
+
+/** @brief Count of the records in the ring. */
+#ifndef FRAME_TRACE_SIZE
+#if defined(__AVR__)
+#define FRAME_TRACE_SIZE 64
+#else
+#define FRAME_TRACE_SIZE 512
+#endif
+#endif
+
+/** @brief Saturated time delta, also marks the start of a trace. */
+#define FRAME_TRACE_DELTA_MAX 0xFFFF
+
+/** @brief Records in one dump line. */
+#define FRAME_TRACE_DUMP_LINE 8
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Reason of the state change. */
+enum FrameTraceEvents : uint8_t
+{
+	EventByte = 0U, ///< Byte accepted by the current state.
+	EventReject, ///< Bad frame type or length, back to the sentinel.
+	EventFrame, ///< CRC valid, the frame was dispatched.
+	EventCRCError, ///< CRC invalid, the frame was dropped.
+};
+
+/** @brief Flags of the FrameTraceControl request. */
+enum FrameTraceFlags : uint8_t
+{
+	FrameTraceEnable = 0x01, ///< Record the parsed bytes.
+	FrameTraceClear = 0x02, ///< Drop the recorded bytes.
+	FrameTraceDump = 0x04, ///< Dump the ring to the debug port.
+	FrameTraceStopOnError = 0x08, ///< Stop half a ring after a reject or CRC error.
+};
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief One parsed byte. */
+typedef struct __attribute__((packed))
+{
+	uint16_t Delta; ///< Time from the previous record in us.
+	uint8_t State; ///< Event in the high nibble, parser state in the low.
+	uint8_t Input; ///< Byte read from the port.
+} FrameTraceRecord_t;
+
+#pragma endregion
+
+class FrameTraceClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Record ring. */
+	FrameTraceRecord_t m_records[FRAME_TRACE_SIZE];
+
+	/** @brief Index of the oldest record. */
+	uint16_t m_tail;
+
+	/** @brief Count of the records in the ring. */
+	uint16_t m_count;
+
+	/** @brief Count of the records overwritten since clear. */
+	uint32_t m_overwritten;
+
+	/** @brief Time of the last record. */
+	unsigned long m_lastTime;
+
+	/** @brief Next record starts a new time base. */
+	bool m_restart;
+
+	/** @brief Recording flag. */
+	bool m_enabled;
+
+	/** @brief Stop after an error. */
+	bool m_stopOnError;
+
+	/** @brief Records left before the stop, 0 while not triggered. */
+	uint16_t m_stopCountdown;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	FrameTraceClass();
+
+	/** @brief Drop all records.
+	 *  @return Void.
+	 */
+	void clear();
+
+	/** @brief Start or stop recording.
+	 *  @param enabled bool, Recording flag.
+	 *  @param stop_on_error bool, Keep the error in the middle of the ring and stop.
+	 *  @return Void.
+	 */
+	void enable(bool enabled, bool stop_on_error = false);
+
+	/** @brief Recording flag.
+	 *  @return bool, True while recording.
+	 */
+	inline bool enabled() { return m_enabled; }
+
+	/** @brief Add one parsed byte, the oldest is overwritten when full.
+	 *  @param timestamp unsigned long, Time in us.
+	 *  @param state uint8_t, Parser state after the byte.
+	 *  @param event uint8_t, FrameTraceEvents value.
+	 *  @param input uint8_t, Byte read from the port.
+	 *  @return Void.
+	 */
+	void record(unsigned long timestamp, uint8_t state, uint8_t event, uint8_t input);
+
+	/** @brief Count of the records in the ring.
+	 *  @return uint16_t, Count.
+	 */
+	inline uint16_t count() { return m_count; }
+
+	/** @brief Count of the records lost to the ring wrap.
+	 *  @return uint32_t, Count.
+	 */
+	inline uint32_t overwritten() { return m_overwritten; }
+
+	/** @brief Serialise records, oldest first.
+	 *  @param offset uint16_t, Index of the first record.
+	 *  @param out uint8_t *, Output buffer.
+	 *  @param size uint8_t, Size of the output buffer.
+	 *  @return uint8_t, Count of the serialised records.
+	 */
+	uint8_t read(uint16_t offset, uint8_t * out, uint8_t size);
+
+	/** @brief Dump the ring as hex text, one FRAME_TRACE_DUMP_LINE per line.
+	 *  @param port Print, Output.
+	 *  @return Void.
+	 */
+	void dump(Print &port);
+
+#pragma endregion
+
+};
+
+#endif
@@ -0,0 +1,382 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "Homing.h"
+
+#pragma region Protected Methods
+
+/** @brief Start the fast approach of the axis.
+ *  @param axis uint8_t, Axis.
+ *  @return Void.
+ */
+void HomingClass::begin_axis(uint8_t axis)
+{
+	AccelStepper * StepperL = m_steppers[axis];
+	const HomingAxis_t &ConfigL = m_config[axis];
+
+	m_maxSpeed[axis] = StepperL->maxSpeed();
+	StepperL->setMaxSpeed(ConfigL.FastSpeed);
+
+	// Already on the switch, nothing to approach.
+	if (pressed(axis))
+	{
+		StepperL->move(-ConfigL.Direction * ConfigL.Backoff);
+		m_phase[axis] = HomePhases::HomeBackoff;
+		return;
+	}
+
+	arm(axis);
+	StepperL->move(ConfigL.Direction * ConfigL.MaxTravel);
+	m_phase[axis] = HomePhases::HomeFast;
+}
+
+/** @brief End the sequence of the axis.
+ *  @param axis uint8_t, Axis.
+ *  @param homed bool, True if the zero was set.
+ *  @return Void.
+ */
+void HomingClass::end_axis(uint8_t axis, bool homed)
+{
+	noInterrupts();
+	bitClear(m_armed, axis);
+	bitClear(m_latched, axis);
+	interrupts();
+
+	if (homed == false)
+	{
+		m_steppers[axis]->stop();
+	}
+	m_steppers[axis]->setMaxSpeed(m_maxSpeed[axis]);
+	m_phase[axis] = HomePhases::HomeIdle;
+
+	if (homed)
+	{
+		bitSet(m_homed, axis);
+	}
+	else
+	{
+		bitSet(m_failed, axis);
+	}
+}
+
+/** @brief Arm the edge latch of the axis.
+ *  @param axis uint8_t, Axis.
+ *  @return Void.
+ */
+void HomingClass::arm(uint8_t axis)
+{
+	noInterrupts();
+	bitClear(m_latched, axis);
+	bitSet(m_armed, axis);
+	interrupts();
+}
+
+/** @brief Take the latched edge of the axis.
+ *  @param axis uint8_t, Axis.
+ *  @param position long, Position at the edge.
+ *  @return bool, True if an edge was latched.
+ */
+bool HomingClass::take_edge(uint8_t axis, long &position)
+{
+	bool LatchedL = false;
+
+	noInterrupts();
+	if (bitRead(m_latched, axis))
+	{
+		position = m_edge[axis];
+		bitClear(m_latched, axis);
+		LatchedL = true;
+	}
+	interrupts();
+
+	return LatchedL;
+}
+
+/** @brief The switch of the axis is pressed.
+ *  @param axis uint8_t, Axis.
+ *  @return bool, True if pressed.
+ */
+bool HomingClass::pressed(uint8_t axis)
+{
+	return (digitalRead(m_config[axis].Pin) == m_config[axis].ActiveLevel);
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+/**
+ * @brief Construct a new HomingClass object
+ * 
+ */
+HomingClass::HomingClass()
+{
+	memset(m_steppers, 0, sizeof(m_steppers));
+	memset(m_config, 0, sizeof(m_config));
+	memset(m_phase, 0, sizeof(m_phase));
+	memset(m_maxSpeed, 0, sizeof(m_maxSpeed));
+	for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+	{
+		m_edge[axis] = 0;
+	}
+	m_armed = 0;
+	m_latched = 0;
+	m_pending = 0;
+	m_homed = 0;
+	m_failed = 0;
+}
+
+/** @brief Attach the stepper and the switch of an axis.
+ *  @param axis uint8_t, Axis.
+ *  @param stepper AccelStepper *, Stepper the caller keeps running.
+ *  @param config HomingAxis_t, Parameters.
+ *  @return bool, True if the parameters are valid.
+ */
+bool HomingClass::attach(uint8_t axis, AccelStepper * stepper, const HomingAxis_t &config)
+{
+	if ((axis >= JOINTS_COUNT) || (stepper == NULL) ||
+		((config.Direction != 1) && (config.Direction != -1)) ||
+		(config.FastSpeed <= 0.0f) || (config.SlowSpeed <= 0.0f) ||
+		(config.Backoff <= 0) || (config.MaxTravel <= 0))
+	{
+		return false;
+	}
+
+	// Not under a running sequence.
+	if (m_phase[axis] != HomePhases::HomeIdle)
+	{
+		return false;
+	}
+
+	m_steppers[axis] = stepper;
+	m_config[axis] = config;
+
+	return true;
+}
+
+/** @brief Start homing, the caller keeps calling run() of the steppers.
+ *  @param mask uint8_t, Axes to home.
+ *  @param flags uint8_t, HomeFlags.
+ *  @return bool, False if homing runs or an axis has no switch.
+ */
+bool HomingClass::start(uint8_t mask, uint8_t flags)
+{
+	if ((mask == 0) || (get_active() != 0) || ((mask >> JOINTS_COUNT) != 0))
+	{
+		return false;
+	}
+
+	for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+	{
+		if (bitRead(mask, axis) && (m_steppers[axis] == NULL))
+		{
+			return false;
+		}
+	}
+
+	m_homed &= ~mask;
+	m_failed &= ~mask;
+
+	if (flags & HomeFlags::HomeParallel)
+	{
+		for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+		{
+			if (bitRead(mask, axis))
+			{
+				begin_axis(axis);
+			}
+		}
+	}
+	else
+	{
+		// update() takes them one by one.
+		m_pending = mask;
+		update();
+	}
+
+	return true;
+}
+
+/** @brief Stop homing, the axes decelerate and stay unhomed.
+ *  @return Void.
+ */
+void HomingClass::abort()
+{
+	m_pending = 0;
+
+	for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+	{
+		if (m_phase[axis] != HomePhases::HomeIdle)
+		{
+			end_axis(axis, false);
+			bitClear(m_failed, axis);
+		}
+	}
+}
+
+/** @brief Advance the sequences, call it from the loop.
+ *  @return Void.
+ */
+void HomingClass::update()
+{
+	bool BusyL = false;
+	long EdgeL = 0;
+
+	for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+	{
+		AccelStepper * StepperL = m_steppers[axis];
+		const HomingAxis_t &ConfigL = m_config[axis];
+
+		switch (m_phase[axis])
+		{
+		case HomePhases::HomeFast:
+			if (take_edge(axis, EdgeL))
+			{
+				StepperL->stop();
+				m_phase[axis] = HomePhases::HomeFastStop;
+			}
+			else if (StepperL->distanceToGo() == 0)
+			{
+				// The whole travel without a switch.
+				end_axis(axis, false);
+			}
+			break;
+
+		case HomePhases::HomeFastStop:
+			if (StepperL->distanceToGo() == 0)
+			{
+				StepperL->move(-ConfigL.Direction * ConfigL.Backoff);
+				m_phase[axis] = HomePhases::HomeBackoff;
+			}
+			break;
+
+		case HomePhases::HomeBackoff:
+			if (StepperL->distanceToGo() == 0)
+			{
+				if (pressed(axis))
+				{
+					// Stuck switch or a back off shorter than the overshoot.
+					end_axis(axis, false);
+					break;
+				}
+
+				StepperL->setMaxSpeed(ConfigL.SlowSpeed);
+				arm(axis);
+				StepperL->move(ConfigL.Direction * 2 * ConfigL.Backoff);
+				m_phase[axis] = HomePhases::HomeSlow;
+			}
+			break;
+
+		case HomePhases::HomeSlow:
+			if (take_edge(axis, EdgeL))
+			{
+				// Slow enough to stop at once, the edge becomes the offset.
+				StepperL->setCurrentPosition(StepperL->currentPosition() - EdgeL + ConfigL.Offset);
+				end_axis(axis, true);
+			}
+			else if (StepperL->distanceToGo() == 0)
+			{
+				end_axis(axis, false);
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		if (m_phase[axis] != HomePhases::HomeIdle)
+		{
+			BusyL = true;
+		}
+	}
+
+	// Sequential homing, the next axis once the last one is done.
+	if ((BusyL == false) && (m_pending != 0))
+	{
+		for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+		{
+			if (bitRead(m_pending, axis))
+			{
+				bitClear(m_pending, axis);
+				begin_axis(axis);
+				break;
+			}
+		}
+	}
+}
+
+/** @brief Latch the edge of the switch, call it from the ISR of the axis.
+ *  @param axis uint8_t, Axis.
+ *  @return Void.
+ */
+void HomingClass::latch(uint8_t axis)
+{
+	if ((axis >= JOINTS_COUNT) || (bitRead(m_armed, axis) == 0))
+	{
+		return;
+	}
+
+	m_edge[axis] = m_steppers[axis]->currentPosition();
+	m_armed &= ~(1U << axis);
+	m_latched |= (1U << axis);
+}
+
+/** @brief Axes that are homing or waiting for it.
+ *  @return uint8_t, Mask.
+ */
+uint8_t HomingClass::get_active()
+{
+	uint8_t MaskL = m_pending;
+
+	for (uint8_t axis = 0; axis < JOINTS_COUNT; axis++)
+	{
+		if (m_phase[axis] != HomePhases::HomeIdle)
+		{
+			bitSet(MaskL, axis);
+		}
+	}
+
+	return MaskL;
+}
+
+/** @brief Axes homed since the last start.
+ *  @return uint8_t, Mask.
+ */
+uint8_t HomingClass::get_homed()
+{
+	return m_homed;
+}
+
+/** @brief Axes that failed since the last start.
+ *  @return uint8_t, Mask.
+ */
+uint8_t HomingClass::get_failed()
+{
+	return m_failed;
+}
+
+#pragma endregion
+
+/**
+ * @brief Homing instance.
+ * 
+ */
+HomingClass Homing;
@@ -0,0 +1,260 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// Homing.h
+
+/*
+	Homing sequence of one axis:
+
+	  Fast approach   toward the switch at FastSpeed, up to MaxTravel.
+	  Stop            the edge is latched, the axis decelerates past it.
+	  Back off        Backoff steps away, the switch must be released.
+	  Slow approach   toward the switch at SlowSpeed, up to 2 * Backoff.
+	  Zero            the edge is latched, the axis stops at once and the
+	                  latched position becomes Offset.
+
+	The switch ISR calls latch(), it stores the step count at the edge, so
+	the zero does not depend on how often update() runs. Sequential homing
+	takes the axes from the lowest bit up, parallel homing runs them all.
+*/
+
+#ifndef _HOMING_h
+#define _HOMING_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <AccelStepper.h>
+
+#include "JointState32.h"
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Flags of the Home request. */
+enum HomeFlags : uint8_t
+{
+	HomeParallel = 0x01, ///< Home all axes of the mask at once.
+};
+
+/** @brief Phase of the homing sequence of one axis. */
+enum HomePhases : uint8_t
+{
+	HomeIdle = 0U, ///< Not homing.
+	HomeFast, ///< Fast approach to the switch.
+	HomeFastStop, ///< Decelerating past the switch.
+	HomeBackoff, ///< Moving off the switch.
+	HomeSlow, ///< Slow approach to the switch.
+};
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Homing parameters of one axis. */
+typedef struct
+{
+	uint8_t Pin; ///< Switch input.
+	uint8_t ActiveLevel; ///< Level of the pressed switch, LOW with a pull-up.
+	int8_t Direction; ///< 1 or -1, direction toward the switch.
+	float FastSpeed; ///< Approach speed in steps per second.
+	float SlowSpeed; ///< Re-approach speed, low enough to stop at once.
+	long Backoff; ///< Steps off the switch before the slow approach.
+	long MaxTravel; ///< Steps of the fast approach before it fails.
+	long Offset; ///< Position of the switch edge after homing.
+} HomingAxis_t;
+
+#pragma endregion
+
+class HomingClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/**
+	 * @brief Stepper of every axis, NULL if it has no switch.
+	 * 
+	 */
+	AccelStepper * m_steppers[JOINTS_COUNT];
+
+	/**
+	 * @brief Parameters of every axis.
+	 * 
+	 */
+	HomingAxis_t m_config[JOINTS_COUNT];
+
+	/**
+	 * @brief HomePhases value of every axis.
+	 * 
+	 */
+	uint8_t m_phase[JOINTS_COUNT];
+
+	/**
+	 * @brief Max speed of the axis before homing.
+	 * 
+	 */
+	float m_maxSpeed[JOINTS_COUNT];
+
+	/**
+	 * @brief Position at the last latched edge, written by the ISR.
+	 * 
+	 */
+	volatile long m_edge[JOINTS_COUNT];
+
+	/**
+	 * @brief Axes that take an edge, the ISR clears the bit.
+	 * 
+	 */
+	volatile uint8_t m_armed;
+
+	/**
+	 * @brief Axes with a latched edge, the ISR sets the bit.
+	 * 
+	 */
+	volatile uint8_t m_latched;
+
+	/**
+	 * @brief Axes waiting for their sequential turn.
+	 * 
+	 */
+	uint8_t m_pending;
+
+	/**
+	 * @brief Axes homed since the start.
+	 * 
+	 */
+	uint8_t m_homed;
+
+	/**
+	 * @brief Axes that failed, no edge within the travel or the switch stuck.
+	 * 
+	 */
+	uint8_t m_failed;
+
+#pragma endregion
+
+#pragma region Protected Methods
+
+	/** @brief Start the fast approach of the axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @return Void.
+	 */
+	void begin_axis(uint8_t axis);
+
+	/** @brief End the sequence of the axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @param homed bool, True if the zero was set.
+	 *  @return Void.
+	 */
+	void end_axis(uint8_t axis, bool homed);
+
+	/** @brief Arm the edge latch of the axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @return Void.
+	 */
+	void arm(uint8_t axis);
+
+	/** @brief Take the latched edge of the axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @param position long, Position at the edge.
+	 *  @return bool, True if an edge was latched.
+	 */
+	bool take_edge(uint8_t axis, long &position);
+
+	/** @brief The switch of the axis is pressed.
+	 *  @param axis uint8_t, Axis.
+	 *  @return bool, True if pressed.
+	 */
+	bool pressed(uint8_t axis);
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	HomingClass();
+
+	/** @brief Attach the stepper and the switch of an axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @param stepper AccelStepper *, Stepper the caller keeps running.
+	 *  @param config HomingAxis_t, Parameters.
+	 *  @return bool, True if the parameters are valid.
+	 */
+	bool attach(uint8_t axis, AccelStepper * stepper, const HomingAxis_t &config);
+
+	/** @brief Start homing, the caller keeps calling run() of the steppers.
+	 *  @param mask uint8_t, Axes to home.
+	 *  @param flags uint8_t, HomeFlags.
+	 *  @return bool, False if homing runs or an axis has no switch.
+	 */
+	bool start(uint8_t mask, uint8_t flags);
+
+	/** @brief Stop homing, the axes decelerate and stay unhomed.
+	 *  @return Void.
+	 */
+	void abort();
+
+	/** @brief Advance the sequences, call it from the loop.
+	 *  @return Void.
+	 */
+	void update();
+
+	/** @brief Latch the edge of the switch, call it from the ISR of the axis.
+	 *  @param axis uint8_t, Axis.
+	 *  @return Void.
+	 */
+	void latch(uint8_t axis);
+
+	/** @brief Axes that are homing or waiting for it.
+	 *  @return uint8_t, Mask.
+	 */
+	uint8_t get_active();
+
+	/** @brief Axes homed since the last start.
+	 *  @return uint8_t, Mask.
+	 */
+	uint8_t get_homed();
+
+	/** @brief Axes that failed since the last start.
+	 *  @return uint8_t, Mask.
+	 */
+	uint8_t get_failed();
+
+#pragma endregion
+
+};
+
+/**
+ * @brief Homing instance.
+ * 
+ */
+extern HomingClass Homing;
+
+#endif
@@ -0,0 +1,180 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "JointPositionDelta.h"
+
+/**
+ * @brief Construct a new JointPositionDelta object
+ *
+ */
+JointPositionDelta::JointPositionDelta()
+{
+	reset();
+}
+
+/** @brief Reset the reference to all zeros.
+ *  @return Void.
+ */
+void JointPositionDelta::reset()
+{
+	memset(&m_reference, 0, sizeof(JointPosition_t));
+}
+
+/** @brief Set the reference state.
+ *  @param reference JointPosition_t, Acknowledged state.
+ *  @return Void.
+ */
+void JointPositionDelta::set_reference(const JointPosition_t &reference)
+{
+	m_reference = reference;
+}
+
+/** @brief Get the reference state.
+ *  @return JointPosition_t, Acknowledged state.
+ */
+JointPosition_t JointPositionDelta::get_reference()
+{
+	return m_reference;
+}
+
+/** @brief Encode position as delta to the reference.
+ *  @param position JointPosition_t, State to encode.
+ *  @param out uint8_t *, Output buffer.
+ *  @param size uint8_t, Size of the output buffer.
+ *  @return uint8_t, Encoded length or 0 if it does not fit.
+ */
+uint8_t JointPositionDelta::encode(const JointPosition_t &position, uint8_t * out, uint8_t size)
+{
+	int16_t CurrentL[JPOS_FIELDS_COUNT];
+	int16_t ReferenceL[JPOS_FIELDS_COUNT];
+	uint16_t MaskL = 0;
+	uint8_t LengthL = JPOS_DELTA_MASK_LEN;
+
+	if (size < JPOS_DELTA_MASK_LEN)
+	{
+		return 0;
+	}
+
+	memcpy(CurrentL, &position, sizeof(JointPosition_t));
+	memcpy(ReferenceL, &m_reference, sizeof(JointPosition_t));
+
+	for (uint8_t index = 0; index < JPOS_FIELDS_COUNT; index++)
+	{
+		// Wrap the difference to 16 bits, the decoder wraps it back.
+		int16_t DeltaL = (int16_t)((uint16_t)CurrentL[index] - (uint16_t)ReferenceL[index]);
+		if (DeltaL == 0)
+		{
+			continue;
+		}
+
+		// ZigZag, small negative numbers become small positive numbers.
+		uint16_t ZigZagL = ((uint16_t)DeltaL << 1) ^ (uint16_t)(DeltaL >> 15);
+
+		// LEB128, 7 bits per byte, MSB marks continuation.
+		do
+		{
+			if (LengthL >= size)
+			{
+				return 0;
+			}
+
+			uint8_t ByteL = ZigZagL & 0x7F;
+			ZigZagL >>= 7;
+			if (ZigZagL != 0)
+			{
+				ByteL |= 0x80;
+			}
+			out[LengthL++] = ByteL;
+		} while (ZigZagL != 0);
+
+		MaskL |= (1U << index);
+	}
+
+	out[0] = (uint8_t)(MaskL & 0xFF);
+	out[1] = (uint8_t)(MaskL >> 8);
+
+	return LengthL;
+}
+
+/** @brief Decode delta against the reference.
+ *  @param in uint8_t *, Encoded buffer.
+ *  @param length uint8_t, Length of the encoded buffer.
+ *  @param position JointPosition_t, Decoded state.
+ *  @return uint8_t, Consumed length or 0 if the frame is malformed.
+ */
+uint8_t JointPositionDelta::decode(const uint8_t * in, uint8_t length, JointPosition_t &position)
+{
+	int16_t FieldsL[JPOS_FIELDS_COUNT];
+	uint16_t MaskL = 0;
+	uint8_t IndexL = JPOS_DELTA_MASK_LEN;
+
+	if (length < JPOS_DELTA_MASK_LEN)
+	{
+		return 0;
+	}
+
+	MaskL = (uint16_t)in[0] | ((uint16_t)in[1] << 8);
+
+	// Bits above the last field are reserved.
+	if ((MaskL >> JPOS_FIELDS_COUNT) != 0)
+	{
+		return 0;
+	}
+
+	memcpy(FieldsL, &m_reference, sizeof(JointPosition_t));
+
+	for (uint8_t index = 0; index < JPOS_FIELDS_COUNT; index++)
+	{
+		if ((MaskL & (1U << index)) == 0)
+		{
+			continue;
+		}
+
+		uint16_t ZigZagL = 0;
+		uint8_t ShiftL = 0;
+		uint8_t ByteL = 0;
+		do
+		{
+			if ((IndexL >= length) || (ShiftL >= (7 * JPOS_DELTA_FIELD_MAX_LEN)))
+			{
+				return 0;
+			}
+
+			ByteL = in[IndexL++];
+
+			// The last group holds bits 14 and 15 only, more would wrap the target.
+			if ((ShiftL == 14) && ((ByteL & 0x7C) != 0))
+			{
+				return 0;
+			}
+
+			ZigZagL |= (uint16_t)(ByteL & 0x7F) << ShiftL;
+			ShiftL += 7;
+		} while ((ByteL & 0x80) != 0);
+
+		int16_t DeltaL = (int16_t)((ZigZagL >> 1) ^ (uint16_t)(-(int16_t)(ZigZagL & 1)));
+		FieldsL[index] = (int16_t)((uint16_t)FieldsL[index] + (uint16_t)DeltaL);
+	}
+
+	memcpy(&position, FieldsL, sizeof(JointPosition_t));
+
+	return IndexL;
+}
@@ -0,0 +1,138 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// JointPositionDelta.h
+
+/*
+	Delta frame layout:
+
+	+--------+--------+------------------------------------------+
+	| Byte 0 | Byte 1 | Byte 2 ...                               |
+	+--------+--------+------------------------------------------+
+	| Mask L | Mask H | ZigZag varint for every set bit of mask. |
+	+--------+--------+------------------------------------------+
+
+	Bit N of the mask stands for the N-th int16_t field of JointPosition_t
+	(BasePos = 0, BaseSpeed = 1 ... GripperSpeed = 11). The varint holds
+	the difference to the reference, wrapped to 16 bits, so every field
+	takes 1 to 3 bytes and unchanged fields take nothing.
+*/
+
+#ifndef _JOINTPOSITIONDELTA_h
+#define _JOINTPOSITIONDELTA_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "JointPosition.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Count of the int16_t fields in JointPosition_t. */
+#define JPOS_FIELDS_COUNT 12
+
+/** @brief Length of the presence mask. */
+#define JPOS_DELTA_MASK_LEN 2
+
+/** @brief Maximum length of one zigzag varint field. */
+#define JPOS_DELTA_FIELD_MAX_LEN 3
+
+/** @brief Maximum length of the delta frame. */
+#define JPOS_DELTA_MAX_LEN (JPOS_DELTA_MASK_LEN + JPOS_FIELDS_COUNT * JPOS_DELTA_FIELD_MAX_LEN)
+
+#pragma endregion
+
+#pragma region Enums
+
+/** @brief Format byte in front of the delta encoded payloads. */
+enum JointPositionFormats : uint8_t
+{
+	JposDelta = 0U, ///< Presence mask and zigzag varint deltas.
+	JposFull, ///< Full packed JointPosition_t.
+};
+
+#pragma endregion
+
+class JointPositionDelta
+{
+
+	protected:
+
+#pragma region Variables
+
+	/**
+	 * @brief Last acknowledged state, both sides encode against it.
+	 *
+	 */
+	JointPosition_t m_reference;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	JointPositionDelta();
+
+	/** @brief Reset the reference to all zeros.
+	 *  @return Void.
+	 */
+	void reset();
+
+	/** @brief Set the reference state.
+	 *  @param reference JointPosition_t, Acknowledged state.
+	 *  @return Void.
+	 */
+	void set_reference(const JointPosition_t &reference);
+
+	/** @brief Get the reference state.
+	 *  @return JointPosition_t, Acknowledged state.
+	 */
+	JointPosition_t get_reference();
+
+	/** @brief Encode position as delta to the reference.
+	 *  @param position JointPosition_t, State to encode.
+	 *  @param out uint8_t *, Output buffer.
+	 *  @param size uint8_t, Size of the output buffer.
+	 *  @return uint8_t, Encoded length or 0 if it does not fit.
+	 */
+	uint8_t encode(const JointPosition_t &position, uint8_t * out, uint8_t size);
+
+	/** @brief Decode delta against the reference.
+	 *  @param in uint8_t *, Encoded buffer.
+	 *  @param length uint8_t, Length of the encoded buffer.
+	 *  @param position JointPosition_t, Decoded state.
+	 *  @return uint8_t, Consumed length or 0 if the frame is malformed.
+	 */
+	uint8_t decode(const uint8_t * in, uint8_t length, JointPosition_t &position);
+
+#pragma endregion
+
+};
+
+#endif
@@ -24,15 +24,5 @@
 
 void ConvertJpos2Buff(JointPosition_t &jPos, uint8_t* buff)
 {
-	// TODO: Move to function.
-	JointPositionUnion Motion;
-	size_t DataLengthL = sizeof(JointPosition_t);
-	for (uint8_t index = 0; index < DataLengthL; index++)
-	{
-		Motion.Buffer[index] = buff[index];
-	}
-
-	jPos = Motion.Value;
-
-	//delete &Motion;
-}
\ No newline at end of file
+	memcpy(&jPos, buff, sizeof(JointPosition_t));
+}
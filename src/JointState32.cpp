@@ -0,0 +1,99 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "JointState32.h"
+
+/** @brief Count of int16_t fields in the legacy position. */
+#define JPOS_FIELDS (JOINTS_COUNT * 2)
+
+/** @brief Load the 32 bit state from the byte buffer.
+ *  @param jState JointState32_t, Output state.
+ *  @param buff uint8_t *, Little endian byte buffer.
+ *  @return Void.
+ */
+void ConvertJstate2Buff(JointState32_t &jState, uint8_t* buff)
+{
+	memcpy(&jState, buff, sizeof(JointState32_t));
+}
+
+/** @brief Widen the legacy position to the 32 bit state.
+ *  @param jPos JointPosition_t, Legacy position.
+ *  @param jState JointState32_t, Output state.
+ *  @return Void.
+ */
+void ConvertJpos2Jstate(const JointPosition_t &jPos, JointState32_t &jState)
+{
+	// Position and speed alternate in both layouts.
+	int16_t FieldsL[JPOS_FIELDS];
+	int32_t WideL[JPOS_FIELDS];
+
+	memcpy(FieldsL, &jPos, sizeof(JointPosition_t));
+
+	for (uint8_t index = 0; index < JPOS_FIELDS; index += 2)
+	{
+		WideL[index] = FieldsL[index];
+		WideL[index + 1] = (int32_t)FieldsL[index + 1] * JOINT_SPEED_ONE;
+	}
+
+	memcpy(&jState, WideL, sizeof(JointState32_t));
+}
+
+/** @brief Narrow the 32 bit state to the legacy position.
+ *  @param jState JointState32_t, Input state.
+ *  @param jPos JointPosition_t, Output legacy position.
+ *  @return bool, False if any field was saturated to the int16_t range.
+ */
+bool ConvertJstate2Jpos(const JointState32_t &jState, JointPosition_t &jPos)
+{
+	int32_t WideL[JPOS_FIELDS];
+	int16_t FieldsL[JPOS_FIELDS];
+	bool FitsL = true;
+
+	memcpy(WideL, &jState, sizeof(JointState32_t));
+
+	for (uint8_t index = 0; index < JPOS_FIELDS; index++)
+	{
+		int32_t ValueL = WideL[index];
+
+		// Speeds are truncated toward zero like the float casts were.
+		if (index & 1)
+		{
+			ValueL /= JOINT_SPEED_ONE;
+		}
+
+		if (ValueL > INT16_MAX)
+		{
+			ValueL = INT16_MAX;
+			FitsL = false;
+		}
+		else if (ValueL < INT16_MIN)
+		{
+			ValueL = INT16_MIN;
+			FitsL = false;
+		}
+
+		FieldsL[index] = (int16_t)ValueL;
+	}
+
+	memcpy(&jPos, FieldsL, sizeof(JointPosition_t));
+
+	return FitsL;
+}
@@ -0,0 +1,104 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// JointState32.h
+
+#ifndef _JOINTSTATE32_h
+#define _JOINTSTATE32_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "JointPosition.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Count of the joints in the state. */
+#define JOINTS_COUNT 6
+
+/** @brief Fraction bits of the fixed point speed. */
+#define JOINT_SPEED_FRAC_BITS 8
+
+/** @brief Fixed point speed of 1 step per second. */
+#define JOINT_SPEED_ONE (1L << JOINT_SPEED_FRAC_BITS)
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Motion description of one joint. */
+typedef struct __attribute__((packed))
+{
+	int32_t Position; ///< Joint position in steps.
+	int32_t Speed; ///< Joint speed in steps per second, Q23.8 fixed point.
+} JointAxisState32_t;
+
+/** @brief Motion description of the joint state, same order as JointPosition_t. */
+typedef struct __attribute__((packed))
+{
+	JointAxisState32_t Axis[JOINTS_COUNT]; ///< Base, Shoulder, Elbow, Left Diff, Right Diff, Gripper.
+} JointState32_t;
+
+#pragma endregion
+
+#pragma region Unions
+
+/** @brief Union for converting bytes to 32 bit motion description. */
+union JointState32Union {
+	uint8_t Buffer[sizeof(JointState32_t)]; ///< Byte buffer.
+	JointState32_t Value; ///< Interpreted value.
+};
+
+#pragma endregion
+
+#pragma region Function Prototypes
+
+/** @brief Load the 32 bit state from the byte buffer.
+ *  @param jState JointState32_t, Output state.
+ *  @param buff uint8_t *, Little endian byte buffer.
+ *  @return Void.
+ */
+void ConvertJstate2Buff(JointState32_t &jState, uint8_t* buff);
+
+/** @brief Widen the legacy position to the 32 bit state.
+ *  @param jPos JointPosition_t, Legacy position.
+ *  @param jState JointState32_t, Output state.
+ *  @return Void.
+ */
+void ConvertJpos2Jstate(const JointPosition_t &jPos, JointState32_t &jState);
+
+/** @brief Narrow the 32 bit state to the legacy position.
+ *  @param jState JointState32_t, Input state.
+ *  @param jPos JointPosition_t, Output legacy position.
+ *  @return bool, False if any field was saturated to the int16_t range.
+ */
+bool ConvertJstate2Jpos(const JointState32_t &jState, JointPosition_t &jPos);
+
+#pragma endregion
+
+#endif
@@ -49,7 +49,73 @@ enum OpCodes : uint8_t
 	GetRobotID, ///< Get robot ID.
 	SaveRobotPosition, ///< Save current robot position.
 	LoadRobotPosition, ///< Load current robot position.
+	CurrentPositionDelta, ///< Current robot position, delta encoded.
+	MoveAbsoluteDelta, ///< Move to absolute position, delta encoded.
+	MoveRelative32, ///< Move to relative position, 32 bit joint state.
+	MoveAbsolute32, ///< Move to absolute position, 32 bit joint state.
+	CurrentPosition32, ///< Current robot position, 32 bit joint state.
+	BusTraceControl, ///< Start, stop, clear or dump the bus trace.
+	BusTraceRead, ///< Read a chunk of the bus trace.
+	Stats, ///< Read and reset the control loop and protocol counters.
+	FrameTraceControl, ///< Start, stop, clear or dump the parser state trace.
+	FrameTraceRead, ///< Read a chunk of the parser state trace.
+	UpdateRate, ///< Read, set, calibrate or save the bus slot period.
+	Override, ///< Read or set the global and axis speed overrides.
+	JogTimeout, ///< Read or set the speed mode watchdog.
+	Hold, ///< Read or set the idle timeouts that switch the coils off.
+	DriveMode, ///< Read or set the full, half or wave coil sequence of the axes.
+	Limits, ///< Read, set or save the kinematic limits of one axis.
+	Home, ///< Start homing on the limit switches or read its progress.
+	PortAFilter, ///< Read or set the digital filter of the Port A inputs.
+	PortAEvents, ///< Drain the filtered, timestamped Port A edges.
+	MoveUntilInput, ///< Move absolutely until the masked Port A inputs match, then stop.
+	ProbeResult, ///< Status and step counts of the last MoveUntilInput.
+	Triggers, ///< Add or clear the Port A output triggers of the next move, read their state.
 };
 
+/** @brief Flags of the Stats request. */
+enum StatsFlags : uint8_t
+{
+	StatsReset = 0x01, ///< Reset the counters after the read.
+};
+
+/** @brief Pages of the Stats response. */
+enum StatsPages : uint8_t
+{
+	StatsGeneral = 0U, ///< Robko01Stats_t followed by SUPERStats_t.
+	StatsOpcodes, ///< First opcode, then SUPEROpcodeStats_t for the next STATS_OPCODES_PER_PAGE.
+	StatsStop, ///< StopStats_t of the stop inputs.
+};
+
+/** @brief Flags of the UpdateRate request. */
+enum UpdateRateFlags : uint8_t
+{
+	UpdateRateSet = 0x01, ///< Set the period that follows the flags, uint32_t in us.
+	UpdateRateCalibrate = 0x02, ///< Measure the slot cost and derive the period.
+	UpdateRateSave = 0x04, ///< Save the current period to the settings.
+};
+
+/** @brief Flags of the Limits request. */
+enum LimitsFlags : uint8_t
+{
+	LimitsSet = 0x01, ///< Set the AxisLimits_t that follows the axis.
+	LimitsSave = 0x02, ///< Save the limits of all axes to the settings.
+	LimitsReject = 0x04, ///< Refuse moves outside the soft limits, the default.
+	LimitsClamp = 0x08, ///< Clamp moves outside the soft limits.
+};
+
+/** @brief Flags of the Triggers request. */
+enum TriggersFlags : uint8_t
+{
+	TriggersClear = 0x01, ///< Drop the pending triggers and the ones of the move in flight.
+	TriggersAdd = 0x02, ///< Add the PortATrigger_t that follows the flags to the next move.
+};
+
+/** @brief PortAEvent_t entries in one PortAEvents response, after the lost count. */
+#define PORT_A_EVENTS_PER_READ 8
+
+/** @brief Handler time entries in one StatsOpcodes page. */
+#define STATS_OPCODES_PER_PAGE 8
+
 #endif
 
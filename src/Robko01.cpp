@@ -1,6 +1,44 @@
 
 #include "Robko01.h"
 
+#pragma region Variables
+
+/** @brief Coils of every electrical position on the half step circle, even ones are a single coil. */
+static const uint8_t PhaseCoils_g[8] = {
+	0b0001, 0b0101, 0b0100, 0b0110, 0b0010, 0b1010, 0b1000, 0b1001
+};
+
+#pragma endregion
+
+#pragma region Functions
+
+/** @brief Convert steps between drive modes, rounds down.
+ *  @param steps long, Steps.
+ *  @param from uint8_t, Half steps per step of the old mode.
+ *  @param to uint8_t, Half steps per step of the new mode.
+ *  @return long, Steps in the new mode.
+ */
+static long rescale_steps(long steps, uint8_t from, uint8_t to)
+{
+	long HalfStepsL = steps * from;
+	long StepsL = HalfStepsL / to;
+	if ((HalfStepsL < 0) && ((HalfStepsL % to) != 0))
+	{
+		StepsL--;
+	}
+
+	return StepsL;
+}
+
+/** @brief Step callback of the steppers, the slot writes the coils from the position.
+ *  @return Void.
+ */
+static void step_none()
+{
+}
+
+#pragma endregion
+
 /** 
  * @brief Generate IO Write signal.
  * 
@@ -25,6 +63,18 @@ void Robko01Class::iow() {
 	delayMicroseconds(IOW_PULSE_TIME);
 #endif
 	digitalWrite(m_BusConfig.IOW, HIGH);
+
+#ifdef ENABLE_BUS_TRACE
+	if (m_busTrace.enabled())
+	{
+		// The registers latch on the rising edge, read back what they got.
+		uint8_t DiL = digitalRead(m_BusConfig.DI0) |
+			(digitalRead(m_BusConfig.DI1) << 1) |
+			(digitalRead(m_BusConfig.DI2) << 2) |
+			(digitalRead(m_BusConfig.DI3) << 3);
+		m_busTrace.record(micros(), BusStrobes::StrobeIOW, m_busAddress, DiL, 0);
+	}
+#endif
 }
 
 /** 
@@ -51,6 +101,10 @@ void Robko01Class::ior() {
 	delayMicroseconds(IOR_PULSE_TIME);
 #endif
 	digitalWrite(m_BusConfig.IOR, HIGH);
+
+#ifdef ENABLE_BUS_TRACE
+	m_busTrace.record(micros(), BusStrobes::StrobeIOR, m_busAddress, 0, m_busDo);
+#endif
 }
 
 /** 
@@ -76,6 +130,10 @@ void Robko01Class::set_address_bus(uint8_t address) {
 	digitalWrite(m_BusConfig.AO0, a0State);
 	digitalWrite(m_BusConfig.AO1, a1State);
 	digitalWrite(m_BusConfig.AO2, a2State);
+
+#ifdef ENABLE_BUS_TRACE
+	m_busAddress = address;
+#endif
 }
 
 /** 
@@ -106,6 +164,10 @@ uint8_t Robko01Class::read_do() {
 	bitWrite(StateL, 2, (analogRead(m_BusConfig.DO2) > ADC_DI_TRESHOLD));
 	bitWrite(StateL, 3, (analogRead(m_BusConfig.DO3) > ADC_DI_TRESHOLD));
 
+#ifdef ENABLE_BUS_TRACE
+	m_busDo = StateL;
+#endif
+
 	return StateL;
 }
 
@@ -185,8 +247,16 @@ void Robko01Class::setup_bus() {
 
     m_currentAddressIndex = 0;
 	m_portLoAIn = 0;
+#ifdef ENABLE_BUS_TRACE
+	m_busAddress = 0;
+	m_busDo = 0;
+#endif
 	m_portHiAIn = 0;
 	m_portAOut = 0;
+	m_portAStable = 0;
+	m_portASeeded = 0;
+	memset(m_portACount, 0, sizeof(m_portACount));
+	memset(m_portAEdgeAt, 0, sizeof(m_portAEdgeAt));
 
 	// Control bus.
 	pinMode(m_BusConfig.IOW, OUTPUT);
@@ -227,16 +297,29 @@ void Robko01Class::setup_motors() {
 
 	m_motorsEnabled = false;
 	m_motorState = 0;
+	m_quickStop = 0;
+	m_released = 0;
+	m_energised = 0;
+	m_energisedUs = 0;
 
 	for (uint8_t address = 0; address < AXIS_COUNT; address++)
 	{
-		m_steppers[address] = AccelStepper(AccelStepper::FULL4WIRE, m_BusConfig.DI0, m_BusConfig.DI1, m_BusConfig.DI2, m_BusConfig.DI3); // HALF4WIRE, FULL4WIRE
+		// All axes share DI0..DI3, the slot latches coil_mask() of the axis.
+		m_steppers[address] = AccelStepper(step_none, step_none);
 		m_steppers[address].setMaxSpeed(DEFAULT_SPEED);
-		m_steppers[address].setAcceleration(DEFAULT_ACCELERATION);
+		m_steppers[address].setAcceleration(max_acceleration(address));
+		m_overrideSpeed[address] = DEFAULT_SPEED;
+		plan_max_speed(address, DEFAULT_SPEED);
+		m_jogTarget[address] = 0.0f;
+		m_jogSpeed[address] = 0.0f;
+		plan_jog_brake(address);
+		m_idleSince[address] = micros();
+		m_holdServed[address] = m_idleSince[address];
 		m_steppers[address].setCurrentPosition(0);
 		m_steppers[address].stop();
-		m_steppers[address].enableOutputs();
+		m_phaseOffset[address] = 0;
 		set_address_bus(address);
+		write_di(coil_mask(address));
 		iow();
 	}
 }
@@ -262,7 +345,13 @@ uint8_t Robko01Class::update_motor(uint8_t address) {
 	}
 	else if(m_operationMode == OperationModes::Speed)
 	{
-		state = m_steppers[address].runSpeed();
+		state = update_jog(address);
+	}
+
+	// At rest, a quick stop is over.
+	if (!state)
+	{
+		end_quick_stop(address);
 	}
 
 	bitWrite(m_motorState, address, state);
@@ -287,12 +376,26 @@ void Robko01Class::update_port_a(uint8_t address) {
 	{
 		// Remember data.
 		m_portLoAIn = read_do();
+		filter_port_a(m_portLoAIn, 0);
 	}
 	else if (address == AddressIndex::PortA2)
 	{
 		// Read data bus.
 		m_portHiAIn = read_do();
+		filter_port_a(m_portHiAIn, 4);
+	}
+
+#ifdef ENABLE_PROBE
+	update_probe();
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	// The axis slots of this cycle are served, the outputs go out in it.
+	if (address == AddressIndex::PortA1)
+	{
+		update_triggers();
 	}
+#endif
 
 	// Write operation.
 	if (address == AddressIndex::PortA1)
@@ -307,311 +410,2406 @@ void Robko01Class::update_port_a(uint8_t address) {
 	}
 }
 
-/**
- * @brief Init the robot.
- * 
- * @param config Robot GPIO configuration.
+/** @brief Filter a Port A nibble and queue its edges.
+ *  @param nibble uint8_t, Sampled inputs.
+ *  @param first uint8_t, Bit of the lowest input of the nibble.
+ *  @return Void.
  */
-void Robko01Class::init(BusConfig_t* config) {
-#ifdef SHOW_FUNC_NAMES
+void Robko01Class::filter_port_a(uint8_t nibble, uint8_t first) {
+#ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-    m_BusConfig = *config;
-	
-#if defined(SLOW)
-	m_updateRate = 1000000UL;
-#else
-	m_updateRate = 1000UL;
-#endif
+	uint8_t NibbleL = first / 4;
 
-	m_operationMode = OperationModes::NONE;
+	// The first sample is the state, not an edge.
+	if (bitRead(m_portASeeded, NibbleL) == 0)
+	{
+		bitSet(m_portASeeded, NibbleL);
+		m_portAStable = (m_portAStable & ~(0x0F << first)) | ((nibble & 0x0F) << first);
+		return;
+	}
 
-	// Setup gpio bus signals.
-	setup_bus();
+	for (uint8_t index = first; index < (first + 4); index++)
+	{
+		uint8_t LevelL = bitRead(nibble, index - first);
+		if (LevelL == bitRead(m_portAStable, index))
+		{
+			m_portACount[index] = 0;
+			continue;
+		}
 
-	// Setup motor regulators.
-    setup_motors();
+		if (m_portACount[index] == 0)
+		{
+			m_portAEdgeAt[index] = micros();
+		}
+		if (m_portACount[index] < 0xFF)
+		{
+			m_portACount[index]++;
+		}
+		if (m_portACount[index] < __atomic_load_n(&m_portAFilter[index], __ATOMIC_RELAXED))
+		{
+			continue;
+		}
+
+		m_portACount[index] = 0;
+		bitWrite(m_portAStable, index, LevelL);
+
+		PortAEvent_t EventL;
+		EventL.Bit = index;
+		EventL.Level = LevelL;
+		EventL.Time = m_portAEdgeAt[index];
+		if ((m_portAEvents.push(EventL) == false) && (m_portAEventsLost < UINT8_MAX))
+		{
+			__atomic_store_n(&m_portAEventsLost, (uint8_t)(m_portAEventsLost + 1), __ATOMIC_RELAXED);
+		}
+	}
 }
 
-/**
- * @brief Update the robot.
- * 
+#ifdef ENABLE_PROBE
+/** @brief Check the armed probe against Port A, stop the axes in this slot when it matches.
+ *  @return Void.
  */
-void Robko01Class::update() {
+void Robko01Class::update_probe() {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	// Update time.
-	m_timeNow = micros(); // millis();
+	if (m_probe.value().Status != ProbeStatus::ProbeArmed)
+	{
+		return;
+	}
 
-	// if (true) 
-	if ((m_timeNow - m_timePrev) >= m_updateRate)
+	uint8_t PortAL = (m_portLoAIn | (m_portHiAIn << 4));
+	if ((PortAL & m_probeMask) == (m_probeLevel & m_probeMask))
 	{
-		// Update motors.		
-		if (m_currentAddressIndex < AXIS_COUNT)
-		{
-			// Update motor state.
-			m_steppers[m_currentAddressIndex].disableOutputs();
-			m_steppers[m_currentAddressIndex].enableOutputs();
-			set_address_bus(m_currentAddressIndex);
-			m_motorState = update_motor(m_currentAddressIndex);
-			iow();
-		}
-		else
+		Robko01Probe_t ProbeL;
+		ProbeL.Status = ProbeStatus::ProbeTriggered;
+		ProbeL.PortA = PortAL;
+		ProbeL.Time = micros();
+
+		// No axis steps after this slot, the counts are the trigger position.
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
 		{
-			// Update port A.
-			set_address_bus(m_currentAddressIndex);
-			update_port_a(m_currentAddressIndex);
-			iow();
-			ior();
+			hard_stop(address);
+			ProbeL.Position[address] = m_steppers[address].currentPosition();
 		}
-
-		// Increment the address bus index.
-		m_currentAddressIndex++;
-
-		// Clear the address index.
-		if (m_currentAddressIndex >= ADDRESS_COUNT)
+		m_probe.write(ProbeL);
+	}
+	else
+	{
+		// Every axis at its target, the whole move ran.
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
 		{
-			m_currentAddressIndex = 0;
+			if (m_steppers[address].distanceToGo() != 0)
+			{
+				return;
+			}
 		}
-
-		m_timePrev = m_timeNow;
+		end_probe(ProbeStatus::ProbeMissed);
 	}
 }
 
-/**
- * @brief Motors enables flags.
- * 
- * @return true 
- * @return false 
+/** @brief End the probe move if it is armed.
+ *  @param status uint8_t, ProbeStatus value.
+ *  @return Void.
  */
-bool Robko01Class::motors_enabled() {
+void Robko01Class::end_probe(uint8_t status) {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	return m_motorsEnabled;
+	if (m_probe.value().Status != ProbeStatus::ProbeArmed)
+	{
+		return;
+	}
+
+	m_probe.write(offsetof(Robko01Probe_t, Status), &status, sizeof(status));
 }
+#endif
 
-/**
- * @brief Get motors state.
- * 
- * @return uint8_t 
+#ifdef ENABLE_PORT_A_TRIGGERS
+/** @brief Fire the triggers whose axis passed its step, once per bus cycle after the axis slots.
+ *  @return Void.
  */
-uint8_t Robko01Class::get_motor_state() {
+void Robko01Class::update_triggers() {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-    return m_motorState;
+	uint8_t ArmedL = m_triggersArmed;
+	if (ArmedL == 0)
+	{
+		return;
+	}
+
+	uint8_t FiredL = 0;
+	for (uint8_t index = 0; index < PORT_A_TRIGGERS; index++)
+	{
+		if (bitRead(ArmedL, index) == 0)
+		{
+			continue;
+		}
+
+		long PositionL = m_steppers[m_triggersMove[index].Axis].currentPosition();
+		bool PassedL = bitRead(m_triggerAbove, index) ? (PositionL >= m_triggerStep[index]) : (PositionL <= m_triggerStep[index]);
+		if (PassedL)
+		{
+			// Entries in order, a later one wins on the same bits.
+			m_portAOut = (m_portAOut & ~m_triggersMove[index].Mask) | (m_triggersMove[index].Level & m_triggersMove[index].Mask);
+			bitSet(FiredL, index);
+		}
+	}
+
+	if (FiredL != 0)
+	{
+		__atomic_store_n(&m_triggersArmed, (uint8_t)(ArmedL & ~FiredL), __ATOMIC_RELAXED);
+		__atomic_store_n(&m_triggersFired, (uint8_t)(m_triggersFired | FiredL), __ATOMIC_RELAXED);
+	}
 }
 
-/**
- * @brief Stop all motors.
- * 
+/** @brief Move the pending triggers to the move that starts, with the fractions as steps.
+ *  @return Void.
  */
-void Robko01Class::stop_motors() {
-#ifdef SHOW_FUNC_NAMES
+void Robko01Class::arm_triggers() {
+#ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	uint8_t ArmedL = 0;
+	m_triggerAbove = 0;
+	for (uint8_t index = 0; index < m_triggersPending; index++)
 	{
-		m_steppers[address].stop();
-		//m_steppers[address].setSpeed(0);
+		const PortATrigger_t &TriggerL = m_triggers[index];
+		long StartL = m_steppers[TriggerL.Axis].currentPosition();
+		int32_t StepL = TriggerL.Value;
+		if (TriggerL.Kind == TriggerKinds::TriggerFraction)
+		{
+			// Resolved once here, the slot compares steps only.
+			int64_t TravelL = (int64_t)(m_steppers[TriggerL.Axis].targetPosition() - StartL);
+			StepL = StartL + (int32_t)((TravelL * TriggerL.Value) / TRIGGER_FRACTION_ONE);
+		}
+
+		// The side of the start decides the direction, a step at the start fires at once.
+		if (StepL >= StartL)
+		{
+			bitSet(m_triggerAbove, index);
+		}
+		m_triggersMove[index] = TriggerL;
+		m_triggerStep[index] = StepL;
+		bitSet(ArmedL, index);
 	}
+
+	__atomic_store_n(&m_triggersPending, (uint8_t)0, __ATOMIC_RELAXED);
+	__atomic_store_n(&m_triggersFired, (uint8_t)0, __ATOMIC_RELAXED);
+	__atomic_store_n(&m_triggersArmed, ArmedL, __ATOMIC_RELAXED);
 }
+#endif
 
 /**
- * @brief Disable all motors.
+ * @brief Construct a new Robko01Class object
  * 
  */
-void Robko01Class::disable_motors()
+Robko01Class::Robko01Class()
 {
+	m_commandsPosted = 0;
+	m_commandsExecuted = 0;
+	m_overrideGlobal = 100;
+	m_jogTimeout = JOG_TIMEOUT;
+	m_jogSetpointTime = 0;
 	for (uint8_t address = 0; address < AXIS_COUNT; address++)
 	{
-		m_steppers[address].disableOutputs();
-		// set_address_bus(address);
+		m_overrideAxis[address] = 100;
+		m_idleTimeout[address] = IDLE_TIMEOUT;
+		m_driveMode[address] = DriveModes::DriveFull;
+		m_phaseOffset[address] = 0;
 	}
-
-	m_motorsEnabled = false;
+	m_limitMode = LimitModes::LimitReject;
+	for (uint8_t bit = 0; bit < PORT_A_BITS; bit++)
+	{
+		m_portAFilter[bit] = PORT_A_FILTER;
+	}
+	m_portAEventsLost = 0;
+	m_commandArgsBusy = 0;
+#ifdef ENABLE_PORT_A_TRIGGERS
+	m_triggerAbove = 0;
+	m_triggersPending = 0;
+	m_triggersArmed = 0;
+	m_triggersFired = 0;
+#endif
+#ifdef ENABLE_PROBE
+	m_probeMask = 0;
+	m_probeLevel = 0;
+#endif
+	cbSlot = nullptr;
+#if defined(ESP32)
+	m_task = NULL;
+	m_timer = NULL;
+#endif
 }
 
 /**
- * @brief Enable all motors.
+ * @brief Init the robot.
  * 
+ * @param config Robot GPIO configuration.
  */
-void Robko01Class::enable_motors() {
+void Robko01Class::init(BusConfig_t* config) {
 #ifdef SHOW_FUNC_NAMES
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	for (uint8_t address = 0; address < AXIS_COUNT; address++)
-	{
-		m_steppers[address].enableOutputs();
-		// set_address_bus(address);
-	}
+    m_BusConfig = *config;
+	
+#if defined(SLOW)
+	m_updateRate = 1000000UL;
+#else
+	m_updateRate = 1000UL;
+#endif
+	m_slotCost = 0;
 
-	m_motorsEnabled = true;
+	m_operationMode = OperationModes::NONE;
+
+	// First slot is one update rate from now.
+	m_timePrev = micros();
+	m_timeNow = m_timePrev;
+	reset_stats();
+
+	// Setup gpio bus signals.
+	setup_bus();
+
+	// Setup motor regulators.
+    setup_motors();
+
+	publish_snapshot();
 }
 
 /**
- * @brief Clear all motors position to 0.
+ * @brief Update the robot.
  * 
  */
-void Robko01Class::clear_motors() {
-#ifdef SHOW_FUNC_NAMES
+void Robko01Class::update() {
+#ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+#if defined(ESP32)
+	// The motion task owns the bus.
+	if (m_task != NULL)
 	{
-		m_steppers[address].setCurrentPosition(0);
+		return;
 	}
-}
+#endif
 
-/** 
- * @brief Move relatively to position.
- * 
- * @param position JointPosition_t, robot position.
- */
-void Robko01Class::move_relative(JointPosition_t position) {
-#ifdef SHOW_FUNC_NAMES_S
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
-#endif // SHOW_FUNC_NAMES
+	// Update time.
+	m_timeNow = micros(); // millis();
 
-	m_operationMode = OperationModes::Positioning;
+	m_statsUpdates++;
 
-	m_steppers[AddressIndex::Base].setSpeed(position.BaseSpeed);
-	m_steppers[AddressIndex::Base].move(position.BasePos);
-	// m_steppers[AddressIndex::Base].setMaxSpeed(position.BaseSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Shoulder].setSpeed(position.ShoulderSpeed);
-	m_steppers[AddressIndex::Shoulder].move(position.ShoulderPos);
-	// m_steppers[AddressIndex::Shoulder].setMaxSpeed(position.ShoulderSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Elbow].setSpeed(position.ElbowSpeed);
-	m_steppers[AddressIndex::Elbow].move(position.ElbowPos);
-	// m_steppers[AddressIndex::Elbow].setMaxSpeed(position.ElbowSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::DiffLeft].setSpeed(position.LeftDiffSpeed);
-	m_steppers[AddressIndex::DiffLeft].move(position.LeftDiffPos);
-	// m_steppers[AddressIndex::DiffLeft].setMaxSpeed(position.LeftDiffSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::DiffRight].setSpeed(position.RightDiffSpeed);
-	m_steppers[AddressIndex::DiffRight].move(position.RightDiffPos);
-	// m_steppers[AddressIndex::DiffRight].setMaxSpeed(position.RightDiffSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Gripper].setSpeed(position.GripperSpeed);
-	m_steppers[AddressIndex::Gripper].move(position.GripperPos);
-	// m_steppers[AddressIndex::Gripper].setMaxSpeed(position.GripperSpeed + MAX_SPEED_OFFSET);
+	// if (true) 
+	if ((m_timeNow - m_timePrev) >= m_updateRate)
+	{
+		update_slot();
+	}
 }
 
-/** 
- * @brief Move absolutely to position.
+/**
+ * @brief Serve the current address slot, m_timeNow is the slot start.
  * 
- * @param position JointPosition_t, robot position.
  */
-void Robko01Class::move_absolute(JointPosition_t position) {
+void Robko01Class::update_slot() {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	m_operationMode = OperationModes::Positioning;
+	// Commands take effect at the slot boundary, before the bus is served.
+	MotionCommand_t CommandL;
+	while (m_commands.pop(CommandL))
+	{
+		execute_command(CommandL);
+		__atomic_store_n(&m_commandsExecuted, (uint8_t)(m_commandsExecuted + 1), __ATOMIC_RELEASE);
+	}
 
-	m_steppers[AddressIndex::Base].setSpeed(position.BaseSpeed);
-	m_steppers[AddressIndex::Base].setMaxSpeed(position.BaseSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Base].moveTo(position.BasePos);
-	m_steppers[AddressIndex::Shoulder].setSpeed(position.ShoulderSpeed);
-	m_steppers[AddressIndex::Shoulder].setMaxSpeed(position.ShoulderSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Shoulder].moveTo(position.ShoulderPos);
-	m_steppers[AddressIndex::Elbow].setSpeed(position.ElbowSpeed);
-	m_steppers[AddressIndex::Elbow].setMaxSpeed(position.ElbowSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Elbow].moveTo(position.ElbowPos);
-	m_steppers[AddressIndex::DiffLeft].setSpeed(position.LeftDiffSpeed);
-	m_steppers[AddressIndex::DiffLeft].setMaxSpeed(position.LeftDiffSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::DiffLeft].moveTo(position.LeftDiffPos);
-	m_steppers[AddressIndex::DiffRight].setSpeed(position.RightDiffSpeed);
-	m_steppers[AddressIndex::DiffRight].setMaxSpeed(position.RightDiffSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::DiffRight].moveTo(position.RightDiffPos);
-	m_steppers[AddressIndex::Gripper].setSpeed(position.GripperSpeed);
-	m_steppers[AddressIndex::Gripper].setMaxSpeed(position.GripperSpeed + MAX_SPEED_OFFSET);
-	m_steppers[AddressIndex::Gripper].moveTo(position.GripperPos);
-}
+	// Dead man, the client is gone, the jog ramps down. Signed, a setpoint
+	// posted in this slot is younger than the slot start.
+	if ((m_operationMode == OperationModes::Speed) && (m_jogTimeout != 0) &&
+		((long)(m_timeNow - m_jogSetpointTime) > ((long)m_jogTimeout * 1000L)))
+	{
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
+		{
+			m_jogTarget[address] = 0.0f;
+		}
+	}
 
-/**
- * @brief Move by speed.
- * 
- * @param position JointPosition_t, robot position.
- */
-void Robko01Class::move_speed(JointPosition_t position) {
-#ifdef SHOW_FUNC_NAMES_S
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
-#endif // SHOW_FUNC_NAMES
+	// The timer of the motion task may fire a little early.
+	unsigned long ElapsedL = m_timeNow - m_timePrev;
+	unsigned long LateL = (ElapsedL > m_updateRate) ? (ElapsedL - m_updateRate) : 0;
 
-	m_operationMode = OperationModes::Speed;
+	// Late for more than one whole slot.
+	if (LateL > m_updateRate)
+	{
+		m_statsOverruns++;
+	}
+	if (LateL > m_statsLateMax)
+	{
+		m_statsLateMax = LateL;
+	}
+
+	serve_address();
+
+	m_timePrev = m_timeNow;
+
+	unsigned long SlotTimeL = micros() - m_timeNow;
+	if (SlotTimeL > 0xFFFF)
+	{
+		SlotTimeL = 0xFFFF;
+	}
+	m_statsSlots++;
+	// Halve the sum before it wraps, the mean stays the same.
+	if (m_statsSlotTime > 0x7FFFFFFFUL)
+	{
+		m_statsSlotTime >>= 1;
+		m_statsSlotSamples >>= 1;
+	}
+	m_statsSlotTime += SlotTimeL;
+	m_statsSlotSamples++;
+	if (SlotTimeL > m_statsSlotTimeMax)
+	{
+		m_statsSlotTimeMax = (uint16_t)SlotTimeL;
+	}
 
-	m_steppers[AddressIndex::Base].setSpeed(position.BaseSpeed);
-	m_steppers[AddressIndex::Shoulder].setSpeed(position.ShoulderSpeed);
-	m_steppers[AddressIndex::Elbow].setSpeed(position.ElbowSpeed);
-	m_steppers[AddressIndex::DiffLeft].setSpeed(position.LeftDiffSpeed);
-	m_steppers[AddressIndex::DiffRight].setSpeed(position.RightDiffSpeed);
-	m_steppers[AddressIndex::Gripper].setSpeed(position.GripperSpeed);
+	if (cbSlot != nullptr)
+	{
+		cbSlot();
+	}
 }
 
-/** 
- * @brief Move by speed.
+/**
+ * @brief Set the max speed of a move, the override scales it.
  * 
- * @return JointPosition_t, current robot position.
+ * @param address uint8_t, Axis.
+ * @param speed float, Max speed in steps per second.
  */
-JointPosition_t Robko01Class::get_position() {
+void Robko01Class::plan_max_speed(uint8_t address, float speed) {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	JointPosition_t PositionL;
+	// Every joint at its own limit.
+	if (speed > max_speed(address))
+	{
+		speed = max_speed(address);
+	}
 
-	PositionL.BasePos = (int16_t)m_steppers[AddressIndex::Base].currentPosition();
-	PositionL.BaseSpeed = (int16_t)m_steppers[AddressIndex::Base].speed();
-	PositionL.ShoulderPos = (int16_t)m_steppers[AddressIndex::Shoulder].currentPosition();
-	PositionL.ShoulderSpeed = (int16_t)m_steppers[AddressIndex::Shoulder].speed();
-	PositionL.ElbowPos = (int16_t)m_steppers[AddressIndex::Elbow].currentPosition();
-	PositionL.ElbowSpeed = (int16_t)m_steppers[AddressIndex::Elbow].speed();
-	PositionL.LeftDiffPos = (int16_t)m_steppers[AddressIndex::DiffLeft].currentPosition();
-	PositionL.LeftDiffSpeed = (int16_t)m_steppers[AddressIndex::DiffLeft].speed();
-	PositionL.RightDiffPos = (int16_t)m_steppers[AddressIndex::DiffRight].currentPosition();
-	PositionL.RightDiffSpeed = (int16_t)m_steppers[AddressIndex::DiffRight].speed();
-	PositionL.GripperPos = (int16_t)m_steppers[AddressIndex::Gripper].currentPosition();
-	PositionL.GripperSpeed = (int16_t)m_steppers[AddressIndex::Gripper].speed();
+	m_plannedSpeed[address] = speed;
 
-	return PositionL;
+	// No override is in effect for the new speed yet.
+	m_overrideEffective[address] = 0;
+	update_override(address);
 }
 
-/** 
- * @brief Set Port A of the robot.
+/**
+ * @brief Ramp the max speed of the axis to the overridden planned speed.
  * 
- * @param uint8_t value, Value of the port.
+ * @param address uint8_t, Axis.
  */
-void Robko01Class::set_port_a(uint8_t value) {
+void Robko01Class::update_override(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	uint16_t PercentL = override_percent(address);
+
+	// Most slots, no float math.
+	if (PercentL == m_overrideEffective[address])
+	{
+		return;
+	}
+
+	float TargetL = m_plannedSpeed[address] * PercentL / 100.0f;
+	float MaxL = TargetL;
+
+	// Faster is safe, the stepper accelerates to it. Slower goes down one
+	// bus cycle of deceleration at a time, the speed never jumps.
+	if (TargetL < m_overrideSpeed[address])
+	{
+		float FloorL = fabs(m_steppers[address].speed()) - (max_acceleration(address) * ADDRESS_COUNT * (m_updateRate / 1000000.0f));
+		if (FloorL > MaxL)
+		{
+			MaxL = FloorL;
+		}
+		if (MaxL > m_overrideSpeed[address])
+		{
+			MaxL = m_overrideSpeed[address];
+		}
+	}
+
+	m_overrideSpeed[address] = MaxL;
+	m_steppers[address].setMaxSpeed(MaxL);
+
+	uint8_t EffectiveL = (uint8_t)PercentL;
+	if ((MaxL != TargetL) && (m_plannedSpeed[address] > 0.0f))
+	{
+		EffectiveL = (uint8_t)constrain((MaxL * 100.0f) / m_plannedSpeed[address], (float)(PercentL + 1), 255.0f);
+	}
+	__atomic_store_n(&m_overrideEffective[address], EffectiveL, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Override of the axis, the global one times the axis one.
+ * 
+ * @param address uint8_t, Axis.
+ * @return uint16_t, Override in percent.
+ */
+uint16_t Robko01Class::override_percent(uint8_t address) {
+	uint16_t PercentL = ((uint16_t)__atomic_load_n(&m_overrideGlobal, __ATOMIC_RELAXED) * __atomic_load_n(&m_overrideAxis[address], __ATOMIC_RELAXED)) / 100;
+	if (PercentL < OVERRIDE_MIN)
+	{
+		PercentL = OVERRIDE_MIN;
+	}
+
+	return PercentL;
+}
+
+/**
+ * @brief Ramp the speed mode speed of the axis to its setpoint and step.
+ * 
+ * @param address uint8_t, Axis.
+ * @return bool, True while the axis moves.
+ */
+bool Robko01Class::update_jog(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// Past the brake point toward a soft limit, one compare per slot.
+	long PositionL = m_steppers[address].currentPosition();
+	if (((m_jogTarget[address] > 0.0f) && (PositionL >= m_jogHigh[address])) ||
+		((m_jogTarget[address] < 0.0f) && (PositionL <= m_jogLow[address])))
+	{
+		m_jogTarget[address] = 0.0f;
+	}
+
+	float TargetL = m_jogTarget[address] * override_percent(address) / 100.0f;
+	float SpeedL = m_jogSpeed[address];
+
+	// One bus cycle passed since the last slot of the axis.
+	if (SpeedL != TargetL)
+	{
+		float AccelerationL = bitRead(m_quickStop, address) ? EMERGENCY_ACCELERATION : jog_acceleration(address);
+		float StepL = AccelerationL * ADDRESS_COUNT * (m_updateRate / 1000000.0f);
+		if (TargetL > SpeedL)
+		{
+			SpeedL = ((TargetL - SpeedL) > StepL) ? (SpeedL + StepL) : TargetL;
+		}
+		else
+		{
+			SpeedL = ((SpeedL - TargetL) > StepL) ? (SpeedL - StepL) : TargetL;
+		}
+		m_jogSpeed[address] = SpeedL;
+		m_steppers[address].setSpeed(SpeedL);
+	}
+
+	m_steppers[address].runSpeed();
+
+	return (SpeedL != 0.0f);
+}
+
+/**
+ * @brief Stop the axis before its next step, target, speed and ramp to rest.
+ * 
+ * @param address uint8_t, Axis.
+ */
+void Robko01Class::hard_stop(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	end_quick_stop(address);
+	m_steppers[address].setCurrentPosition(m_steppers[address].currentPosition());
+	m_jogTarget[address] = 0.0f;
+	m_jogSpeed[address] = 0.0f;
+}
+
+/**
+ * @brief Give the axis its configured acceleration back after a quick stop.
+ * 
+ * @param address uint8_t, Axis.
+ */
+void Robko01Class::end_quick_stop(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (!bitRead(m_quickStop, address))
+	{
+		return;
+	}
+
+	bitClear(m_quickStop, address);
+	m_steppers[address].setAcceleration(max_acceleration(address));
+}
+
+/**
+ * @brief Count the energised time of the axis and switch its coils off or back on.
+ * 
+ * @param address uint8_t, Axis.
+ * @return bool, True if this slot of the axis is spent, the coils are written.
+ */
+bool Robko01Class::update_hold(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// The coils kept what the last slot of the axis latched. The calibration
+	// serves slots without a new slot time, those count with the next one.
+	long ElapsedL = (long)(m_timeNow - m_holdServed[address]);
+	if (ElapsedL > 0)
+	{
+		if (!bitRead(m_released, address))
+		{
+			m_energisedUs += (unsigned long)ElapsedL;
+			if (m_energisedUs >= 1000UL)
+			{
+				m_energised += m_energisedUs / 1000UL;
+				m_energisedUs %= 1000UL;
+			}
+		}
+		m_holdServed[address] = m_timeNow;
+	}
+
+	if (axis_busy(address))
+	{
+		m_idleSince[address] = m_timeNow;
+
+		if (!bitRead(m_released, address))
+		{
+			return false;
+		}
+
+		// Energise the last step first, the rotor locks to it before it moves.
+		bitClear(m_released, address);
+		write_di(coil_mask(address));
+		return true;
+	}
+
+	if (!bitRead(m_released, address))
+	{
+		if ((m_idleTimeout[address] == 0) || ((m_timeNow - m_idleSince[address]) < (m_idleTimeout[address] * 1000UL)))
+		{
+			return false;
+		}
+
+		bitSet(m_released, address);
+	}
+
+	// All coils off.
+	write_di(0);
+	return true;
+}
+
+/**
+ * @brief Axis has a move or speed to run.
+ * 
+ * @param address uint8_t, Axis.
+ * @return bool, True if the axis has work.
+ */
+bool Robko01Class::axis_busy(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (m_operationMode == OperationModes::Speed)
+	{
+		return (m_jogTarget[address] != 0.0f) || (m_jogSpeed[address] != 0.0f);
+	}
+
+	return (m_steppers[address].distanceToGo() != 0) || (m_steppers[address].speed() != 0.0f);
+}
+
+/**
+ * @brief Coils of the current step of the axis in its drive mode.
+ * 
+ * @param address uint8_t, Axis.
+ * @return uint8_t, Coil mask, bit N energises the coil on DIN.
+ */
+uint8_t Robko01Class::coil_mask(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return PhaseCoils_g[coil_phase(address)];
+}
+
+/**
+ * @brief Electrical position of the coils of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return uint8_t, 0 .. 7 on the half step circle.
+ */
+uint8_t Robko01Class::coil_phase(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	long PhaseL = DRIVE_PHASE_ORIGIN + m_phaseOffset[address] + (m_steppers[address].currentPosition() * half_steps_per_step(address));
+
+	// Single coil phases are the even ones, one half step back.
+	if (m_driveMode[address] == DriveModes::DriveWave)
+	{
+		PhaseL--;
+	}
+
+	return PhaseL & 0x07;
+}
+
+/**
+ * @brief Keep the coils at a phase after the position or the drive mode changed.
+ * 
+ * @param address uint8_t, Axis.
+ * @param phase uint8_t, coil_phase() before the change.
+ */
+void Robko01Class::keep_phase(uint8_t address, uint8_t phase) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	m_phaseOffset[address] = 0;
+	uint8_t OffsetL = (phase - coil_phase(address)) & 0x07;
+
+	// Full and wave steps stay on the phases of their mode, an odd half step rounds down.
+	if (half_steps_per_step(address) == 2)
+	{
+		OffsetL &= 0x06;
+	}
+
+	m_phaseOffset[address] = OffsetL;
+}
+
+/**
+ * @brief Half steps of one step of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return uint8_t, 1 or 2.
+ */
+uint8_t Robko01Class::half_steps_per_step(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return (m_driveMode[address] == DriveModes::DriveHalf) ? 1 : 2;
+}
+
+/**
+ * @brief Speed limit of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return float, Steps per second.
+ */
+float Robko01Class::max_speed(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	const AxisLimits_t &LimitsL = m_limits.value().Axis[address];
+
+	return (LimitsL.MaxSpeed == 0) ? DEFAULT_SPEED : (float)LimitsL.MaxSpeed;
+}
+
+/**
+ * @brief Acceleration of the speed mode ramp of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return float, Steps per second squared.
+ */
+float Robko01Class::jog_acceleration(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	float AccelerationL = max_acceleration(address);
+
+	return (AccelerationL > JOG_ACCELERATION) ? JOG_ACCELERATION : AccelerationL;
+}
+
+/**
+ * @brief Pull a target into the soft limits of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @param position long, Target in steps.
+ * @return long, Target within the limits.
+ */
+long Robko01Class::soft_clamp(uint8_t address, long position) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	const AxisLimits_t &LimitsL = m_limits.value().Axis[address];
+
+	// Equal limits, no soft limits.
+	if (LimitsL.MinPosition == LimitsL.MaxPosition)
+	{
+		return position;
+	}
+
+	return constrain(position, (long)LimitsL.MinPosition, (long)LimitsL.MaxPosition);
+}
+
+/**
+ * @brief Brake points of the speed mode for the setpoint of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ */
+void Robko01Class::plan_jog_brake(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	const AxisLimits_t &LimitsL = m_limits.value().Axis[address];
+
+	if (LimitsL.MinPosition == LimitsL.MaxPosition)
+	{
+		m_jogLow[address] = INT32_MIN;
+		m_jogHigh[address] = INT32_MAX;
+		return;
+	}
+
+	// Ramp down from the faster of the speed and the setpoint, plus the bus
+	// cycle before the slot notices it.
+	float SpeedL = fabs(m_jogTarget[address]);
+	if (fabs(m_jogSpeed[address]) > SpeedL)
+	{
+		SpeedL = fabs(m_jogSpeed[address]);
+	}
+	long BrakeL = (long)((SpeedL * SpeedL) / (2.0f * jog_acceleration(address)) + (SpeedL * ADDRESS_COUNT * (m_updateRate / 1000000.0f))) + 1;
+
+	m_jogLow[address] = LimitsL.MinPosition + BrakeL;
+	m_jogHigh[address] = LimitsL.MaxPosition - BrakeL;
+}
+
+/**
+ * @brief Acceleration limit of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return float, Steps per second squared.
+ */
+float Robko01Class::max_acceleration(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	const AxisLimits_t &LimitsL = m_limits.value().Axis[address];
+
+	return (LimitsL.MaxAcceleration == 0) ? DEFAULT_ACCELERATION : (float)LimitsL.MaxAcceleration;
+}
+
+/**
+ * @brief Drive the bus for the current address and step to the next one.
+ * 
+ */
+void Robko01Class::serve_address() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// Update motors.		
+	if (m_currentAddressIndex < AXIS_COUNT)
+	{
+		// A latched stop input, before the axis takes another step.
+		if (bitRead(m_stopInputs.pending(), m_currentAddressIndex))
+		{
+			hard_stop(m_currentAddressIndex);
+			m_stopInputs.served(m_currentAddressIndex);
+		}
+
+		set_address_bus(m_currentAddressIndex);
+		update_override(m_currentAddressIndex);
+		if (update_hold(m_currentAddressIndex))
+		{
+			// No step while the coils go off or lock back on.
+			bitClear(m_motorState, m_currentAddressIndex);
+		}
+		else
+		{
+			// Update motor state, the latch takes the coils of the new position.
+			m_motorState = update_motor(m_currentAddressIndex);
+			write_di(coil_mask(m_currentAddressIndex));
+		}
+		iow();
+	}
+	else
+	{
+		// Update port A.
+		set_address_bus(m_currentAddressIndex);
+		update_port_a(m_currentAddressIndex);
+		iow();
+		ior();
+	}
+
+	// Increment the address bus index.
+	m_currentAddressIndex++;
+
+	// Clear the address index, the cycle is whole.
+	if (m_currentAddressIndex >= ADDRESS_COUNT)
+	{
+		m_currentAddressIndex = 0;
+		publish_snapshot();
+	}
+}
+
+/** @brief Publish the robot state, slot side.
+ *  @return Void.
+ */
+void Robko01Class::publish_snapshot() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	RobotSnapshot_t SnapshotL;
+
+	SnapshotL.MotorState = m_motorState;
+	SnapshotL.PortA = (m_portLoAIn | (m_portHiAIn << 4));
+	SnapshotL.Executed = m_commandsExecuted;
+	SnapshotL.Released = m_released;
+	SnapshotL.Energised = m_energised;
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		SnapshotL.State.Axis[address].Position = (int32_t)m_steppers[address].currentPosition();
+		SnapshotL.State.Axis[address].Speed = (int32_t)(m_steppers[address].speed() * JOINT_SPEED_ONE);
+	}
+
+	m_snapshot.write(SnapshotL);
+}
+
+/** @brief Execute one motion command.
+ *  @param command MotionCommand_t, Command.
+ *  @return Void.
+ */
+void Robko01Class::execute_command(const MotionCommand_t &command) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	switch (command.Type)
+	{
+	case MotionCommands::CmdStop:
+		stop_motors(command.Value);
+		break;
+
+	case MotionCommands::CmdDisable:
+		disable_motors();
+		break;
+
+	case MotionCommands::CmdEnable:
+		enable_motors();
+		break;
+
+	case MotionCommands::CmdClear:
+		clear_motors();
+		break;
+
+	case MotionCommands::CmdMoveRelative:
+		move_relative(command.Position);
+		break;
+
+	case MotionCommands::CmdMoveAbsolute:
+		move_absolute(command.Position);
+		break;
+
+	case MotionCommands::CmdMoveSpeed:
+		move_speed(command.Position);
+		break;
+
+	case MotionCommands::CmdMoveRelative32:
+		move_relative32(command.State);
+		break;
+
+	case MotionCommands::CmdMoveAbsolute32:
+		move_absolute32(command.State);
+		break;
+
+	case MotionCommands::CmdSetPortA:
+		set_port_a(command.Value);
+		break;
+
+	case MotionCommands::CmdSetUpdateRate:
+		set_update_rate(command.Period);
+		break;
+
+	case MotionCommands::CmdCalibrate:
+		calibrate_update_rate();
+		break;
+
+	case MotionCommands::CmdSetJogTimeout:
+		set_jog_timeout((uint16_t)command.Period);
+		break;
+
+	case MotionCommands::CmdSetDriveMode:
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
+		{
+			if (command.Mode[address] != DRIVE_MODE_KEEP)
+			{
+				set_drive_mode(address, command.Mode[address]);
+			}
+		}
+		break;
+
+	case MotionCommands::CmdSetLimits:
+		set_axis_limits(m_commandArgs.Limits.Axis, m_commandArgs.Limits.Value);
+		__atomic_store_n(&m_commandArgsBusy, (uint8_t)0, __ATOMIC_RELEASE);
+		break;
+
+	case MotionCommands::CmdMoveUntilInput:
+#ifdef ENABLE_PROBE
+		move_until_input(command.State, m_commandArgs.Probe.Mask, m_commandArgs.Probe.Level);
+#endif
+		__atomic_store_n(&m_commandArgsBusy, (uint8_t)0, __ATOMIC_RELEASE);
+		break;
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	case MotionCommands::CmdAddTrigger:
+		add_trigger(command.Trigger);
+		break;
+
+	case MotionCommands::CmdClearTriggers:
+		clear_triggers();
+		break;
+#endif
+
+	case MotionCommands::CmdSetIdleTimeout:
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
+		{
+			if (command.Timeout[address] != IDLE_TIMEOUT_KEEP)
+			{
+				set_idle_timeout(address, command.Timeout[address]);
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/** @brief Queue a motion command, safe from one other task, core or ISR.
+ *  @param command MotionCommand_t, Command.
+ *  @return bool, False if the queue is full.
+ */
+bool Robko01Class::post(const MotionCommand_t &command) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	uint8_t PostedL = m_commandsPosted;
+
+	// Counted before the push, executed never runs ahead of posted.
+	__atomic_store_n(&m_commandsPosted, (uint8_t)(PostedL + 1), __ATOMIC_RELEASE);
+	if (m_commands.push(command) == false)
+	{
+		__atomic_store_n(&m_commandsPosted, PostedL, __ATOMIC_RELEASE);
+		return false;
+	}
+
+	return true;
+}
+
+/** @brief Queue a command without arguments or with a Port A value.
+ *  @param type uint8_t, MotionCommands value.
+ *  @param value uint8_t, Port A value.
+ *  @return bool, False if the queue is full.
+ */
+bool Robko01Class::post(uint8_t type, uint8_t value) {
+	MotionCommand_t CommandL;
+	memset(&CommandL, 0, sizeof(CommandL));
+	CommandL.Type = type;
+	CommandL.Value = value;
+
+	return post(CommandL);
+}
+
+/** @brief Queue a 16 bit motion command.
+ *  @param type uint8_t, MotionCommands value.
+ *  @param position JointPosition_t, Target.
+ *  @return bool, False if the queue is full.
+ */
+bool Robko01Class::post(uint8_t type, const JointPosition_t &position) {
+	MotionCommand_t CommandL;
+	memset(&CommandL, 0, sizeof(CommandL));
+	CommandL.Type = type;
+	CommandL.Position = position;
+
+	return post(CommandL);
+}
+
+/** @brief Queue a 32 bit motion command.
+ *  @param type uint8_t, MotionCommands value.
+ *  @param state JointState32_t, Target.
+ *  @return bool, False if the queue is full.
+ */
+bool Robko01Class::post(uint8_t type, const JointState32_t &state) {
+	MotionCommand_t CommandL;
+	memset(&CommandL, 0, sizeof(CommandL));
+	CommandL.Type = type;
+	CommandL.State = state;
+
+	return post(CommandL);
+}
+
+/** @brief Queue CmdSetLimits, the limits wait in the one argument slot.
+ *  @param address uint8_t, Axis.
+ *  @param limits AxisLimits_t, Limits.
+ *  @return bool, False if the queue is full or the slot holds a command not executed yet.
+ */
+bool Robko01Class::post(uint8_t address, const AxisLimits_t &limits) {
+	if (__atomic_load_n(&m_commandArgsBusy, __ATOMIC_ACQUIRE) != 0)
+	{
+		return false;
+	}
+
+	// The push publishes the slot to the consumer.
+	m_commandArgs.Limits.Axis = address;
+	m_commandArgs.Limits.Value = limits;
+	m_commandArgsBusy = 1;
+	if (post(MotionCommands::CmdSetLimits) == false)
+	{
+		m_commandArgsBusy = 0;
+		return false;
+	}
+
+	return true;
+}
+
+/** @brief Queue CmdMoveUntilInput, the condition waits in the one argument slot.
+ *  @param state JointState32_t, Target and speeds.
+ *  @param mask uint8_t, Port A bits of the condition.
+ *  @param level uint8_t, Levels of the masked bits that stop the move.
+ *  @return bool, False if the queue is full or the slot holds a command not executed yet.
+ */
+bool Robko01Class::post(const JointState32_t &state, uint8_t mask, uint8_t level) {
+	if (__atomic_load_n(&m_commandArgsBusy, __ATOMIC_ACQUIRE) != 0)
+	{
+		return false;
+	}
+
+	m_commandArgs.Probe.Mask = mask;
+	m_commandArgs.Probe.Level = level;
+	m_commandArgsBusy = 1;
+	if (post(MotionCommands::CmdMoveUntilInput, state) == false)
+	{
+		m_commandArgsBusy = 0;
+		return false;
+	}
+
+	return true;
+}
+
+/** @brief Count of the posted commands not executed yet, producer side.
+ *  @return uint8_t, Count.
+ */
+uint8_t Robko01Class::commands_pending() {
+	return (uint8_t)(__atomic_load_n(&m_commandsPosted, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_commandsExecuted, __ATOMIC_ACQUIRE));
+}
+
+/** @brief Count of the executed commands, wraps at 256.
+ *  @return uint8_t, Count.
+ */
+uint8_t Robko01Class::commands_executed() {
+	return __atomic_load_n(&m_commandsExecuted, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Count of the posted commands, wraps at 256.
+ *  @return uint8_t, Count.
+ */
+uint8_t Robko01Class::commands_posted() {
+	return __atomic_load_n(&m_commandsPosted, __ATOMIC_ACQUIRE);
+}
+
+/** @brief Set the slot callback, runs in the context that serves the bus.
+ *  @param callback, Callback pointer.
+ *  @return Void.
+ */
+void Robko01Class::setCbSlot(void(*callback)()) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	cbSlot = callback;
+}
+
+#if defined(ESP32)
+/** @brief esp_timer callback, wakes the motion task.
+ *  @param parameter void *, Robko01Class instance.
+ *  @return Void.
+ */
+void Robko01Class::motion_timer(void * parameter) {
+	Robko01Class * RobotL = (Robko01Class *)parameter;
+
+	xTaskNotifyGive(RobotL->m_task);
+}
+
+/** @brief Body of the motion task.
+ *  @param parameter void *, Robko01Class instance.
+ *  @return Void.
+ */
+void Robko01Class::motion_task(void * parameter) {
+	Robko01Class * RobotL = (Robko01Class *)parameter;
+
+	for (;;)
+	{
+		// Missed wake ups collapse into one, the lateness shows in the stats.
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		RobotL->m_timeNow = micros();
+		RobotL->m_statsUpdates++;
+		RobotL->update_slot();
+	}
+}
+
+/** @brief Serve the bus from a pinned task woken every update rate, update() does nothing after it.
+ *  @param core uint8_t, Core of the task.
+ *  @param priority uint8_t, FreeRTOS priority of the task.
+ *  @return bool, True if the task and the timer are running.
+ */
+bool Robko01Class::start_task(uint8_t core, uint8_t priority) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (m_task != NULL)
+	{
+		return true;
+	}
+
+	// The timer callback needs the handle, the task blocks until the first tick.
+	if (xTaskCreatePinnedToCore(motion_task, "Robko01", MOTION_TASK_STACK, this, priority, &m_task, core) != pdPASS)
+	{
+		m_task = NULL;
+		return false;
+	}
+
+	esp_timer_create_args_t TimerArgsL = {};
+	TimerArgsL.callback = motion_timer;
+	TimerArgsL.arg = this;
+	TimerArgsL.dispatch_method = ESP_TIMER_TASK;
+	TimerArgsL.name = "Robko01";
+
+	// Start the slot timing over, the last update() may be long ago.
+	m_timePrev = micros();
+
+	if ((esp_timer_create(&TimerArgsL, &m_timer) != ESP_OK) ||
+		(esp_timer_start_periodic(m_timer, m_updateRate) != ESP_OK))
+	{
+		vTaskDelete(m_task);
+		m_task = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/** @brief Motion task flag.
+ *  @return bool, True while the task serves the bus.
+ */
+bool Robko01Class::task_running() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return (m_task != NULL);
+}
+#endif
+
+/**
+ * @brief Set the bus slot period.
+ * 
+ * @param rate uint32_t, Period in us, clamped to UPDATE_RATE_MIN and UPDATE_RATE_MAX.
+ */
+void Robko01Class::set_update_rate(uint32_t rate) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (rate < UPDATE_RATE_MIN)
+	{
+		rate = UPDATE_RATE_MIN;
+	}
+	else if (rate > UPDATE_RATE_MAX)
+	{
+		rate = UPDATE_RATE_MAX;
+	}
+
+	m_updateRate = rate;
+
+#if defined(ESP32)
+	// The motion task follows the new period from the next tick.
+	if (m_timer != NULL)
+	{
+		esp_timer_stop(m_timer);
+		esp_timer_start_periodic(m_timer, m_updateRate);
+	}
+#endif
+}
+
+/**
+ * @brief Bus slot period.
+ * 
+ * @return uint32_t, Period in us.
+ */
+uint32_t Robko01Class::get_update_rate() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return m_updateRate;
+}
+
+/**
+ * @brief Measure the longest slot and derive the slot period from it.
+ * 
+ * @param cycles uint8_t, Bus cycles to measure.
+ * @return uint32_t, New period in us.
+ */
+uint32_t Robko01Class::calibrate_update_rate(uint8_t cycles) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	unsigned long CostL = 0;
+
+	// The same bus work as in operation, pins, ADC and the stepper math.
+	for (uint16_t slot = 0; slot < (uint16_t)cycles * ADDRESS_COUNT; slot++)
+	{
+		unsigned long StartL = micros();
+		serve_address();
+		unsigned long SlotTimeL = micros() - StartL;
+		if (SlotTimeL > CostL)
+		{
+			CostL = SlotTimeL;
+		}
+	}
+
+	m_slotCost = (CostL > 0xFFFF) ? 0xFFFF : (uint16_t)CostL;
+
+#if !defined(SLOW)
+	// Round up to 10 us, it reads better in the Stats.
+	uint32_t RateL = ((CostL * CALIBRATION_MARGIN) + 9) / 10 * 10;
+	set_update_rate(RateL);
+#endif
+
+	// The measurement is no late slot, also when a posted CmdCalibrate ran it.
+	m_timeNow = micros();
+	m_timePrev = m_timeNow;
+
+	return m_updateRate;
+}
+
+/**
+ * @brief Slot period and the cost measured by the last calibration.
+ * 
+ * @return Robko01Timing_t, Timing.
+ */
+Robko01Timing_t Robko01Class::get_timing() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Timing_t TimingL;
+
+	TimingL.UpdateRate = m_updateRate;
+	TimingL.SlotCost = m_slotCost;
+
+	return TimingL;
+}
+
+/**
+ * @brief Set the global speed override.
+ * 
+ * @param percent uint8_t, Override, OVERRIDE_MIN to OVERRIDE_MAX.
+ */
+void Robko01Class::set_override(uint8_t percent) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// One byte, the slot side picks it up at the next axis slot.
+	__atomic_store_n(&m_overrideGlobal, (uint8_t)constrain(percent, OVERRIDE_MIN, OVERRIDE_MAX), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Set the speed override of one axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @param percent uint8_t, Override, OVERRIDE_MIN to OVERRIDE_MAX.
+ */
+void Robko01Class::set_axis_override(uint8_t address, uint8_t percent) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (address >= AXIS_COUNT)
+	{
+		return;
+	}
+
+	__atomic_store_n(&m_overrideAxis[address], (uint8_t)constrain(percent, OVERRIDE_MIN, OVERRIDE_MAX), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Speed overrides, set and in effect.
+ * 
+ * @return Robko01Override_t, Overrides.
+ */
+Robko01Override_t Robko01Class::get_override() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Override_t OverrideL;
+
+	OverrideL.Global = __atomic_load_n(&m_overrideGlobal, __ATOMIC_RELAXED);
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		OverrideL.Axis[address] = __atomic_load_n(&m_overrideAxis[address], __ATOMIC_RELAXED);
+		OverrideL.Effective[address] = __atomic_load_n(&m_overrideEffective[address], __ATOMIC_RELAXED);
+	}
+
+	return OverrideL;
+}
+
+/**
+ * @brief Set the idle time after which the coils of the axis go off, they come back on the next move.
+ * 
+ * @param address uint8_t, Axis.
+ * @param timeout uint16_t, Timeout in ms, 0 holds the axis.
+ */
+void Robko01Class::set_idle_timeout(uint8_t address, uint16_t timeout) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (address >= AXIS_COUNT)
+	{
+		return;
+	}
+
+	m_idleTimeout[address] = timeout;
+}
+
+/**
+ * @brief Idle timeout of the axis.
+ * 
+ * @param address uint8_t, Axis.
+ * @return uint16_t, Timeout in ms, 0 if held.
+ */
+uint16_t Robko01Class::get_idle_timeout(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (address >= AXIS_COUNT)
+	{
+		return 0;
+	}
+
+	return m_idleTimeout[address];
+}
+
+/**
+ * @brief Hold policy, released axes and energised time of the snapshot.
+ * 
+ * @return Robko01Hold_t, Hold state.
+ */
+Robko01Hold_t Robko01Class::get_hold() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Hold_t HoldL;
+	RobotSnapshot_t SnapshotL = get_snapshot();
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		HoldL.IdleTimeout[address] = get_idle_timeout(address);
+	}
+	HoldL.Released = SnapshotL.Released;
+	HoldL.Energised = SnapshotL.Energised;
+
+	return HoldL;
+}
+
+/**
+ * @brief Set the coil sequence of an idle axis, the position keeps the shaft angle in the new steps.
+ * 
+ * @param address uint8_t, Axis.
+ * @param mode uint8_t, DriveModes value.
+ * @return bool, False if the axis moves or the mode is unknown.
+ */
+bool Robko01Class::set_drive_mode(uint8_t address, uint8_t mode) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if ((address >= AXIS_COUNT) || (mode > DriveModes::DriveWave) || axis_busy(address))
+	{
+		return false;
+	}
+
+	// Same shaft angle in the steps of the new mode, an odd half step rounds down.
+	uint8_t PhaseL = coil_phase(address);
+	uint8_t FromL = half_steps_per_step(address);
+	__atomic_store_n(&m_driveMode[address], mode, __ATOMIC_RELAXED);
+	uint8_t ToL = half_steps_per_step(address);
+	m_steppers[address].setCurrentPosition(rescale_steps(m_steppers[address].currentPosition(), FromL, ToL));
+	keep_phase(address, PhaseL);
+
+	// The soft limits and the speeds are in steps too, they keep the angle.
+	AxisLimits_t LimitsL = m_limits.value().Axis[address];
+	LimitsL.MinPosition = rescale_steps(LimitsL.MinPosition, FromL, ToL);
+	LimitsL.MaxPosition = rescale_steps(LimitsL.MaxPosition, FromL, ToL);
+	LimitsL.DriveMode = mode;
+	m_limits.write(address * sizeof(AxisLimits_t), &LimitsL, sizeof(AxisLimits_t));
+	plan_jog_brake(address);
+
+	return true;
+}
+
+/**
+ * @brief Drive modes and the speed limit of the bus in half steps.
+ * 
+ * @return Robko01Drive_t, Drive state.
+ */
+Robko01Drive_t Robko01Class::get_drive() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Drive_t DriveL;
+
+	// Every axis latches one step per bus cycle at most.
+	uint32_t CyclesL = 1000000UL / ((uint32_t)ADDRESS_COUNT * get_update_rate());
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		DriveL.Mode[address] = __atomic_load_n(&m_driveMode[address], __ATOMIC_RELAXED);
+		uint32_t MaxL = CyclesL * ((DriveL.Mode[address] == DriveModes::DriveHalf) ? 1 : 2);
+		DriveL.MaxSpeed[address] = (MaxL > 0xFFFF) ? 0xFFFF : (uint16_t)MaxL;
+	}
+
+	return DriveL;
+}
+
+/**
+ * @brief Set the kinematic limits and the drive mode of an idle axis, the planner clamps every move to them.
+ * 
+ * @param address uint8_t, Axis.
+ * @param limits AxisLimits_t, Limits, zero speed or acceleration takes the default.
+ * @return bool, False if the axis moves or the limits are invalid.
+ */
+bool Robko01Class::set_axis_limits(uint8_t address, const AxisLimits_t &limits) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if ((address >= AXIS_COUNT) || (limits.MinPosition > limits.MaxPosition))
+	{
+		return false;
+	}
+
+	// Checks the mode and that the axis stands still.
+	if (set_drive_mode(address, limits.DriveMode) == false)
+	{
+		return false;
+	}
+
+	m_limits.write(address * sizeof(AxisLimits_t), &limits, sizeof(AxisLimits_t));
+	plan_jog_brake(address);
+
+	if (!bitRead(m_quickStop, address))
+	{
+		m_steppers[address].setAcceleration(max_acceleration(address));
+	}
+	plan_max_speed(address, m_plannedSpeed[address]);
+
+	return true;
+}
+
+/**
+ * @brief Kinematic limits of the axis in effect, safe from any context.
+ * 
+ * @param address uint8_t, Axis.
+ * @return AxisLimits_t, Limits, in the steps of the drive mode.
+ */
+AxisLimits_t Robko01Class::get_axis_limits(uint8_t address) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	AxisLimits_t LimitsL;
+
+	if (address >= AXIS_COUNT)
+	{
+		memset(&LimitsL, 0, sizeof(AxisLimits_t));
+		return LimitsL;
+	}
+
+	m_limits.read(address * sizeof(AxisLimits_t), &LimitsL, sizeof(AxisLimits_t));
+	LimitsL.DriveMode = __atomic_load_n(&m_driveMode[address], __ATOMIC_RELAXED);
+
+	return LimitsL;
+}
+
+/**
+ * @brief Kinematic limits of all axes in effect, safe from any context.
+ * 
+ * @return RobotLimits_t, Limits, in the steps of the drive modes.
+ */
+RobotLimits_t Robko01Class::get_limits() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	RobotLimits_t LimitsL;
+
+	m_limits.read(LimitsL);
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		LimitsL.Axis[address].DriveMode = __atomic_load_n(&m_driveMode[address], __ATOMIC_RELAXED);
+	}
+
+	return LimitsL;
+}
+
+/**
+ * @brief Check a move against the soft limits before it is posted, safe from any context.
+ * 
+ * @param type uint8_t, MotionCommands value of the move.
+ * @param state JointState32_t, Move, clamped in place.
+ * @return bool, False if a target is outside and the mode is LimitReject.
+ */
+bool Robko01Class::accept_move(uint8_t type, JointState32_t &state) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	RobotLimits_t LimitsL;
+	JointState32_t NowL;
+	bool RelativeL = (type == MotionCommands::CmdMoveRelative) || (type == MotionCommands::CmdMoveRelative32);
+	bool ClampL = (get_limit_mode() == LimitModes::LimitClamp);
+	bool InsideL = true;
+
+	m_limits.read(LimitsL);
+	if (RelativeL)
+	{
+		NowL = get_state32();
+	}
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		const AxisLimits_t &AxisL = LimitsL.Axis[address];
+		if (AxisL.MinPosition == AxisL.MaxPosition)
+		{
+			continue;
+		}
+
+		int64_t TargetL = state.Axis[address].Position;
+		if (RelativeL)
+		{
+			TargetL += NowL.Axis[address].Position;
+		}
+
+		int64_t ClampedL = TargetL;
+		if (TargetL < AxisL.MinPosition)
+		{
+			ClampedL = AxisL.MinPosition;
+		}
+		else if (TargetL > AxisL.MaxPosition)
+		{
+			ClampedL = AxisL.MaxPosition;
+		}
+
+		if (ClampedL != TargetL)
+		{
+			InsideL = false;
+			if (ClampL)
+			{
+				state.Axis[address].Position = (int32_t)(RelativeL ? (ClampedL - NowL.Axis[address].Position) : ClampedL);
+			}
+		}
+	}
+
+	return (InsideL || ClampL);
+}
+
+/**
+ * @brief Check a 16 bit move against the soft limits before it is posted.
+ * 
+ * @param type uint8_t, MotionCommands value of the move.
+ * @param position JointPosition_t, Move, clamped in place.
+ * @return bool, False if a target is outside and the mode is LimitReject.
+ */
+bool Robko01Class::accept_move(uint8_t type, JointPosition_t &position) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	JointState32_t StateL;
+
+	ConvertJpos2Jstate(position, StateL);
+	if (accept_move(type, StateL) == false)
+	{
+		return false;
+	}
+	// A clamped target beyond 16 bits can not go out as a 16 bit move.
+	return ConvertJstate2Jpos(StateL, position);
+}
+
+/**
+ * @brief Check a move against the pressed stop inputs before it is posted, safe from any context.
+ * 
+ * @param type uint8_t, MotionCommands value of the move.
+ * @param state JointState32_t, Move.
+ * @return bool, True if an axis would move toward a pressed input.
+ */
+bool Robko01Class::inhibited(uint8_t type, const JointState32_t &state) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	uint8_t UpL = m_stopInputs.inhibited(1);
+	uint8_t DownL = m_stopInputs.inhibited(-1);
+	if ((UpL | DownL) == 0)
+	{
+		return false;
+	}
+
+	bool AbsoluteL = (type == MotionCommands::CmdMoveAbsolute) || (type == MotionCommands::CmdMoveAbsolute32) || (type == MotionCommands::CmdMoveUntilInput);
+	bool SpeedL = (type == MotionCommands::CmdMoveSpeed);
+	JointState32_t NowL;
+	if (AbsoluteL)
+	{
+		NowL = get_state32();
+	}
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		long DistanceL = SpeedL ? state.Axis[address].Speed : state.Axis[address].Position;
+		if (AbsoluteL)
+		{
+			DistanceL -= NowL.Axis[address].Position;
+		}
+
+		if (inhibits(address, DistanceL, UpL, DownL))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Check a 16 bit move against the pressed stop inputs before it is posted.
+ * 
+ * @param type uint8_t, MotionCommands value of the move.
+ * @param position JointPosition_t, Move.
+ * @return bool, True if an axis would move toward a pressed input.
+ */
+bool Robko01Class::inhibited(uint8_t type, const JointPosition_t &position) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	JointState32_t StateL;
+
+	ConvertJpos2Jstate(position, StateL);
+	return inhibited(type, StateL);
+}
+
+/**
+ * @brief Whether a pressed stop input refuses the axis to move this way.
+ * 
+ * @param address uint8_t, Axis.
+ * @param distance long, Sign is the direction of the move.
+ * @param up uint8_t, Axes refused in the positive direction.
+ * @param down uint8_t, Axes refused in the negative direction.
+ * @return bool, True if refused.
+ */
+bool Robko01Class::inhibits(uint8_t address, long distance, uint8_t up, uint8_t down) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return ((distance > 0) && bitRead(up, address)) || ((distance < 0) && bitRead(down, address));
+}
+
+/**
+ * @brief Set what accept_move() does with a target outside the soft limits.
+ * 
+ * @param mode uint8_t, LimitModes value.
+ */
+void Robko01Class::set_limit_mode(uint8_t mode) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	__atomic_store_n(&m_limitMode, (uint8_t)((mode == LimitModes::LimitClamp) ? LimitModes::LimitClamp : LimitModes::LimitReject), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief What accept_move() does with a target outside the soft limits.
+ * 
+ * @return uint8_t, LimitModes value.
+ */
+uint8_t Robko01Class::get_limit_mode() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return __atomic_load_n(&m_limitMode, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Motors enables flags.
+ * 
+ * @return true 
+ * @return false 
+ */
+bool Robko01Class::motors_enabled() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return m_motorsEnabled;
+}
+
+/**
+ * @brief Get motors state.
+ * 
+ * @return uint8_t 
+ */
+uint8_t Robko01Class::get_motor_state() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	RobotSnapshot_t SnapshotL = get_snapshot();
+
+	// A posted move counts as motion until a snapshot shows it.
+	if (SnapshotL.Executed != commands_posted())
+	{
+		return SnapshotL.MotorState | MOTOR_STATE_PENDING;
+	}
+
+    return SnapshotL.MotorState;
+}
+
+/**
+ * @brief Robot state as of the last whole bus cycle.
+ * 
+ * @return RobotSnapshot_t, State, never torn.
+ */
+RobotSnapshot_t Robko01Class::get_snapshot() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	RobotSnapshot_t SnapshotL;
+
+	m_snapshot.read(SnapshotL);
+
+	return SnapshotL;
+}
+
+/**
+ * @brief Stop all motors.
+ * 
+ * @param mode uint8_t, StopModes value.
+ */
+void Robko01Class::stop_motors(uint8_t mode) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+#ifdef ENABLE_PROBE
+	end_probe(ProbeStatus::ProbeAborted);
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	// The segment keeps its triggers, any other stop leaves the path.
+	if (mode != StopModes::StopSegment)
+	{
+		__atomic_store_n(&m_triggersArmed, (uint8_t)0, __ATOMIC_RELAXED);
+	}
+#endif
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		// The speed mode ramps down too.
+		m_jogTarget[address] = 0.0f;
+
+		if (mode == StopModes::StopHard)
+		{
+			hard_stop(address);
+		}
+		else if (mode == StopModes::StopQuick)
+		{
+			bitSet(m_quickStop, address);
+			m_steppers[address].setAcceleration(EMERGENCY_ACCELERATION);
+			m_steppers[address].stop();
+		}
+		else if (mode != StopModes::StopSegment)
+		{
+			m_steppers[address].stop();
+		}
+
+		// At StopSegment the move in flight is the segment, it keeps its target.
+	}
+}
+
+/**
+ * @brief Disable all motors.
+ * 
+ */
+void Robko01Class::disable_motors()
+{
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		m_steppers[address].disableOutputs();
+		// set_address_bus(address);
+	}
+
+	m_motorsEnabled = false;
+}
+
+/**
+ * @brief Enable all motors.
+ * 
+ */
+void Robko01Class::enable_motors() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		m_steppers[address].enableOutputs();
+		// set_address_bus(address);
+	}
+
+	m_motorsEnabled = true;
+}
+
+/**
+ * @brief Clear all motors position to 0.
+ * 
+ */
+void Robko01Class::clear_motors() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// The coils stay where they are, the new zero is the rotor phase of now.
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		uint8_t PhaseL = coil_phase(address);
+		m_steppers[address].setCurrentPosition(0);
+		keep_phase(address, PhaseL);
+	}
+}
+
+/** 
+ * @brief Move relatively to position.
+ * 
+ * @param position JointPosition_t, robot position.
+ */
+void Robko01Class::move_relative(JointPosition_t position) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	JointState32_t StateL;
+	ConvertJpos2Jstate(position, StateL);
+	move_relative32(StateL);
+}
+
+/** 
+ * @brief Move absolutely to position.
+ * 
+ * @param position JointPosition_t, robot position.
+ */
+void Robko01Class::move_absolute(JointPosition_t position) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	JointState32_t StateL;
+	ConvertJpos2Jstate(position, StateL);
+	move_absolute32(StateL);
+}
+
+/** 
+ * @brief Move relatively to position, 32 bit version.
+ * 
+ * @param state JointState32_t, robot state.
+ */
+void Robko01Class::move_relative32(const JointState32_t &state) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	m_operationMode = OperationModes::Positioning;
+
+#ifdef ENABLE_PROBE
+	// A new move ends the probe.
+	end_probe(ProbeStatus::ProbeAborted);
+#endif
+
+	// A pressed stop input keeps the axes that would move toward it.
+	uint8_t UpL = m_stopInputs.inhibited(1);
+	uint8_t DownL = m_stopInputs.inhibited(-1);
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		long CurrentL = m_steppers[address].currentPosition();
+		long TargetL = soft_clamp(address, CurrentL + state.Axis[address].Position);
+		if (inhibits(address, TargetL - CurrentL, UpL, DownL))
+		{
+			TargetL = CurrentL;
+		}
+		end_quick_stop(address);
+		m_steppers[address].setSpeed((float)state.Axis[address].Speed / JOINT_SPEED_ONE);
+		m_steppers[address].moveTo(TargetL);
+	}
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	arm_triggers();
+#endif
+}
+
+/** 
+ * @brief Move absolutely to position, 32 bit version.
+ * 
+ * @param state JointState32_t, robot state.
+ */
+void Robko01Class::move_absolute32(const JointState32_t &state) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	m_operationMode = OperationModes::Positioning;
+
+#ifdef ENABLE_PROBE
+	// A new move ends the probe.
+	end_probe(ProbeStatus::ProbeAborted);
+#endif
+
+	// A pressed stop input keeps the axes that would move toward it.
+	uint8_t UpL = m_stopInputs.inhibited(1);
+	uint8_t DownL = m_stopInputs.inhibited(-1);
+
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		float SpeedL = (float)state.Axis[address].Speed / JOINT_SPEED_ONE;
+		long CurrentL = m_steppers[address].currentPosition();
+		long TargetL = soft_clamp(address, state.Axis[address].Position);
+		if (inhibits(address, TargetL - CurrentL, UpL, DownL))
+		{
+			TargetL = CurrentL;
+		}
+		end_quick_stop(address);
+		m_steppers[address].setSpeed(SpeedL);
+		plan_max_speed(address, SpeedL + MAX_SPEED_OFFSET);
+		m_steppers[address].moveTo(TargetL);
+	}
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	arm_triggers();
+#endif
+}
+
+#ifdef ENABLE_PROBE
+/**
+ * @brief Move absolutely until the masked Port A inputs match, then stop in that slot.
+ * 
+ * @param state JointState32_t, Target and speeds.
+ * @param mask uint8_t, Port A bits of the condition.
+ * @param level uint8_t, Levels of the masked bits that stop the move.
+ * @return bool, False on an empty mask.
+ */
+bool Robko01Class::move_until_input(const JointState32_t &state, uint8_t mask, uint8_t level) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (mask == 0)
+	{
+		return false;
+	}
+
+	move_absolute32(state);
+
+	// Checked at both Port A slots of every cycle, a match at the start stops at once.
+	Robko01Probe_t ProbeL;
+	memset(&ProbeL, 0, sizeof(Robko01Probe_t));
+	ProbeL.Status = ProbeStatus::ProbeArmed;
+	m_probeMask = mask;
+	m_probeLevel = level;
+	m_probe.write(ProbeL);
+
+	return true;
+}
+
+/**
+ * @brief Result of the last probe move.
+ * 
+ * @return Robko01Probe_t, Status and positions at the trigger.
+ */
+Robko01Probe_t Robko01Class::get_probe() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Probe_t ProbeL;
+	m_probe.read(ProbeL);
+
+	return ProbeL;
+}
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+/**
+ * @brief Add a Port A output trigger to the next move.
+ * 
+ * @param trigger PortATrigger_t, Entry.
+ * @return bool, False if the entry is not valid or PORT_A_TRIGGERS are pending.
+ */
+bool Robko01Class::add_trigger(const PortATrigger_t &trigger) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if ((trigger.Axis >= AXIS_COUNT) || (trigger.Mask == 0) || (trigger.Kind > TriggerKinds::TriggerFraction))
+	{
+		return false;
+	}
+
+	if ((trigger.Kind == TriggerKinds::TriggerFraction) && ((trigger.Value < 0) || (trigger.Value > TRIGGER_FRACTION_ONE)))
+	{
+		return false;
+	}
+
+	if (m_triggersPending >= PORT_A_TRIGGERS)
+	{
+		return false;
+	}
+
+	m_triggers[m_triggersPending] = trigger;
+	__atomic_store_n(&m_triggersPending, (uint8_t)(m_triggersPending + 1), __ATOMIC_RELAXED);
+
+	return true;
+}
+
+/**
+ * @brief Drop the pending triggers and the ones of the move in flight.
+ * 
+ */
+void Robko01Class::clear_triggers() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	__atomic_store_n(&m_triggersPending, (uint8_t)0, __ATOMIC_RELAXED);
+	__atomic_store_n(&m_triggersArmed, (uint8_t)0, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief State of the Port A output triggers.
+ * 
+ * @return Robko01Triggers_t, Pending count, armed and fired entries.
+ */
+Robko01Triggers_t Robko01Class::get_triggers() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Triggers_t TriggersL;
+	TriggersL.Pending = __atomic_load_n(&m_triggersPending, __ATOMIC_RELAXED);
+	TriggersL.Armed = __atomic_load_n(&m_triggersArmed, __ATOMIC_RELAXED);
+	TriggersL.Fired = __atomic_load_n(&m_triggersFired, __ATOMIC_RELAXED);
+
+	return TriggersL;
+}
+#endif
+
+/**
+ * @brief Move by speed.
+ * 
+ * @param position JointPosition_t, robot position.
+ */
+void Robko01Class::move_speed(JointPosition_t position) {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	// The ramp starts from the speed the axes have now.
+	if (m_operationMode != OperationModes::Speed)
+	{
+		for (uint8_t address = 0; address < AXIS_COUNT; address++)
+		{
+			m_jogSpeed[address] = m_steppers[address].speed();
+		}
+	}
+
+	// A new setpoint ramps at the jog acceleration again.
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		end_quick_stop(address);
+	}
+#ifdef ENABLE_PROBE
+	end_probe(ProbeStatus::ProbeAborted);
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+	// The triggers follow positioning moves only.
+	__atomic_store_n(&m_triggersArmed, (uint8_t)0, __ATOMIC_RELAXED);
+#endif
+
+	m_operationMode = OperationModes::Speed;
+
+	m_jogTarget[AddressIndex::Base] = position.BaseSpeed;
+	m_jogTarget[AddressIndex::Shoulder] = position.ShoulderSpeed;
+	m_jogTarget[AddressIndex::Elbow] = position.ElbowSpeed;
+	m_jogTarget[AddressIndex::DiffLeft] = position.LeftDiffSpeed;
+	m_jogTarget[AddressIndex::DiffRight] = position.RightDiffSpeed;
+	m_jogTarget[AddressIndex::Gripper] = position.GripperSpeed;
+
+	// A pressed stop input keeps the axes that would move toward it.
+	uint8_t UpL = m_stopInputs.inhibited(1);
+	uint8_t DownL = m_stopInputs.inhibited(-1);
+
+	// Every joint at its own limit.
+	for (uint8_t address = 0; address < AXIS_COUNT; address++)
+	{
+		m_jogTarget[address] = constrain(m_jogTarget[address], -max_speed(address), max_speed(address));
+		if (inhibits(address, (m_jogTarget[address] > 0.0f) ? 1 : ((m_jogTarget[address] < 0.0f) ? -1 : 0), UpL, DownL))
+		{
+			m_jogTarget[address] = 0.0f;
+		}
+		plan_jog_brake(address);
+	}
+
+	// Feed the watchdog.
+	m_jogSetpointTime = micros();
+}
+
+/**
+ * @brief Set the speed mode watchdog.
+ * 
+ * @param timeout uint16_t, Timeout in ms, 0 turns it off.
+ */
+void Robko01Class::set_jog_timeout(uint16_t timeout) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	m_jogTimeout = timeout;
+}
+
+/**
+ * @brief Speed mode watchdog.
+ * 
+ * @return uint16_t, Timeout in ms, 0 if off.
+ */
+uint16_t Robko01Class::get_jog_timeout() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return m_jogTimeout;
+}
+
+/** 
+ * @brief Move by speed.
+ * 
+ * @return JointPosition_t, current robot position.
+ */
+JointPosition_t Robko01Class::get_position() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	JointPosition_t PositionL;
+
+	// Saturate instead of wrapping, the 32 bit state has the full range.
+	ConvertJstate2Jpos(get_state32(), PositionL);
+
+	return PositionL;
+}
+
+/** 
+ * @brief Get the current robot state without truncation.
+ * 
+ * @return JointState32_t, current robot state.
+ */
+JointState32_t Robko01Class::get_state32() {
+#ifdef SHOW_FUNC_NAMES_S
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return get_snapshot().State;
+}
+
+/** 
+ * @brief Set Port A of the robot.
+ * 
+ * @param uint8_t value, Value of the port.
+ */
+void Robko01Class::set_port_a(uint8_t value) {
 #ifdef SHOW_FUNC_NAMES_S
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
@@ -633,8 +2831,168 @@ uint8_t Robko01Class::get_port_a() {
 	DEBUGLOG("\r\n");
 #endif // SHOW_FUNC_NAMES
 
-	return ((m_portLoAIn | (m_portHiAIn << 4)));
+	return get_snapshot().PortA;
+}
+
+/**
+ * @brief Set the digital filter of a Port A input.
+ * 
+ * @param bit uint8_t, Input bit.
+ * @param samples uint8_t, Equal samples, one per bus cycle, before the input changes, 0 or 1 takes every change.
+ */
+void Robko01Class::set_port_a_filter(uint8_t bit, uint8_t samples) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (bit >= PORT_A_BITS)
+	{
+		return;
+	}
+
+	__atomic_store_n(&m_portAFilter[bit], samples, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Get the digital filter of a Port A input.
+ * 
+ * @param bit uint8_t, Input bit.
+ * @return uint8_t, Equal samples before the input changes.
+ */
+uint8_t Robko01Class::get_port_a_filter(uint8_t bit) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	if (bit >= PORT_A_BITS)
+	{
+		return 0;
+	}
+
+	return __atomic_load_n(&m_portAFilter[bit], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Drain the filtered Port A edges, oldest first.
+ * 
+ * @param events PortAEvent_t *, Output.
+ * @param size uint8_t, Room in the output.
+ * @return uint8_t, Count of the events.
+ */
+uint8_t Robko01Class::read_port_a_events(PortAEvent_t * events, uint8_t size) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	uint8_t CountL = 0;
+
+	while ((CountL < size) && m_portAEvents.pop(events[CountL]))
+	{
+		CountL++;
+	}
+
+	return CountL;
+}
+
+/**
+ * @brief Edges dropped on a full queue since the init.
+ * Saturates instead of wrapping, so a loss never reads back as none.
+ * 
+ * @return uint8_t, Count, saturates at 255.
+ */
+uint8_t Robko01Class::get_port_a_events_lost() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return __atomic_load_n(&m_portAEventsLost, __ATOMIC_RELAXED);
+}
+
+/** 
+ * @brief Get the control loop counters.
+ * 
+ * @return Robko01Stats_t, Counters since the last reset.
+ */
+Robko01Stats_t Robko01Class::get_stats() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	Robko01Stats_t StatsL;
+
+	StatsL.Elapsed = (uint32_t)(millis() - m_statsSince);
+	StatsL.Updates = m_statsUpdates;
+	StatsL.Slots = m_statsSlots;
+	StatsL.SlotTimeMean = (m_statsSlotSamples == 0) ? 0 : (uint16_t)(m_statsSlotTime / m_statsSlotSamples);
+	StatsL.SlotTimeMax = m_statsSlotTimeMax;
+	StatsL.Overruns = m_statsOverruns;
+	StatsL.LateMax = m_statsLateMax;
+
+	return StatsL;
+}
+
+/** 
+ * @brief Reset the control loop counters.
+ * 
+ */
+void Robko01Class::reset_stats() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	m_statsSince = millis();
+	m_statsUpdates = 0;
+	m_statsSlots = 0;
+	m_statsSlotTime = 0;
+	m_statsSlotSamples = 0;
+	m_statsSlotTimeMax = 0;
+	m_statsOverruns = 0;
+	m_statsLateMax = 0;
+}
+
+/** 
+ * @brief Stop inputs, the ISRs of the e-stop and limit inputs latch() into it.
+ * 
+ * @return StopInputsClass &, Inputs and their latency counters.
+ */
+StopInputsClass & Robko01Class::stop_inputs() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return m_stopInputs;
+}
+
+#ifdef ENABLE_BUS_TRACE
+/** 
+ * @brief Bus transaction recorder.
+ * 
+ * @return BusTraceClass &, Recorder.
+ */
+BusTraceClass & Robko01Class::bus_trace() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	return m_busTrace;
 }
+#endif
 
 /**
  * @brief Robko 01 instance.
@@ -56,10 +56,192 @@
 
 #define IOW_PULSE_TIME 100
 
+/**
+ * @brief Slots of the motion command queue, power of two, one stays free.
+ * 
+ */
+#ifndef MOTION_COMMANDS_SIZE
+#if defined(__AVR__)
+#define MOTION_COMMANDS_SIZE 4
+#else
+#define MOTION_COMMANDS_SIZE 8
+#endif
+#endif
+
+/**
+ * @brief Bytes of RAM Robko01Class may take on AVR, raise it with the probe or the triggers built in.
+ * 
+ */
+#ifndef ROBKO01_RAM_BUDGET
+#define ROBKO01_RAM_BUDGET 1280
+#endif
+
+/**
+ * @brief Slots of the Port A event queue, power of two, one stays free.
+ * 
+ */
+#ifndef PORT_A_EVENTS_SIZE
+#if defined(__AVR__)
+#define PORT_A_EVENTS_SIZE 8
+#else
+#define PORT_A_EVENTS_SIZE 32
+#endif
+#endif
+
+/**
+ * @brief Count of the Port A input bits.
+ * 
+ */
+#define PORT_A_BITS 8
+
+/**
+ * @brief Equal samples, one per bus cycle, before a Port A input changes, 1 takes every change.
+ * 
+ */
+#ifndef PORT_A_FILTER
+#define PORT_A_FILTER 1
+#endif
+
+/**
+ * @brief Port A output triggers one move carries.
+ * 
+ */
+#ifndef PORT_A_TRIGGERS
+#if defined(__AVR__)
+#define PORT_A_TRIGGERS 4
+#else
+#define PORT_A_TRIGGERS 8
+#endif
+#endif
+
+/**
+ * @brief TriggerFraction value at the target, the start is 0.
+ * 
+ */
+#define TRIGGER_FRACTION_ONE 1000
+
+/**
+ * @brief Motor state bit of a posted command not executed yet.
+ * 
+ */
+#define MOTOR_STATE_PENDING 0x80
+
+#if defined(ESP32)
+/**
+ * @brief Core of the motion task, the WiFi stack runs on core 0.
+ * 
+ */
+#ifndef MOTION_TASK_CORE
+#define MOTION_TASK_CORE 1
+#endif
+
+/**
+ * @brief Priority of the motion task, below the esp_timer task.
+ * 
+ */
+#ifndef MOTION_TASK_PRIORITY
+#define MOTION_TASK_PRIORITY 20
+#endif
+
+/**
+ * @brief Stack of the motion task in bytes.
+ * 
+ */
+#define MOTION_TASK_STACK 4096
+#endif
+
 #ifndef ADC_DI_TRESHOLD
 #define ADC_DI_TRESHOLD 384
 #endif
 
+/**
+ * @brief Shortest bus slot period in us.
+ * 
+ */
+#define UPDATE_RATE_MIN 100UL
+
+/**
+ * @brief Longest bus slot period in us, the SLOW rate.
+ * 
+ */
+#define UPDATE_RATE_MAX 1000000UL
+
+/**
+ * @brief Bus cycles measured by calibrate_update_rate().
+ * 
+ */
+#define CALIBRATION_CYCLES 16
+
+/**
+ * @brief Slot period over the longest measured slot, the rest is left to the loop.
+ * 
+ */
+#define CALIBRATION_MARGIN 2
+
+/**
+ * @brief Highest speed override in percent of the planned speed.
+ * 
+ */
+#ifndef OVERRIDE_MAX
+#define OVERRIDE_MAX 100
+#endif
+
+/**
+ * @brief Lowest speed override in percent, zero would stop the step timing.
+ * 
+ */
+#define OVERRIDE_MIN 1
+
+/**
+ * @brief Acceleration of the speed mode in steps per second squared.
+ * 
+ */
+#ifndef JOG_ACCELERATION
+#define JOG_ACCELERATION DEFAULT_ACCELERATION
+#endif
+
+/**
+ * @brief Speed mode ramps to zero without a new setpoint in this many ms, 0 never.
+ * 
+ */
+#ifndef JOG_TIMEOUT
+#define JOG_TIMEOUT 250
+#endif
+
+/**
+ * @brief Deceleration of the quick stop in steps per second squared.
+ * 
+ */
+#ifndef EMERGENCY_ACCELERATION
+#define EMERGENCY_ACCELERATION (4 * DEFAULT_ACCELERATION)
+#endif
+
+/**
+ * @brief Idle axes switch their coils off after this many ms, 0 holds them.
+ * 
+ */
+#ifndef IDLE_TIMEOUT
+#define IDLE_TIMEOUT 0
+#endif
+
+/**
+ * @brief Idle timeout of CmdSetIdleTimeout that leaves the axis as it is.
+ * 
+ */
+#define IDLE_TIMEOUT_KEEP 0xFFFF
+
+/**
+ * @brief Drive mode of CmdSetDriveMode that leaves the axis as it is.
+ * 
+ */
+#define DRIVE_MODE_KEEP 0xFF
+
+/**
+ * @brief Electrical position of the coils at step 0, 0 .. 7 on the half step circle.
+ * 
+ */
+#define DRIVE_PHASE_ORIGIN 5
+
 #pragma endregion
 
 #pragma region Headres
@@ -72,6 +254,15 @@
 
 // #define SLOW
 
+// #define ENABLE_BUS_TRACE
+
+// Probe moves and Port A output triggers, left out of the 2 KB AVR parts,
+// -D ENABLE_PROBE or ENABLE_PORT_A_TRIGGERS builds them in there.
+#if !defined(__AVR__)
+#define ENABLE_PROBE
+#define ENABLE_PORT_A_TRIGGERS
+#endif
+
 #if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
 #endif
 
@@ -81,6 +272,24 @@
 
 #include "JointPosition.h"
 
+#include "JointState32.h"
+
+#include "AxisLimits.h"
+
+#include "SPSCQueue.h"
+
+#include "Seqlock.h"
+
+#include "StopInputs.h"
+
+#ifdef ENABLE_BUS_TRACE
+#include "BusTrace.h"
+#endif
+
+#if defined(ESP32)
+#include "esp_timer.h"
+#endif
+
 /* Stepper motor controller. */
 #include <AccelStepper.h>
 
@@ -104,93 +313,673 @@ enum AddressIndex : uint8_t
     PortA2 = 7
 };
 
-enum OperationModes : uint8_t
-{
-	NONE = 0U,
-	Positioning,
-	Speed,
-};
+/**
+ * @brief Motion command types.
+ * 
+ */
+enum MotionCommands : uint8_t
+{
+	CmdStop = 1U, ///< stop_motors(Value), a StopModes value. Posted, the stop takes effect at the next slot.
+	CmdDisable, ///< disable_motors().
+	CmdEnable, ///< enable_motors().
+	CmdClear, ///< clear_motors().
+	CmdMoveRelative, ///< move_relative(Position).
+	CmdMoveAbsolute, ///< move_absolute(Position).
+	CmdMoveSpeed, ///< move_speed(Position).
+	CmdMoveRelative32, ///< move_relative32(State).
+	CmdMoveAbsolute32, ///< move_absolute32(State).
+	CmdSetPortA, ///< set_port_a(Value).
+	CmdSetUpdateRate, ///< set_update_rate(Period).
+	CmdCalibrate, ///< calibrate_update_rate().
+	CmdSetJogTimeout, ///< set_jog_timeout(Period).
+	CmdSetIdleTimeout, ///< set_idle_timeout() for every Timeout but IDLE_TIMEOUT_KEEP.
+	CmdSetDriveMode, ///< set_drive_mode() for every Mode but DRIVE_MODE_KEEP.
+	CmdSetLimits, ///< set_axis_limits(Limits.Axis, Limits.Value) of the MotionArgs_t slot.
+	CmdMoveUntilInput, ///< move_until_input(State, Probe.Mask, Probe.Level) of the MotionArgs_t slot.
+	CmdAddTrigger, ///< add_trigger(Trigger).
+	CmdClearTriggers, ///< clear_triggers().
+};
+
+/**
+ * @brief State of the probe move, as sent by the ProbeResult opcode.
+ * 
+ */
+enum ProbeStatus : uint8_t
+{
+	ProbeIdle = 0U, ///< No probe move since the start.
+	ProbeArmed, ///< Moving, the condition not seen yet.
+	ProbeTriggered, ///< The condition stopped the axes.
+	ProbeMissed, ///< The move ended without the condition.
+	ProbeAborted, ///< A stop or another move ended the probe.
+};
+
+/**
+ * @brief Where a Port A output trigger fires.
+ * 
+ */
+enum TriggerKinds : uint8_t
+{
+	TriggerStep = 0U, ///< Value is a step position of the axis.
+	TriggerFraction, ///< Value is the part of the axis travel of the move, in 1 / TRIGGER_FRACTION_ONE.
+};
+
+/**
+ * @brief How stop_motors() brings the axes to rest.
+ * 
+ */
+enum StopModes : uint8_t
+{
+	StopDecelerate = 0U, ///< Ramp down at the configured acceleration.
+	StopQuick, ///< Ramp down at EMERGENCY_ACCELERATION.
+	StopHard, ///< No further step, the coils hold the last pattern.
+	StopSegment, ///< Positioning moves finish at their target, the speed mode ramps down.
+};
+
+/**
+ * @brief Coil sequence of one axis.
+ * 
+ */
+enum DriveModes : uint8_t
+{
+	DriveFull = 0U, ///< Two coils on, one step is two half steps.
+	DriveHalf, ///< One or two coils on, one step is one half step.
+	DriveWave, ///< One coil on, one step is two half steps, half a step behind DriveFull.
+};
+
+/**
+ * @brief What accept_move() does with a target outside the soft limits.
+ * 
+ */
+enum LimitModes : uint8_t
+{
+	LimitReject = 0U, ///< Refuse the move.
+	LimitClamp, ///< Move to the soft limit instead.
+};
+
+enum OperationModes : uint8_t
+{
+	NONE = 0U,
+	Positioning,
+	Speed,
+};
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Control loop counters, as sent by the Stats opcode. */
+typedef struct __attribute__((packed))
+{
+	uint32_t Elapsed; ///< Time since the reset in ms.
+	uint32_t Updates; ///< Count of the update() calls, the loop() iterations.
+	uint32_t Slots; ///< Count of the served address slots.
+	uint16_t SlotTimeMean; ///< Mean time of the served slot in us.
+	uint16_t SlotTimeMax; ///< Longest served slot in us.
+	uint32_t Overruns; ///< Slots started later than twice the update rate.
+	uint32_t LateMax; ///< Longest delay of a slot over the update rate in us.
+} Robko01Stats_t;
+
+/** @brief Bus slot timing, as sent by the UpdateRate opcode. */
+typedef struct __attribute__((packed))
+{
+	uint32_t UpdateRate; ///< Slot period in us.
+	uint16_t SlotCost; ///< Longest slot of the last calibration in us, 0 if not calibrated.
+} Robko01Timing_t;
+
+/** @brief Speed override, as sent by the Override opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Global; ///< Global override in percent.
+	uint8_t Axis[AXIS_COUNT]; ///< Override of every axis in percent.
+	uint8_t Effective[AXIS_COUNT]; ///< Ramped override in effect in percent.
+} Robko01Override_t;
+
+/** @brief Hold current policy and use, as sent by the Hold opcode. */
+typedef struct __attribute__((packed))
+{
+	uint16_t IdleTimeout[AXIS_COUNT]; ///< Coils off after this many idle ms, 0 holds.
+	uint8_t Released; ///< Axes with the coils off, bit N is axis N.
+	uint32_t Energised; ///< Energised time summed over the axes in ms, wraps.
+} Robko01Hold_t;
+
+/** @brief Drive modes and bus speed limits, as sent by the DriveMode opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Mode[AXIS_COUNT]; ///< DriveModes value of every axis.
+	uint16_t MaxSpeed[AXIS_COUNT]; ///< One step per bus cycle, in half steps per second.
+} Robko01Drive_t;
+
+/** @brief Filtered edge of a Port A input, as sent by the PortAEvents opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Bit; ///< Input bit, 0 to 7.
+	uint8_t Level; ///< Level after the edge, 0 or 1.
+	uint32_t Time; ///< micros() of the first sample at the new level.
+} PortAEvent_t;
+
+/** @brief Result of the last probe move, as sent by the ProbeResult opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Status; ///< ProbeStatus value.
+	uint8_t PortA; ///< Port A inputs at the trigger.
+	uint32_t Time; ///< micros() of the trigger.
+	int32_t Position[AXIS_COUNT]; ///< Step count of every axis at the trigger.
+} Robko01Probe_t;
+
+/** @brief Port A output trigger, as sent by the Triggers opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Axis; ///< Axis that passes the position.
+	uint8_t Kind; ///< TriggerKinds value.
+	int32_t Value; ///< Step position or fraction of the move.
+	uint8_t Mask; ///< Port A output bits to set.
+	uint8_t Level; ///< Levels of the masked bits.
+} PortATrigger_t;
+
+/** @brief State of the Port A output triggers, as sent by the Triggers opcode. */
+typedef struct __attribute__((packed))
+{
+	uint8_t Pending; ///< Triggers for the next move.
+	uint8_t Armed; ///< Triggers of the move in flight not fired yet, bit N is entry N.
+	uint8_t Fired; ///< Triggers of the last move that fired, bit N is entry N.
+} Robko01Triggers_t;
+
+/** @brief Motion command, posted by the protocol side, executed at a slot boundary. */
+typedef struct
+{
+	uint8_t Type; ///< MotionCommands value.
+	uint8_t Value; ///< Port A value.
+	union
+	{
+		JointPosition_t Position; ///< Target of the 16 bit commands.
+		JointState32_t State; ///< Target of the 32 bit commands.
+		uint32_t Period; ///< Slot period of CmdSetUpdateRate in us, timeout of CmdSetJogTimeout in ms.
+		uint16_t Timeout[AXIS_COUNT]; ///< Idle timeouts of CmdSetIdleTimeout in ms.
+		uint8_t Mode[AXIS_COUNT]; ///< DriveModes values of CmdSetDriveMode.
+		PortATrigger_t Trigger; ///< Entry of CmdAddTrigger.
+	};
+} MotionCommand_t;
+
+/** @brief Arguments that would make every queue slot longer than a move, one slot beside the queue. */
+typedef union
+{
+	struct __attribute__((packed))
+	{
+		uint8_t Axis; ///< Axis of CmdSetLimits.
+		AxisLimits_t Value; ///< Limits of CmdSetLimits.
+	} Limits;
+	struct __attribute__((packed))
+	{
+		uint8_t Mask; ///< Port A bits of the condition of CmdMoveUntilInput.
+		uint8_t Level; ///< Levels of the masked bits that stop the move.
+	} Probe;
+} MotionArgs_t;
+
+/** @brief Robot state as of the end of one bus cycle, published by the slot side. */
+typedef struct
+{
+	uint8_t MotorState; ///< Motors state bits.
+	uint8_t PortA; ///< Port A input state.
+	uint8_t Executed; ///< Count of the executed commands, wraps.
+	uint8_t Released; ///< Axes with the coils off.
+	uint32_t Energised; ///< Energised time summed over the axes in ms.
+	JointState32_t State; ///< Positions and speeds of all joints.
+} RobotSnapshot_t;
+
+#pragma endregion
+
+class Robko01Class
+{
+
+    protected:
+
+#pragma region Variables
+
+    /**
+     * @brief Time now (current moment).
+     * 
+     */
+	unsigned long m_timeNow;
+
+    /**
+     * @brief Time before (last moment).
+     * 
+     */
+	unsigned long m_timePrev;
+
+    /**
+     * @brief Update rate.
+     * 
+     */
+    unsigned long m_updateRate;
+
+    /**
+     * @brief Longest slot of the last calibration in us.
+     * 
+     */
+    uint16_t m_slotCost;
+
+    /**
+     * @brief Motor enabled flag.
+     * 
+     */
+    bool m_motorsEnabled;
+
+    /**
+     * @brief Max speed the move asked for, before the override.
+     * 
+     */
+    float m_plannedSpeed[AXIS_COUNT];
+
+    /**
+     * @brief Max speed in effect, ramps to the overridden planned speed.
+     * 
+     */
+    float m_overrideSpeed[AXIS_COUNT];
+
+    /**
+     * @brief Global override in percent, written by any context.
+     * 
+     */
+    uint8_t m_overrideGlobal;
+
+    /**
+     * @brief Axis overrides in percent, written by any context.
+     * 
+     */
+    uint8_t m_overrideAxis[AXIS_COUNT];
+
+    /**
+     * @brief Ramped override in effect in percent, slot side.
+     * 
+     */
+    uint8_t m_overrideEffective[AXIS_COUNT];
+
+    /**
+     * @brief Speed mode setpoints in steps per second.
+     * 
+     */
+    float m_jogTarget[AXIS_COUNT];
+
+    /**
+     * @brief Speed mode speeds, ramped to the setpoints.
+     * 
+     */
+    float m_jogSpeed[AXIS_COUNT];
+
+    /**
+     * @brief Time of the last speed mode setpoint in us.
+     * 
+     */
+    unsigned long m_jogSetpointTime;
+
+    /**
+     * @brief Speed mode watchdog in ms, 0 is off.
+     * 
+     */
+    uint16_t m_jogTimeout;
+
+    /**
+     * @brief Axes ramping down at EMERGENCY_ACCELERATION, bit N is axis N.
+     * 
+     */
+    uint8_t m_quickStop;
+
+    /**
+     * @brief Idle time in ms before the coils of the axis go off, 0 holds.
+     * 
+     */
+    uint16_t m_idleTimeout[AXIS_COUNT];
+
+    /**
+     * @brief Time the axis had work last in us.
+     * 
+     */
+    unsigned long m_idleSince[AXIS_COUNT];
+
+    /**
+     * @brief Time of the last slot of the axis in us.
+     * 
+     */
+    unsigned long m_holdServed[AXIS_COUNT];
+
+    /**
+     * @brief Axes with the coils off, bit N is axis N.
+     * 
+     */
+    uint8_t m_released;
+
+    /**
+     * @brief Energised time summed over the axes in ms.
+     * 
+     */
+    uint32_t m_energised;
+
+    /**
+     * @brief Energised time below one ms in us.
+     * 
+     */
+    uint32_t m_energisedUs;
+
+    /**
+     * @brief DriveModes value of every axis.
+     * 
+     */
+    uint8_t m_driveMode[AXIS_COUNT];
+
+    /**
+     * @brief Half steps the coils lead the position by, a position reset keeps the rotor where it is.
+     * 
+     */
+    uint8_t m_phaseOffset[AXIS_COUNT];
+
+    /**
+     * @brief Kinematic limits of the axes, the only copy, written by the slot side, read in any context.
+     * 
+     */
+    Seqlock<RobotLimits_t> m_limits;
+
+    /**
+     * @brief LimitModes value, written by any context.
+     * 
+     */
+    uint8_t m_limitMode;
+
+    /**
+     * @brief Speed mode ramps to zero below this position, the soft minimum plus the stopping distance.
+     * 
+     */
+    long m_jogLow[AXIS_COUNT];
+
+    /**
+     * @brief Speed mode ramps to zero above this position, the soft maximum minus the stopping distance.
+     * 
+     */
+    long m_jogHigh[AXIS_COUNT];
+
+    /**
+     * @brief Bus configuration.
+     * 
+     */
+	BusConfig_t m_BusConfig;
+
+    /**
+     * @brief Port A input low 4 bits.
+     * 
+     */
+    uint8_t m_currentAddressIndex;
+
+    /**
+     * @brief Port A input low 4 bits.
+     * 
+     */
+    uint8_t m_portLoAIn;
+
+    /**
+     * @brief Port A input high 4 bits.
+     * 
+     */
+    uint8_t m_portHiAIn;
+
+    /**
+     * @brief Equal samples before each Port A input changes, written by any context.
+     * 
+     */
+    uint8_t m_portAFilter[PORT_A_BITS];
+
+    /**
+     * @brief Filtered Port A inputs.
+     * 
+     */
+    uint8_t m_portAStable;
+
+    /**
+     * @brief Nibbles sampled once, bit 0 low, bit 1 high, the first sample sets the state.
+     * 
+     */
+    uint8_t m_portASeeded;
+
+    /**
+     * @brief Samples in a row at the other level.
+     * 
+     */
+    uint8_t m_portACount[PORT_A_BITS];
+
+    /**
+     * @brief Time of the first sample at the other level.
+     * 
+     */
+    uint32_t m_portAEdgeAt[PORT_A_BITS];
+
+    /**
+     * @brief Filtered edges, the slot pushes, the protocol side drains.
+     * 
+     */
+    SPSCQueue<PortAEvent_t, PORT_A_EVENTS_SIZE> m_portAEvents;
+
+    /**
+     * @brief Edges dropped on a full queue, saturates at 255, slot side only.
+     * 
+     */
+    uint8_t m_portAEventsLost;
+
+    /**
+     * @brief Port A output.
+     * 
+     */
+    uint8_t m_portAOut;
+
+    /**
+     * @brief Motor states, does it active.
+     * 
+     */
+    uint8_t m_motorState;
+
+    /**
+     * @brief Operation mode.
+     * 
+     */
+    uint8_t m_operationMode;
+
+    /**
+     * @brief Create 6 stepper motors.
+     * 
+     */
+    AccelStepper m_steppers[AXIS_COUNT];
+
+    /**
+     * @brief Time of the stats reset in ms.
+     * 
+     */
+    unsigned long m_statsSince;
+
+    /**
+     * @brief Count of the update() calls.
+     * 
+     */
+    uint32_t m_statsUpdates;
+
+    /**
+     * @brief Count of the served slots.
+     * 
+     */
+    uint32_t m_statsSlots;
+
+    /**
+     * @brief Sum of the served slot times in us.
+     * 
+     */
+    uint32_t m_statsSlotTime;
+
+    /**
+     * @brief Count of the slots in m_statsSlotTime.
+     * 
+     */
+    uint32_t m_statsSlotSamples;
+
+    /**
+     * @brief Longest served slot in us.
+     * 
+     */
+    uint16_t m_statsSlotTimeMax;
+
+    /**
+     * @brief Count of the late slots.
+     * 
+     */
+    uint32_t m_statsOverruns;
+
+    /**
+     * @brief Longest slot delay in us.
+     * 
+     */
+    uint32_t m_statsLateMax;
+
+#ifdef ENABLE_BUS_TRACE
+    /**
+     * @brief Address on the bus, recorded with the strobes.
+     * 
+     */
+    uint8_t m_busAddress;
+
+    /**
+     * @brief Last DO nibble, recorded with the IOR strobes.
+     * 
+     */
+    uint8_t m_busDo;
+
+    /**
+     * @brief Bus transaction recorder.
+     * 
+     */
+    BusTraceClass m_busTrace;
+#endif
+
+    /**
+     * @brief Stop edges latched by the ISRs of the e-stop and limit inputs.
+     * 
+     */
+    StopInputsClass m_stopInputs;
+
+    /**
+     * @brief Commands from the protocol side, drained at the slot boundaries.
+     * 
+     */
+    SPSCQueue<MotionCommand_t, MOTION_COMMANDS_SIZE> m_commands;
+
+    /**
+     * @brief Arguments of the one posted CmdSetLimits or CmdMoveUntilInput.
+     * 
+     */
+    MotionArgs_t m_commandArgs;
+
+    /**
+     * @brief m_commandArgs holds a command not executed yet, set by the producer, cleared by the consumer.
+     * 
+     */
+    uint8_t m_commandArgsBusy;
 
-#pragma endregion
+    /**
+     * @brief Count of the posted commands, wraps, producer side only.
+     * 
+     */
+    uint8_t m_commandsPosted;
 
-class Robko01Class
-{
+    /**
+     * @brief Count of the executed commands, wraps, consumer side only.
+     * 
+     */
+    uint8_t m_commandsExecuted;
 
-    protected:
+    /**
+     * @brief Robot state of the last whole cycle, for readers in any context.
+     * 
+     */
+    Seqlock<RobotSnapshot_t> m_snapshot;
 
-#pragma region Variables
+#ifdef ENABLE_PROBE
+    /**
+     * @brief Port A bits of the armed probe condition.
+     * 
+     */
+    uint8_t m_probeMask;
 
     /**
-     * @brief Time now (current moment).
+     * @brief Levels of the masked bits that stop the probe move.
      * 
      */
-	unsigned long m_timeNow;
+    uint8_t m_probeLevel;
 
     /**
-     * @brief Time before (last moment).
+     * @brief Result of the last probe move, written by the slot side, read in any context.
      * 
      */
-	unsigned long m_timePrev;
+    Seqlock<Robko01Probe_t> m_probe;
+#endif
 
+#ifdef ENABLE_PORT_A_TRIGGERS
     /**
-     * @brief Update rate.
+     * @brief Triggers for the next move, slot side only.
      * 
      */
-    unsigned long m_updateRate;
+    PortATrigger_t m_triggers[PORT_A_TRIGGERS];
 
     /**
-     * @brief Motor enabled flag.
+     * @brief Triggers of the move in flight.
      * 
      */
-    bool m_motorsEnabled;
+    PortATrigger_t m_triggersMove[PORT_A_TRIGGERS];
 
     /**
-     * @brief Bus configuration.
+     * @brief Step position of every trigger of the move in flight.
      * 
      */
-	BusConfig_t m_BusConfig;
+    int32_t m_triggerStep[PORT_A_TRIGGERS];
 
     /**
-     * @brief Port A input low 4 bits.
+     * @brief Triggers that fire at or above their step, the others at or below.
      * 
      */
-    uint8_t m_currentAddressIndex;
+    uint8_t m_triggerAbove;
 
     /**
-     * @brief Port A input low 4 bits.
+     * @brief Count of m_triggers, written by the slot, read in any context.
      * 
      */
-    uint8_t m_portLoAIn;
+    uint8_t m_triggersPending;
 
     /**
-     * @brief Port A input high 4 bits.
+     * @brief Triggers of the move in flight not fired yet, written by the slot, read in any context.
      * 
      */
-    uint8_t m_portHiAIn;
+    uint8_t m_triggersArmed;
 
     /**
-     * @brief Port A output.
+     * @brief Triggers of the last move that fired, written by the slot, read in any context.
      * 
      */
-    uint8_t m_portAOut;
+    uint8_t m_triggersFired;
+#endif
 
     /**
-     * @brief Motor states, does it active.
+     * @brief Called after every served slot.
      * 
      */
-    uint8_t m_motorState;
+    void(*cbSlot)();
 
+#if defined(ESP32)
     /**
-     * @brief Operation mode.
+     * @brief Motion task, NULL while update() drives the bus.
      * 
      */
-    uint8_t m_operationMode;
+    TaskHandle_t m_task;
 
     /**
-     * @brief Create 6 stepper motors.
+     * @brief Periodic timer that wakes the motion task.
      * 
      */
-    AccelStepper m_steppers[AXIS_COUNT];
+    esp_timer_handle_t m_timer;
+#endif
 
 #pragma endregion
 
@@ -213,6 +1002,47 @@ class Robko01Class
      */
     void update_port_a(uint8_t address);
 
+    /** @brief Filter a Port A nibble and queue its edges.
+     *  @param nibble uint8_t, Sampled inputs.
+     *  @param first uint8_t, Bit of the lowest input of the nibble.
+     *  @return Void.
+     */
+    void filter_port_a(uint8_t nibble, uint8_t first);
+
+#ifdef ENABLE_PROBE
+    /** @brief Check the armed probe against Port A, stop the axes in this slot when it matches.
+     *  @return Void.
+     */
+    void update_probe();
+
+    /** @brief End the probe move if it is armed.
+     *  @param status uint8_t, ProbeStatus value.
+     *  @return Void.
+     */
+    void end_probe(uint8_t status);
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+    /** @brief Fire the triggers whose axis passed its step, once per bus cycle after the axis slots.
+     *  @return Void.
+     */
+    void update_triggers();
+
+    /** @brief Move the pending triggers to the move that starts, with the fractions as steps.
+     *  @return Void.
+     */
+    void arm_triggers();
+#endif
+
+    /** @brief Whether a pressed stop input refuses the axis to move this way.
+     *  @param address uint8_t, Axis.
+     *  @param distance long, Sign is the direction of the move.
+     *  @param up uint8_t, Axes refused in the positive direction.
+     *  @param down uint8_t, Axes refused in the negative direction.
+     *  @return bool, True if refused.
+     */
+    bool inhibits(uint8_t address, long distance, uint8_t up, uint8_t down);
+
     /** @brief Set address bus.
      *  @param uint8_t address, Address bus value.
      *  @return Void.
@@ -246,24 +1076,390 @@ class Robko01Class
      */
     void write_di(uint8_t data);
 
+    /** @brief Serve the current address slot, m_timeNow is the slot start.
+     *  @return Void.
+     */
+    void update_slot();
+
+    /** @brief Set the max speed of a move, the override scales it.
+     *  @param address uint8_t, Axis.
+     *  @param speed float, Max speed in steps per second.
+     *  @return Void.
+     */
+    void plan_max_speed(uint8_t address, float speed);
+
+    /** @brief Ramp the max speed of the axis to the overridden planned speed,
+     *  no faster than the axis decelerates in one bus cycle.
+     *  @param address uint8_t, Axis.
+     *  @return Void.
+     */
+    void update_override(uint8_t address);
+
+    /** @brief Override of the axis, the global one times the axis one.
+     *  @param address uint8_t, Axis.
+     *  @return uint16_t, Override in percent.
+     */
+    uint16_t override_percent(uint8_t address);
+
+    /** @brief Ramp the speed mode speed of the axis to its setpoint and step.
+     *  @param address uint8_t, Axis.
+     *  @return bool, True while the axis moves.
+     */
+    bool update_jog(uint8_t address);
+
+    /** @brief Give the axis its configured acceleration back after a quick stop.
+     *  @param address uint8_t, Axis.
+     *  @return Void.
+     */
+    void end_quick_stop(uint8_t address);
+
+    /** @brief Stop the axis before its next step, target, speed and ramp to rest.
+     *  @param address uint8_t, Axis.
+     *  @return Void.
+     */
+    void hard_stop(uint8_t address);
+
+    /** @brief Count the energised time of the axis and switch its coils off or back on.
+     *  @param address uint8_t, Axis.
+     *  @return bool, True if this slot of the axis is spent, the coils are written.
+     */
+    bool update_hold(uint8_t address);
+
+    /** @brief Axis has a move or speed to run.
+     *  @param address uint8_t, Axis.
+     *  @return bool, True if the axis has work.
+     */
+    bool axis_busy(uint8_t address);
+
+    /** @brief Coils of the current step of the axis in its drive mode.
+     *  @param address uint8_t, Axis.
+     *  @return uint8_t, Coil mask, bit N energises the coil on DIN.
+     */
+    uint8_t coil_mask(uint8_t address);
+
+    /** @brief Electrical position of the coils of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return uint8_t, 0 .. 7 on the half step circle.
+     */
+    uint8_t coil_phase(uint8_t address);
+
+    /** @brief Keep the coils at a phase after the position or the drive mode changed.
+     *  @param address uint8_t, Axis.
+     *  @param phase uint8_t, coil_phase() before the change.
+     *  @return Void.
+     */
+    void keep_phase(uint8_t address, uint8_t phase);
+
+    /** @brief Half steps of one step of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return uint8_t, 1 or 2.
+     */
+    uint8_t half_steps_per_step(uint8_t address);
+
+    /** @brief Speed limit of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return float, Steps per second.
+     */
+    float max_speed(uint8_t address);
+
+    /** @brief Acceleration limit of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return float, Steps per second squared.
+     */
+    float max_acceleration(uint8_t address);
+
+    /** @brief Acceleration of the speed mode ramp of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return float, Steps per second squared.
+     */
+    float jog_acceleration(uint8_t address);
+
+    /** @brief Pull a target into the soft limits of the axis.
+     *  @param address uint8_t, Axis.
+     *  @param position long, Target in steps.
+     *  @return long, Target within the limits.
+     */
+    long soft_clamp(uint8_t address, long position);
+
+    /** @brief Brake points of the speed mode for the setpoint of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return Void.
+     */
+    void plan_jog_brake(uint8_t address);
+
+    /** @brief Drive the bus for the current address and step to the next one.
+     *  @return Void.
+     */
+    void serve_address();
+
+    /** @brief Execute one motion command.
+     *  @param command MotionCommand_t, Command.
+     *  @return Void.
+     */
+    void execute_command(const MotionCommand_t &command);
+
+    /** @brief Publish the robot state, slot side.
+     *  @return Void.
+     */
+    void publish_snapshot();
+
+#if defined(ESP32)
+    /** @brief Body of the motion task.
+     *  @param parameter void *, Robko01Class instance.
+     *  @return Void.
+     */
+    static void motion_task(void * parameter);
+
+    /** @brief esp_timer callback, wakes the motion task.
+     *  @param parameter void *, Robko01Class instance.
+     *  @return Void.
+     */
+    static void motion_timer(void * parameter);
+#endif
+
 #pragma endregion
 
     public:
 
 #pragma region Methods
 
+    Robko01Class();
+
     void init(BusConfig_t* config);
 
 	void update();
 
+    /** @brief Set the slot callback, runs in the context that serves the bus.
+     *  @param callback, Callback pointer.
+     *  @return Void.
+     */
+    void setCbSlot(void(*callback)());
+
+#if defined(ESP32)
+    /** @brief Serve the bus from a pinned task woken every update rate, update() does nothing after it.
+     *  @param core uint8_t, Core of the task.
+     *  @param priority uint8_t, FreeRTOS priority of the task.
+     *  @return bool, True if the task and the timer are running.
+     */
+    bool start_task(uint8_t core = MOTION_TASK_CORE, uint8_t priority = MOTION_TASK_PRIORITY);
+
+    /** @brief Motion task flag.
+     *  @return bool, True while the task serves the bus.
+     */
+    bool task_running();
+#endif
+
+    /** @brief Set the bus slot period.
+     *  @param rate uint32_t, Period in us, clamped to UPDATE_RATE_MIN and UPDATE_RATE_MAX.
+     *  @return Void.
+     */
+    void set_update_rate(uint32_t rate);
+
+    /** @brief Bus slot period.
+     *  @return uint32_t, Period in us.
+     */
+    uint32_t get_update_rate();
+
+    /** @brief Serve whole bus cycles back to back, measure the longest slot
+     *  and set the period to CALIBRATION_MARGIN times that. Call it from the
+     *  context that serves the bus, or post CmdCalibrate.
+     *  @param cycles uint8_t, Bus cycles to measure.
+     *  @return uint32_t, New period in us.
+     */
+    uint32_t calibrate_update_rate(uint8_t cycles = CALIBRATION_CYCLES);
+
+    /** @brief Slot period and the cost measured by the last calibration.
+     *  @return Robko01Timing_t, Timing.
+     */
+    Robko01Timing_t get_timing();
+
+    /** @brief Set the global speed override, the moves in flight follow it
+     *  without re-planning. Safe from any context, it never waits.
+     *  @param percent uint8_t, Override, OVERRIDE_MIN to OVERRIDE_MAX.
+     *  @return Void.
+     */
+    void set_override(uint8_t percent);
+
+    /** @brief Set the speed override of one axis, on top of the global one.
+     *  @param address uint8_t, Axis.
+     *  @param percent uint8_t, Override, OVERRIDE_MIN to OVERRIDE_MAX.
+     *  @return Void.
+     */
+    void set_axis_override(uint8_t address, uint8_t percent);
+
+    /** @brief Speed overrides, set and in effect.
+     *  @return Robko01Override_t, Overrides.
+     */
+    Robko01Override_t get_override();
+
+    /** @brief Set the idle time after which the coils of the axis go off, they come back on the next move.
+     *  @param address uint8_t, Axis.
+     *  @param timeout uint16_t, Timeout in ms, 0 holds the axis.
+     *  @return Void.
+     */
+    void set_idle_timeout(uint8_t address, uint16_t timeout);
+
+    /** @brief Idle timeout of the axis.
+     *  @param address uint8_t, Axis.
+     *  @return uint16_t, Timeout in ms, 0 if held.
+     */
+    uint16_t get_idle_timeout(uint8_t address);
+
+    /** @brief Hold policy, released axes and energised time of the snapshot.
+     *  @return Robko01Hold_t, Hold state.
+     */
+    Robko01Hold_t get_hold();
+
+    /** @brief Set the coil sequence of an idle axis, the position keeps the shaft angle in the new steps.
+     *  @param address uint8_t, Axis.
+     *  @param mode uint8_t, DriveModes value.
+     *  @return bool, False if the axis moves or the mode is unknown.
+     */
+    bool set_drive_mode(uint8_t address, uint8_t mode);
+
+    /** @brief Drive modes and the speed limit of the bus in half steps.
+     *  @return Robko01Drive_t, Drive state.
+     */
+    Robko01Drive_t get_drive();
+
+    /** @brief Set the kinematic limits and the drive mode of an idle axis, the planner clamps every move to them.
+     *  @param address uint8_t, Axis.
+     *  @param limits AxisLimits_t, Limits, zero speed or acceleration takes the default.
+     *  @return bool, False if the axis moves or the limits are invalid.
+     */
+    bool set_axis_limits(uint8_t address, const AxisLimits_t &limits);
+
+    /** @brief Kinematic limits of the axis in effect, safe from any context.
+     *  @param address uint8_t, Axis.
+     *  @return AxisLimits_t, Limits, in the steps of the drive mode.
+     */
+    AxisLimits_t get_axis_limits(uint8_t address);
+
+    /** @brief Kinematic limits of all axes in effect, safe from any context.
+     *  @return RobotLimits_t, Limits, in the steps of the drive modes.
+     */
+    RobotLimits_t get_limits();
+
+    /** @brief Check a move against the soft limits before it is posted, safe from any context.
+     *  Relative moves add to the snapshot position. In LimitClamp mode the
+     *  targets outside are pulled to the limits.
+     *  @param type uint8_t, MotionCommands value of the move.
+     *  @param state JointState32_t, Move, clamped in place.
+     *  @return bool, False if a target is outside and the mode is LimitReject.
+     */
+    bool accept_move(uint8_t type, JointState32_t &state);
+
+    /** @brief Check a 16 bit move against the soft limits before it is posted.
+     *  @param type uint8_t, MotionCommands value of the move.
+     *  @param position JointPosition_t, Move, clamped in place.
+     *  @return bool, False if a target is outside and the mode is LimitReject.
+     */
+    bool accept_move(uint8_t type, JointPosition_t &position);
+
+    /** @brief Check a move against the pressed stop inputs before it is posted, safe from any context.
+     *  Relative moves and the speed mode go by the sign, absolute moves by the snapshot position.
+     *  The slot leaves the refused axes where they are too.
+     *  @param type uint8_t, MotionCommands value of the move.
+     *  @param state JointState32_t, Move.
+     *  @return bool, True if an axis would move toward a pressed input.
+     */
+    bool inhibited(uint8_t type, const JointState32_t &state);
+
+    /** @brief Check a 16 bit move against the pressed stop inputs before it is posted.
+     *  @param type uint8_t, MotionCommands value of the move.
+     *  @param position JointPosition_t, Move.
+     *  @return bool, True if an axis would move toward a pressed input.
+     */
+    bool inhibited(uint8_t type, const JointPosition_t &position);
+
+    /** @brief Set what accept_move() does with a target outside the soft limits.
+     *  @param mode uint8_t, LimitModes value.
+     *  @return Void.
+     */
+    void set_limit_mode(uint8_t mode);
+
+    /** @brief What accept_move() does with a target outside the soft limits.
+     *  @return uint8_t, LimitModes value.
+     */
+    uint8_t get_limit_mode();
+
     bool motors_enabled();
 
+    /** @brief Motors state bits of the snapshot, MOTOR_STATE_PENDING until it shows the posted commands.
+     *  @return uint8_t, State bits.
+     */
     uint8_t get_motor_state();
 
-    /** @brief Stop all motors.
+    /** @brief Robot state as of the last whole bus cycle, never torn.
+     *  @return RobotSnapshot_t, State.
+     */
+    RobotSnapshot_t get_snapshot();
+
+    /** @brief Queue a motion command, safe from one other task, core or ISR.
+     *  The move and stop methods below change the steppers directly and
+     *  belong to the context that calls update().
+     *  @param command MotionCommand_t, Command.
+     *  @return bool, False if the queue is full.
+     */
+    bool post(const MotionCommand_t &command);
+
+    /** @brief Queue a command without arguments or with a Port A value.
+     *  @param type uint8_t, MotionCommands value.
+     *  @param value uint8_t, Port A value.
+     *  @return bool, False if the queue is full.
+     */
+    bool post(uint8_t type, uint8_t value = 0);
+
+    /** @brief Queue a 16 bit motion command.
+     *  @param type uint8_t, MotionCommands value.
+     *  @param position JointPosition_t, Target.
+     *  @return bool, False if the queue is full.
+     */
+    bool post(uint8_t type, const JointPosition_t &position);
+
+    /** @brief Queue a 32 bit motion command.
+     *  @param type uint8_t, MotionCommands value.
+     *  @param state JointState32_t, Target.
+     *  @return bool, False if the queue is full.
+     */
+    bool post(uint8_t type, const JointState32_t &state);
+
+    /** @brief Queue CmdSetLimits, the limits wait in the one argument slot.
+     *  @param address uint8_t, Axis.
+     *  @param limits AxisLimits_t, Limits.
+     *  @return bool, False if the queue is full or the slot holds a command not executed yet.
+     */
+    bool post(uint8_t address, const AxisLimits_t &limits);
+
+    /** @brief Queue CmdMoveUntilInput, the condition waits in the one argument slot.
+     *  @param state JointState32_t, Target and speeds.
+     *  @param mask uint8_t, Port A bits of the condition.
+     *  @param level uint8_t, Levels of the masked bits that stop the move.
+     *  @return bool, False if the queue is full or the slot holds a command not executed yet.
+     */
+    bool post(const JointState32_t &state, uint8_t mask, uint8_t level);
+
+    /** @brief Count of the posted commands not executed yet, producer side.
+     *  @return uint8_t, Count.
+     */
+    uint8_t commands_pending();
+
+    /** @brief Count of the executed commands, wraps at 256.
+     *  @return uint8_t, Count.
+     */
+    uint8_t commands_executed();
+
+    /** @brief Count of the posted commands, wraps at 256.
+     *  @return uint8_t, Count.
+     */
+    uint8_t commands_posted();
+
+    /** @brief Stop all motors at once, in the calling context, the slot side.
+     *  Other contexts post CmdStop instead.
+     *  @param mode uint8_t, StopModes value.
      *  @return Void.
      */
-    void stop_motors();
+    void stop_motors(uint8_t mode = StopModes::StopDecelerate);
 
     /** @brief Disable all motors.
      *  @return Void.
@@ -292,32 +1488,150 @@ class Robko01Class
      */
     void move_absolute(JointPosition_t position);
 
-    /** @brief Move by speed.
-     *  @param position JointPosition_t, robot position.
+    /** @brief Move by speed, ramped at JOG_ACCELERATION. Each call feeds
+     *  the watchdog, without a new one in the jog timeout all axes ramp to zero.
+     *  @param position JointPosition_t, Speeds in steps per second.
      *  @return Void.
      */
     void move_speed(JointPosition_t position);
 
-    /** @brief Move by speed.
+    /** @brief Set the speed mode watchdog.
+     *  @param timeout uint16_t, Timeout in ms, 0 turns it off.
+     *  @return Void.
+     */
+    void set_jog_timeout(uint16_t timeout);
+
+    /** @brief Speed mode watchdog.
+     *  @return uint16_t, Timeout in ms, 0 if off.
+     */
+    uint16_t get_jog_timeout();
+
+    /** @brief Get the robot position of the snapshot.
      *  @return JointPosition_t, current robot position.
      */
     JointPosition_t get_position();
 
+    /** @brief Move relatively to position, 32 bit version.
+     *  @param state JointState32_t, robot state.
+     *  @return Void.
+     */
+    void move_relative32(const JointState32_t &state);
+
+    /** @brief Move absolutely to position, 32 bit version.
+     *  @param state JointState32_t, robot state.
+     *  @return Void.
+     */
+    void move_absolute32(const JointState32_t &state);
+
+#ifdef ENABLE_PROBE
+    /** @brief Move absolutely until the masked Port A inputs match, then stop in that slot.
+     *  Move slow enough to stop at once, the result keeps the step count at the trigger.
+     *  @param state JointState32_t, Target and speeds.
+     *  @param mask uint8_t, Port A bits of the condition.
+     *  @param level uint8_t, Levels of the masked bits that stop the move.
+     *  @return bool, False on an empty mask.
+     */
+    bool move_until_input(const JointState32_t &state, uint8_t mask, uint8_t level);
+
+    /** @brief Result of the last probe move.
+     *  @return Robko01Probe_t, Status and positions at the trigger.
+     */
+    Robko01Probe_t get_probe();
+#endif
+
+#ifdef ENABLE_PORT_A_TRIGGERS
+    /** @brief Add a Port A output trigger to the next move.
+     *  The entries arm when the next positioning move starts and fire in the bus cycle
+     *  in which the axis reaches the step, a later move or a stop drops the rest.
+     *  @param trigger PortATrigger_t, Entry.
+     *  @return bool, False if the entry is not valid or PORT_A_TRIGGERS are pending.
+     */
+    bool add_trigger(const PortATrigger_t &trigger);
+
+    /** @brief Drop the pending triggers and the ones of the move in flight.
+     *  @return Void.
+     */
+    void clear_triggers();
+
+    /** @brief State of the Port A output triggers.
+     *  @return Robko01Triggers_t, Pending count, armed and fired entries.
+     */
+    Robko01Triggers_t get_triggers();
+#endif
+
+    /** @brief Get the robot state of the snapshot without truncation.
+     *  @return JointState32_t, current robot state.
+     */
+    JointState32_t get_state32();
+
     /** @brief Set Port A of the robot.
      *  @param uint8_t value, Value of the port.
      *  @return Void.
      */
     void set_port_a(uint8_t value);
 
-    /** @brief Get Port A of the robot.
+    /** @brief Get Port A of the snapshot.
      *  @return uint8_t, Port A input state.
      */
     uint8_t get_port_a();
 
+    /** @brief Set the digital filter of a Port A input.
+     *  @param bit uint8_t, Input bit.
+     *  @param samples uint8_t, Equal samples, one per bus cycle, before the input changes, 0 or 1 takes every change.
+     *  @return Void.
+     */
+    void set_port_a_filter(uint8_t bit, uint8_t samples);
+
+    /** @brief Get the digital filter of a Port A input.
+     *  @param bit uint8_t, Input bit.
+     *  @return uint8_t, Equal samples before the input changes.
+     */
+    uint8_t get_port_a_filter(uint8_t bit);
+
+    /** @brief Drain the filtered Port A edges, oldest first.
+     *  @param events PortAEvent_t *, Output.
+     *  @param size uint8_t, Room in the output.
+     *  @return uint8_t, Count of the events.
+     */
+    uint8_t read_port_a_events(PortAEvent_t * events, uint8_t size);
+
+    /** @brief Edges dropped on a full queue since the init.
+     *  @return uint8_t, Count, saturates at 255.
+     */
+    uint8_t get_port_a_events_lost();
+
+    /** @brief Get the control loop counters.
+     *  @return Robko01Stats_t, Counters since the last reset.
+     */
+    Robko01Stats_t get_stats();
+
+    /** @brief Reset the control loop counters.
+     *  @return Void.
+     */
+    void reset_stats();
+
+#ifdef ENABLE_BUS_TRACE
+    /** @brief Bus transaction recorder.
+     *  @return BusTraceClass &, Recorder.
+     */
+    BusTraceClass & bus_trace();
+#endif
+
+    /** @brief Stop inputs, the ISRs of the e-stop and limit inputs latch() into it.
+     *  The axes stop hard at their next slot, before another step.
+     *  @return StopInputsClass &, Inputs and their latency counters.
+     */
+    StopInputsClass & stop_inputs();
+
 #pragma endregion
 
 };
 
+#if defined(__AVR__)
+// 2 KB of SRAM, SUPER, the serial buffers and the stack share the rest.
+static_assert(sizeof(Robko01Class) <= ROBKO01_RAM_BUDGET, "Robko01Class outgrew ROBKO01_RAM_BUDGET");
+#endif
+
 /** @brief Instance of the Robko01 robot. */
 extern Robko01Class Robko01;
 
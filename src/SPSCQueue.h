@@ -0,0 +1,146 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// SPSCQueue.h
+
+/*
+	Single producer, single consumer ring. push() only writes the head,
+	pop() only writes the tail, so one side may be an ISR or the other
+	core and neither side takes a lock or waits. One slot stays empty to
+	tell full from empty.
+*/
+
+#ifndef _SPSCQUEUE_h
+#define _SPSCQUEUE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+template<typename T, uint8_t SIZE>
+class SPSCQueue
+{
+
+	static_assert((SIZE >= 2) && ((SIZE & (SIZE - 1)) == 0), "SIZE must be a power of two");
+
+	protected:
+
+#pragma region Variables
+
+	/** @brief Items, SIZE - 1 of them usable. */
+	T m_items[SIZE];
+
+	/** @brief Next slot to write, only the producer stores it. */
+	uint8_t m_head;
+
+	/** @brief Next slot to read, only the consumer stores it. */
+	uint8_t m_tail;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	SPSCQueue() : m_head(0), m_tail(0) {}
+
+	/** @brief Add an item, producer side.
+	 *  @param item T, Item to copy in.
+	 *  @return bool, False if the queue is full.
+	 */
+	bool push(const T &item)
+	{
+		uint8_t HeadL = m_head;
+		uint8_t NextL = (uint8_t)((HeadL + 1) & (SIZE - 1));
+
+		if (NextL == __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE))
+		{
+			return false;
+		}
+
+		m_items[HeadL] = item;
+
+		// The item is complete before the consumer can see it.
+		__atomic_store_n(&m_head, NextL, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	/** @brief Take the oldest item, consumer side.
+	 *  @param item T, Output.
+	 *  @return bool, False if the queue is empty.
+	 */
+	bool pop(T &item)
+	{
+		uint8_t TailL = m_tail;
+
+		if (TailL == __atomic_load_n(&m_head, __ATOMIC_ACQUIRE))
+		{
+			return false;
+		}
+
+		item = m_items[TailL];
+
+		// The slot is read out before the producer can reuse it.
+		__atomic_store_n(&m_tail, (uint8_t)((TailL + 1) & (SIZE - 1)), __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	/** @brief Count of the queued items, exact only on the consumer side.
+	 *  @return uint8_t, Count.
+	 */
+	uint8_t count() const
+	{
+		return (uint8_t)((__atomic_load_n(&m_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE)) & (SIZE - 1));
+	}
+
+	/** @brief Empty flag.
+	 *  @return bool, True if nothing is queued.
+	 */
+	bool empty() const
+	{
+		return (count() == 0);
+	}
+
+	/** @brief Drop the queued items, consumer side.
+	 *  @return Void.
+	 */
+	void clear()
+	{
+		__atomic_store_n(&m_tail, __atomic_load_n(&m_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+	}
+
+	/** @brief Usable slots.
+	 *  @return uint8_t, SIZE - 1.
+	 */
+	static uint8_t capacity()
+	{
+		return SIZE - 1;
+	}
+
+#pragma endregion
+
+};
+
+#endif
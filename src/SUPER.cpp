@@ -118,7 +118,7 @@ bool SUPERClass::validate_frame(uint8_t * frame, uint8_t length)
 		return false;
 	}
 
-	// If frame is less the minimal lent of 32 directly exit.
+	// If frame is longer than the maximum length directly exit.
 	if (length > FRAME_MAX_LEN)
 	{
 		return false;
@@ -231,8 +231,36 @@ void SUPERClass::parse_frame(uint8_t * frame, uint8_t length)
 		{
 			get_payload(frame, length, m_payloadRequest);
 
+			uint8_t OpCodeL = frame[FrameIndexes::OperationCode];
+#ifdef SUPER_OPCODE_STATS
+			unsigned long StartL = micros();
+#endif
+
 			// cbRequest(frame[FrameIndexes::OperationCode], length, m_payloadRequest);
-			cbRequest(frame[FrameIndexes::OperationCode], frame[FrameIndexes::Length], m_payloadRequest);
+			cbRequest(OpCodeL, frame[FrameIndexes::Length], m_payloadRequest);
+
+			m_stats.Frames++;
+#ifdef SUPER_OPCODE_STATS
+			unsigned long TimeL = micros() - StartL;
+			if (TimeL > 0xFFFF)
+			{
+				TimeL = 0xFFFF;
+			}
+			if (OpCodeL >= SUPER_STATS_OPCODES)
+			{
+				OpCodeL = SUPER_STATS_OPCODES - 1;
+			}
+			// Keep the mean exact, stop counting when the count saturates.
+			if (m_opcodeCount[OpCodeL] < 0xFFFF)
+			{
+				m_opcodeCount[OpCodeL]++;
+				m_opcodeTime[OpCodeL] += TimeL;
+			}
+			if (TimeL > m_opcodeTimeMax[OpCodeL])
+			{
+				m_opcodeTimeMax[OpCodeL] = (uint16_t)TimeL;
+			}
+#endif
 		}
 	}
 	else if (frame[FrameIndexes::FrmType] == FrameType::Response)
@@ -271,6 +299,10 @@ void SUPERClass::read_frame() {
 	while (m_port->available() > 0)
 	{
 		InByteL = m_port->read();
+		m_stats.Bytes++;
+#ifdef SUPER_TRACE
+		uint8_t EventL = FrameTraceEvents::EventByte;
+#endif
 
 		switch (CommStateL)
 		{
@@ -279,10 +311,6 @@ void SUPERClass::read_frame() {
 			{
 				m_frameBuffer[FrameIndexes::Sentinel] = InByteL;
 				CommStateL = fsRequestResponse;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsSentinel -> fsRequestResponse\r\n");
-				DEBUGLOG("Sentinel: %02X (%d)\r\n", InByteL, InByteL);
-#endif
 			}
 			break;
 
@@ -293,36 +321,28 @@ void SUPERClass::read_frame() {
 			{
 				m_frameBuffer[FrameIndexes::FrmType] = InByteL;
 				CommStateL = fsLength;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsRequestResponse -> fsLength\r\n");
-				DEBUGLOG("FrmType: %02X (%d)\r\n", InByteL, InByteL);
-#endif
 			}
 			else
 			{
 				CommStateL = fsSentinel;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsRequestResponse -> fsSentinel\r\n");
+#ifdef SUPER_TRACE
+				EventL = FrameTraceEvents::EventReject;
 #endif
 			}
 			break;
 
 		case fsLength:
 			if ((InByteL >= 1) &&
-				(InByteL <= 27))
+				(InByteL <= (FRAME_MAX_DATA_LEN + 1)))
 			{
 				m_frameBuffer[FrameIndexes::Length] = InByteL;
 				CommStateL = fsOperationCode;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsLength -> fsOperationCode\r\n");
-				DEBUGLOG("Length: %02X (%d)\r\n", InByteL, InByteL);
-#endif
 			}
 			else
 			{
 				CommStateL = fsSentinel;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsLength -> fsSentinel\r\n");
+#ifdef SUPER_TRACE
+				EventL = FrameTraceEvents::EventReject;
 #endif
 			}
 			break;
@@ -333,34 +353,21 @@ void SUPERClass::read_frame() {
 			{
 				TemporalDataLengthL = m_frameBuffer[FrameIndexes::Length] - 1;
 				CommStateL = fsData;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsOperationCode -> fsData\r\n");
-				DEBUGLOG("OpCode: %02X (%d)\r\n", InByteL, InByteL);
-#endif
 			}
 			else
 			{
 				TemporalDataLengthL = FRAME_CRC_LEN;
 				CommStateL = fsCRC;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsOperationCode -> fsCRC\r\n");
-#endif
 			}
 			m_ptrFrameBuffer = &m_frameBuffer[FRAME_REQUEST_STATIC_FIELD_SIZE];
 			break;
 
 		case fsData:
 			*m_ptrFrameBuffer++ = InByteL;
-#ifdef SHOW_STATES
-			DEBUGLOG("Data: %02X (%d)\r\n", InByteL, InByteL);
-#endif
 			if (--TemporalDataLengthL == 0)
 			{
 				TemporalDataLengthL = FRAME_CRC_LEN;
 				CommStateL = fsCRC;
-#ifdef SHOW_STATES
-				DEBUGLOG("fsData -> fsCRC\r\n");
-#endif
 			}
 			break;
 
@@ -368,30 +375,35 @@ void SUPERClass::read_frame() {
 			*m_ptrFrameBuffer++ = InByteL;
 			if (--TemporalDataLengthL == 0)
 			{
-#ifdef SHOW_STATES
-				for (uint8_t index = 0; index < m_frameBuffer[FrameIndexes::Length] + 5; index++)
-				{
-					DEBUGLOG("%02X ", m_frameBuffer[index]);
-				}
-				DEBUGLOG("\r\n");
-#endif
+				CommStateL = fsSentinel;
 				if (validate_CRC(m_frameBuffer, m_frameBuffer[FrameIndexes::Length] + FRAME_REQUEST_STATIC_FIELD_SIZE - 1 + FRAME_CRC_LEN))
 				{
+#ifdef SUPER_TRACE
+					// Before the dispatch, the handler time shows in the next delta.
+					m_trace.record(micros(), CommStateL, FrameTraceEvents::EventFrame, InByteL);
+#endif
 					parse_frame(m_frameBuffer, m_frameBuffer[FrameIndexes::Length] + FRAME_REQUEST_STATIC_FIELD_SIZE - 1);
+#ifdef SUPER_TRACE
+					continue;
+#endif
 				}
 				else
 				{
-#ifdef SHOW_STATES
-					DEBUGLOG("Invalid CRC\r\n");
+					m_stats.CRCErrors++;
+#ifdef SUPER_TRACE
+					EventL = FrameTraceEvents::EventCRCError;
 #endif
 				}
-				CommStateL = fsSentinel;
 			}
 			break;
 
 		default:
 			break;
 		}
+
+#ifdef SUPER_TRACE
+		m_trace.record(micros(), CommStateL, EventL, InByteL);
+#endif
 	}
 }
 
@@ -401,8 +413,11 @@ void SUPERClass::read_frame() {
  */
 SUPERClass::SUPERClass()
 {
+	m_port = nullptr;
+	cbRequest = nullptr;
 	m_previousMillis = 0;
 	m_currentMillis = 0;
+	reset_stats();
 }
 
 /**
@@ -417,22 +432,11 @@ void SUPERClass::init(Stream &port) {
 	DEBUGLOG("\r\n");
 #endif
 
-#ifdef ARDUINO_ARCH_ESP32
-
 	if (&port == m_port)
 	{
 		return;
 	}
 
-#else
-
-	if (&port == &m_port)
-	{
-		return;
-	}
-
-#endif
-
 
 	m_port = &port;
 }
@@ -456,6 +460,79 @@ void SUPERClass::update() {
 	}
 }
 
+/** @brief Get the parser counters.
+ *  @return SUPERStats_t, Counters since the last reset.
+ */
+SUPERStats_t SUPERClass::get_stats() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif
+
+	return m_stats;
+}
+
+#ifdef SUPER_OPCODE_STATS
+/** @brief Get the handler time of one operation code.
+ *  @param opcode uint8_t, Operation code, the last slot holds all above it.
+ *  @return SUPEROpcodeStats_t, Counters since the last reset.
+ */
+SUPEROpcodeStats_t SUPERClass::get_opcode_stats(uint8_t opcode) {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif
+
+	SUPEROpcodeStats_t StatsL;
+
+	if (opcode >= SUPER_STATS_OPCODES)
+	{
+		opcode = SUPER_STATS_OPCODES - 1;
+	}
+
+	StatsL.Count = m_opcodeCount[opcode];
+	StatsL.TimeMean = (m_opcodeCount[opcode] == 0) ? 0 : (uint16_t)(m_opcodeTime[opcode] / m_opcodeCount[opcode]);
+	StatsL.TimeMax = m_opcodeTimeMax[opcode];
+
+	return StatsL;
+}
+#endif
+
+/** @brief Reset the parser and handler counters.
+ *  @return Void.
+ */
+void SUPERClass::reset_stats() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif
+
+	memset(&m_stats, 0, sizeof(m_stats));
+#ifdef SUPER_OPCODE_STATS
+	memset(m_opcodeCount, 0, sizeof(m_opcodeCount));
+	memset(m_opcodeTimeMax, 0, sizeof(m_opcodeTimeMax));
+	memset(m_opcodeTime, 0, sizeof(m_opcodeTime));
+#endif
+}
+
+#ifdef SUPER_TRACE
+/** @brief Parser state recorder.
+ *  @return FrameTraceClass &, Recorder.
+ */
+FrameTraceClass & SUPERClass::trace() {
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif
+
+	return m_trace;
+}
+#endif
+
 /** @brief Set the callback.
  *  @param callback, Callback pointer.
  *  @return Void.
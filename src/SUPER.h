@@ -32,7 +32,14 @@
 
 #pragma region Definitions
 
-// #define SHOW_STATES
+// Record the parser states into a FrameTraceClass ring.
+// #define SUPER_TRACE
+
+// Handler time per operation code, left out of the 2 KB AVR parts,
+// -D SUPER_OPCODE_STATS builds it in there.
+#if !defined(__AVR__)
+#define SUPER_OPCODE_STATS
+#endif
 
 /** @brief Communication port update rate. */
 #define UPDATE_RATE 1
@@ -40,11 +47,13 @@
 /** @brief Minimum frame length. */
 #define FRAME_MIN_LEN 6
 
-/** @brief Maximum frame length. */
-#define FRAME_MAX_LEN 32
+/** @brief Maximum frame length, fits the 48 bytes of JointState32_t. */
+#ifndef FRAME_MAX_LEN
+#define FRAME_MAX_LEN 56
+#endif
 
 /** @brief Frame data size. */
-#define FRAME_MAX_DATA_LEN 26
+#define FRAME_MAX_DATA_LEN (FRAME_MAX_LEN - FRAME_STATIC_FIELD_LENGTH - 1)
 
 /** @brief Length of the CRC. */
 #define FRAME_CRC_LEN 2
@@ -74,6 +83,15 @@
  */
 #define FRAME_REQUEST_STATIC_FIELD_SIZE 4
 
+/** @brief Operation codes with their own handler time counters, the rest share the last one. */
+#ifndef SUPER_STATS_OPCODES
+#if defined(__AVR__)
+#define SUPER_STATS_OPCODES 16
+#else
+#define SUPER_STATS_OPCODES 64
+#endif
+#endif
+
 #pragma endregion
 
 #pragma region Headers
@@ -86,6 +104,10 @@
 
 #include "DebugPort.h"
 
+#ifdef SUPER_TRACE
+#include "FrameTrace.h"
+#endif
+
 #pragma endregion
 
 #pragma region Enums
@@ -96,11 +118,34 @@ enum StatusCodes : uint8_t
 	Ok = 1U, ///< When everything is OK.
 	Error, ///< When error occurred.
 	Busy, ///< When busy in other operation.
-	TimeOut ///< Then time for the operation has timed out.
+	TimeOut, ///< Then time for the operation has timed out.
+	OutOfRange, ///< When a target is outside the soft limits.
+	Inhibited, ///< When a pressed stop input refuses the move.
+	BadRequest ///< When the payload length does not fit the opcode.
 };
 
 #pragma endregion
 
+#pragma region Structures
+
+/** @brief Parser counters, as sent by the Stats opcode. */
+typedef struct __attribute__((packed))
+{
+	uint32_t Bytes; ///< Count of the parsed bytes.
+	uint32_t Frames; ///< Count of the dispatched request frames.
+	uint32_t CRCErrors; ///< Count of the frames dropped for bad CRC.
+} SUPERStats_t;
+
+/** @brief Handler time of one operation code, as sent by the Stats opcode. */
+typedef struct __attribute__((packed))
+{
+	uint16_t Count; ///< Count of the calls, saturated.
+	uint16_t TimeMean; ///< Mean handler time in us.
+	uint16_t TimeMax; ///< Longest handler time in us.
+} SUPEROpcodeStats_t;
+
+#pragma endregion
+
 class SUPERClass
 {
 
@@ -109,11 +154,7 @@ class SUPERClass
 #pragma region Enum
 
 	/** @brief Communication state machine states. */
-#if defined(ESP32)
 	enum : uint8_t
-#else
-	typedef enum : uint8_t	
-#endif
 	{
 		fsSentinel = 0U, ///< Beginning byte.
 		fsRequestResponse, ///< Request / Response byte.
@@ -166,6 +207,24 @@ class SUPERClass
 	/** @brief Will store current time that the bus is updated. */
 	unsigned long m_currentMillis;
 
+	/** @brief Parser counters. */
+	SUPERStats_t m_stats;
+
+#ifdef SUPER_OPCODE_STATS
+	/** @brief Count of the handler calls per operation code. */
+	uint16_t m_opcodeCount[SUPER_STATS_OPCODES];
+
+	/** @brief Longest handler time per operation code in us. */
+	uint16_t m_opcodeTimeMax[SUPER_STATS_OPCODES];
+
+	/** @brief Sum of the handler times per operation code in us. */
+	uint32_t m_opcodeTime[SUPER_STATS_OPCODES];
+#endif
+
+#ifdef SUPER_TRACE
+	/** @brief Parser state recorder. */
+	FrameTraceClass m_trace;
+#endif
 
 #pragma endregion
 
@@ -242,6 +301,31 @@ class SUPERClass
 	 */
 	void send_raw_response(uint8_t opcode, uint8_t status, uint8_t * payload, const uint8_t length);
 
+	/** @brief Get the parser counters.
+	 *  @return SUPERStats_t, Counters since the last reset.
+	 */
+	SUPERStats_t get_stats();
+
+#ifdef SUPER_OPCODE_STATS
+	/** @brief Get the handler time of one operation code.
+	 *  @param opcode uint8_t, Operation code, the last slot holds all above it.
+	 *  @return SUPEROpcodeStats_t, Counters since the last reset.
+	 */
+	SUPEROpcodeStats_t get_opcode_stats(uint8_t opcode);
+#endif
+
+	/** @brief Reset the parser and handler counters.
+	 *  @return Void.
+	 */
+	void reset_stats();
+
+#ifdef SUPER_TRACE
+	/** @brief Parser state recorder.
+	 *  @return FrameTraceClass &, Recorder.
+	 */
+	FrameTraceClass & trace();
+#endif
+
 #pragma endregion
 
 };
@@ -0,0 +1,198 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// Seqlock.h
+
+/*
+	Versioned snapshot with a single writer. The writer makes the version
+	odd, copies the value in and makes it even again; a reader copies the
+	value out and retries while the version was odd or changed meanwhile.
+	The writer never waits, so it may run in an ISR or on the other core.
+	A reader must not interrupt the writer, it would spin until the ISR
+	returns. The value is the only copy, the writer reads it in place and
+	publishes a part of it without copying the rest.
+*/
+
+#ifndef _SEQLOCK_h
+#define _SEQLOCK_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+template<typename T>
+class Seqlock
+{
+
+	protected:
+
+#pragma region Definitions
+
+#if defined(__AVR__)
+	/** @brief Version, one byte is the widest single load on AVR. */
+	typedef uint8_t Version_t;
+#else
+	typedef uint32_t Version_t;
+#endif
+
+#pragma endregion
+
+#pragma region Variables
+
+	/** @brief Published value. */
+	T m_value;
+
+	/** @brief Version, odd while the writer copies. */
+	Version_t m_version;
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	Seqlock() : m_version(0)
+	{
+		memset(&m_value, 0, sizeof(T));
+	}
+
+	/** @brief Publish a part of the value, writer side.
+	 *  @param offset size_t, Offset of the part in T.
+	 *  @param data void *, Bytes to copy in.
+	 *  @param length size_t, Length of the part.
+	 *  @return Void.
+	 */
+	void write(size_t offset, const void * data, size_t length)
+	{
+		Version_t VersionL = m_version;
+		const uint8_t * SourceL = (const uint8_t *)data;
+		uint8_t * TargetL = (uint8_t *)&m_value + offset;
+
+		__atomic_store_n(&m_version, (Version_t)(VersionL + 1), __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+
+		// Byte stores, a reader racing the copy is not undefined behaviour.
+		for (size_t index = 0; index < length; index++)
+		{
+			__atomic_store_n(&TargetL[index], SourceL[index], __ATOMIC_RELAXED);
+		}
+
+		__atomic_store_n(&m_version, (Version_t)(VersionL + 2), __ATOMIC_RELEASE);
+	}
+
+	/** @brief Publish a new value, writer side.
+	 *  @param value T, Value to copy in.
+	 *  @return Void.
+	 */
+	void write(const T &value)
+	{
+		write(0, &value, sizeof(T));
+	}
+
+	/** @brief Published value, writer side only, nothing else changes it.
+	 *  @return const T &, Value.
+	 */
+	const T & value() const
+	{
+		return m_value;
+	}
+
+	/** @brief Copy a part of the value out once, reader side.
+	 *  @param offset size_t, Offset of the part in T.
+	 *  @param data void *, Output, valid only on success.
+	 *  @param length size_t, Length of the part.
+	 *  @return bool, False if the writer was busy, try again.
+	 */
+	bool try_read(size_t offset, void * data, size_t length) const
+	{
+		const uint8_t * SourceL = (const uint8_t *)&m_value + offset;
+		uint8_t * TargetL = (uint8_t *)data;
+
+		Version_t BeginL = __atomic_load_n(&m_version, __ATOMIC_ACQUIRE);
+		if ((BeginL & 1) != 0)
+		{
+			return false;
+		}
+
+		for (size_t index = 0; index < length; index++)
+		{
+			TargetL[index] = __atomic_load_n(&SourceL[index], __ATOMIC_RELAXED);
+		}
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		return (BeginL == __atomic_load_n(&m_version, __ATOMIC_RELAXED));
+	}
+
+	/** @brief Copy the value out once, reader side.
+	 *  @param value T, Output, valid only on success.
+	 *  @return bool, False if the writer was busy, try again.
+	 */
+	bool try_read(T &value) const
+	{
+		return try_read(0, &value, sizeof(T));
+	}
+
+	/** @brief Copy a part of the value out, retries until it is not torn.
+	 *  @param offset size_t, Offset of the part in T.
+	 *  @param data void *, Output.
+	 *  @param length size_t, Length of the part.
+	 *  @return uint8_t, Count of the retries.
+	 */
+	uint8_t read(size_t offset, void * data, size_t length) const
+	{
+		uint8_t RetriesL = 0;
+
+		while (try_read(offset, data, length) == false)
+		{
+			if (RetriesL < 0xFF)
+			{
+				RetriesL++;
+			}
+		}
+
+		return RetriesL;
+	}
+
+	/** @brief Copy the value out, retries until it is not torn.
+	 *  @param value T, Output.
+	 *  @return uint8_t, Count of the retries.
+	 */
+	uint8_t read(T &value) const
+	{
+		return read(0, &value, sizeof(T));
+	}
+
+	/** @brief Count of the writes, wraps.
+	 *  @return uint32_t, Count.
+	 */
+	uint32_t version() const
+	{
+		return (uint32_t)(__atomic_load_n(&m_version, __ATOMIC_ACQUIRE) >> 1);
+	}
+
+#pragma endregion
+
+};
+
+#endif
@@ -0,0 +1,248 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "Settings.h"
+
+#pragma region Protected Methods
+
+/** @brief Map the EEPROM where the core needs it.
+ *  @return bool, True if the EEPROM is usable.
+ */
+bool SettingsClass::begin()
+{
+#if defined(ESP32)
+	if (m_begun == false)
+	{
+		m_begun = EEPROM.begin(SETTINGS_ADDRESS + SETTINGS_HEADER_LEN + sizeof(SettingsRecord_t) + SETTINGS_SUM_LEN);
+	}
+
+	return m_begun;
+#else
+	return true;
+#endif
+}
+
+/** @brief Fletcher-16 over a byte run.
+ *  @param data uint8_t *, Bytes.
+ *  @param length uint8_t, Count of the bytes.
+ *  @param sum uint16_t, Sum of the bytes before them.
+ *  @return uint16_t, Sum.
+ */
+uint16_t SettingsClass::checksum(const uint8_t * data, uint8_t length, uint16_t sum)
+{
+	uint8_t LowL = sum & 0xFF;
+	uint8_t HighL = sum >> 8;
+
+	for (uint8_t index = 0; index < length; index++)
+	{
+		LowL = (uint8_t)(((uint16_t)LowL + data[index]) % 255);
+		HighL = (uint8_t)(((uint16_t)HighL + LowL) % 255);
+	}
+
+	return (uint16_t)((HighL << 8) | LowL);
+}
+
+/** @brief Byte of the record fields in RAM.
+ *  @param limits uint8_t *, Limits of the record.
+ *  @param index uint8_t, Offset in SettingsRecord_t.
+ *  @return uint8_t *, Byte in m_settings or in the limits.
+ */
+uint8_t * SettingsClass::field(uint8_t * limits, uint8_t index)
+{
+	if (index < offsetof(SettingsRecord_t, Limits))
+	{
+		return (uint8_t *)&m_settings.UpdateRate + index;
+	}
+
+	if (index < offsetof(SettingsRecord_t, LimitMode))
+	{
+		return limits + (index - offsetof(SettingsRecord_t, Limits));
+	}
+
+	return &m_settings.LimitMode;
+}
+
+#pragma endregion
+
+#pragma region Methods
+
+/**
+ * @brief Construct a new SettingsClass object
+ * 
+ */
+SettingsClass::SettingsClass()
+{
+	memset(&m_settings, 0, sizeof(Settings_t));
+	m_valid = false;
+#if defined(ESP32)
+	m_begun = false;
+#endif
+}
+
+/** @brief Load the record, the defaults if there is no valid one.
+ *  @param limits RobotLimits_t, Output, the limits of the record.
+ *  @return bool, True if a valid record was found.
+ */
+bool SettingsClass::load(RobotLimits_t &limits)
+{
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	uint8_t HeaderL[SETTINGS_HEADER_LEN];
+
+	memset(&m_settings, 0, sizeof(Settings_t));
+	memset(&limits, 0, sizeof(RobotLimits_t));
+	m_valid = false;
+
+	if (begin() == false)
+	{
+		return false;
+	}
+
+	for (uint8_t index = 0; index < SETTINGS_HEADER_LEN; index++)
+	{
+		HeaderL[index] = EEPROM.read(SETTINGS_ADDRESS + index);
+	}
+
+	if ((HeaderL[0] != (SETTINGS_MAGIC & 0xFF)) || (HeaderL[1] != (SETTINGS_MAGIC >> 8)))
+	{
+		return false;
+	}
+
+	// A newer layout than this build knows, leave it alone.
+	uint8_t LengthL = HeaderL[3];
+	if ((HeaderL[2] > SETTINGS_VERSION) || (LengthL > sizeof(SettingsRecord_t)))
+	{
+		return false;
+	}
+
+	// Summed in place, no copy of the record on the stack.
+	uint16_t SumL = checksum(&HeaderL[2], 2, 0);
+	for (uint8_t index = 0; index < LengthL; index++)
+	{
+		uint8_t ByteL = EEPROM.read(SETTINGS_ADDRESS + SETTINGS_HEADER_LEN + index);
+		SumL = checksum(&ByteL, 1, SumL);
+	}
+
+	int SumAddressL = SETTINGS_ADDRESS + SETTINGS_HEADER_LEN + LengthL;
+	uint16_t StoredL = (uint16_t)EEPROM.read(SumAddressL) | ((uint16_t)EEPROM.read(SumAddressL + 1) << 8);
+	if (SumL != StoredL)
+	{
+		return false;
+	}
+
+	for (uint8_t index = 0; index < LengthL; index++)
+	{
+		*field((uint8_t *)&limits, index) = EEPROM.read(SETTINGS_ADDRESS + SETTINGS_HEADER_LEN + index);
+	}
+	m_valid = true;
+
+	return true;
+}
+
+/** @brief Write the record, only the changed cells.
+ *  @param limits RobotLimits_t, Limits to keep, the ones in effect.
+ *  @return bool, True if written.
+ */
+bool SettingsClass::save(const RobotLimits_t &limits)
+{
+#ifdef SHOW_FUNC_NAMES
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+#endif // SHOW_FUNC_NAMES
+
+	const uint8_t LengthL = SETTINGS_HEADER_LEN + sizeof(SettingsRecord_t) + SETTINGS_SUM_LEN;
+	uint8_t HeaderL[SETTINGS_HEADER_LEN] = { SETTINGS_MAGIC & 0xFF, SETTINGS_MAGIC >> 8, SETTINGS_VERSION, sizeof(SettingsRecord_t) };
+	uint16_t SumL = checksum(&HeaderL[2], 2, 0);
+
+	if (begin() == false)
+	{
+		return false;
+	}
+
+	// Streamed cell by cell, the sum runs along and goes last.
+	for (uint8_t index = 0; index < LengthL; index++)
+	{
+		uint8_t ByteL;
+		if (index < SETTINGS_HEADER_LEN)
+		{
+			ByteL = HeaderL[index];
+		}
+		else if (index < (SETTINGS_HEADER_LEN + sizeof(SettingsRecord_t)))
+		{
+			ByteL = *field((uint8_t *)&limits, index - SETTINGS_HEADER_LEN);
+			SumL = checksum(&ByteL, 1, SumL);
+		}
+		else if (index == (SETTINGS_HEADER_LEN + sizeof(SettingsRecord_t)))
+		{
+			ByteL = SumL & 0xFF;
+		}
+		else
+		{
+			ByteL = SumL >> 8;
+		}
+
+		// The cells wear out, skip the ones that hold the value already.
+		if (EEPROM.read(SETTINGS_ADDRESS + index) != ByteL)
+		{
+			EEPROM.write(SETTINGS_ADDRESS + index, ByteL);
+		}
+	}
+
+#if defined(ESP32)
+	if (EEPROM.commit() == false)
+	{
+		return false;
+	}
+#endif
+
+	m_valid = true;
+
+	return true;
+}
+
+/** @brief Settings in RAM, change them and save().
+ *  @return Settings_t, Reference to the settings.
+ */
+Settings_t & SettingsClass::get()
+{
+	return m_settings;
+}
+
+/** @brief Result of the last load().
+ *  @return bool, True if a valid record was found.
+ */
+bool SettingsClass::valid()
+{
+	return m_valid;
+}
+
+#pragma endregion
+
+/**
+ * @brief Settings instance.
+ * 
+ */
+SettingsClass Settings;
@@ -0,0 +1,195 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// Settings.h
+
+/*
+	Settings record in the EEPROM:
+
+	+---------+---------+---------+--------+------------+---------+---------+
+	| Byte 0  | Byte 1  | Byte 2  | Byte 3 | Byte 4 ... | N + 4   | N + 5   |
+	+---------+---------+---------+--------+------------+---------+---------+
+	| Magic L | Magic H | Version | Length | Fields     | Sum L   | Sum H   |
+	+---------+---------+---------+--------+------------+---------+---------+
+
+	Fields is SettingsRecord_t, Length is its size in the build that wrote
+	the record. New fields go at the end, an older record loads into the
+	front and the rest keeps the defaults. The sum is Fletcher-16 over
+	Version, Length and the fields.
+
+	The limits are not kept in RAM here, the robot holds the only copy.
+	load() and save() take them from the caller.
+*/
+
+#ifndef _SETTINGS_h
+#define _SETTINGS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <EEPROM.h>
+
+#include "DebugPort.h"
+
+#include "AxisLimits.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/**
+ * @brief Address of the record in the EEPROM.
+ * 
+ */
+#ifndef SETTINGS_ADDRESS
+#define SETTINGS_ADDRESS 0
+#endif
+
+/** @brief Marks a written record, "RK". */
+#define SETTINGS_MAGIC 0x4B52
+
+/** @brief Version of the record layout. */
+#define SETTINGS_VERSION 1
+
+/** @brief Length of magic, version and length. */
+#define SETTINGS_HEADER_LEN 4
+
+/** @brief Length of the sum. */
+#define SETTINGS_SUM_LEN 2
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Fields of the record in the EEPROM, zero means not set. */
+typedef struct __attribute__((packed))
+{
+	uint32_t UpdateRate; ///< Bus slot period in us.
+	RobotLimits_t Limits; ///< Kinematic limits of the axes.
+	uint8_t LimitMode; ///< LimitModes value for moves outside the soft limits.
+} SettingsRecord_t;
+
+/** @brief Persisted settings in RAM, the record fields but the limits. */
+typedef struct __attribute__((packed))
+{
+	uint32_t UpdateRate; ///< Bus slot period in us.
+	uint8_t LimitMode; ///< LimitModes value for moves outside the soft limits.
+} Settings_t;
+
+#pragma endregion
+
+class SettingsClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/**
+	 * @brief Settings in RAM.
+	 * 
+	 */
+	Settings_t m_settings;
+
+	/**
+	 * @brief The last load() found a valid record.
+	 * 
+	 */
+	bool m_valid;
+
+#if defined(ESP32)
+	/**
+	 * @brief The flash backed EEPROM is mapped.
+	 * 
+	 */
+	bool m_begun;
+#endif
+
+#pragma endregion
+
+#pragma region Protected Methods
+
+	/** @brief Map the EEPROM where the core needs it.
+	 *  @return bool, True if the EEPROM is usable.
+	 */
+	bool begin();
+
+	/** @brief Fletcher-16 over a byte run.
+	 *  @param data uint8_t *, Bytes.
+	 *  @param length uint8_t, Count of the bytes.
+	 *  @param sum uint16_t, Sum of the bytes before them.
+	 *  @return uint16_t, Sum.
+	 */
+	static uint16_t checksum(const uint8_t * data, uint8_t length, uint16_t sum);
+
+	/** @brief Byte of the record fields in RAM.
+	 *  @param limits uint8_t *, Limits of the record.
+	 *  @param index uint8_t, Offset in SettingsRecord_t.
+	 *  @return uint8_t *, Byte in m_settings or in the limits.
+	 */
+	uint8_t * field(uint8_t * limits, uint8_t index);
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	SettingsClass();
+
+	/** @brief Load the record, the defaults if there is no valid one.
+	 *  @param limits RobotLimits_t, Output, the limits of the record.
+	 *  @return bool, True if a valid record was found.
+	 */
+	bool load(RobotLimits_t &limits);
+
+	/** @brief Write the record, only the changed cells.
+	 *  @param limits RobotLimits_t, Limits to keep, the ones in effect.
+	 *  @return bool, True if written.
+	 */
+	bool save(const RobotLimits_t &limits);
+
+	/** @brief Settings in RAM, change them and save().
+	 *  @return Settings_t, Reference to the settings.
+	 */
+	Settings_t & get();
+
+	/** @brief Result of the last load().
+	 *  @return bool, True if a valid record was found.
+	 */
+	bool valid();
+
+#pragma endregion
+
+};
+
+/**
+ * @brief Settings instance.
+ * 
+ */
+extern SettingsClass Settings;
+
+#endif
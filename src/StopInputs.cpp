@@ -0,0 +1,178 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+#include "StopInputs.h"
+
+#pragma region Methods
+
+/**
+ * @brief Construct a new StopInputsClass object
+ * 
+ */
+StopInputsClass::StopInputsClass()
+{
+	m_pending = 0;
+	m_at = 0;
+	m_served = 0;
+	m_active = 0;
+	m_attached = 0;
+	reset_stats();
+}
+
+/** @brief Latch an edge, call it from the ISR of the input.
+ *  @param axes uint8_t, Axes the input stops.
+ *  @return Void.
+ */
+void StopInputsClass::latch(uint8_t axes)
+{
+	// The first edge times the trigger, the motion context reads it only while bits are pending.
+	if (__atomic_load_n(&m_pending, __ATOMIC_ACQUIRE) == 0)
+	{
+		m_at = micros();
+	}
+	__atomic_fetch_or(&m_pending, axes, __ATOMIC_RELEASE);
+}
+
+/** @brief Attach an input, its moves stay refused while it is pressed.
+ *  @param input uint8_t, Input, below STOP_INPUTS_COUNT.
+ *  @param pin uint8_t, Pin of the input.
+ *  @param level uint8_t, Level of the pressed input.
+ *  @param axes uint8_t, Axes the input stops.
+ *  @param direction int8_t, Direction of the refused moves, 0 for both.
+ *  @return bool, False on a wrong input.
+ */
+bool StopInputsClass::attach(uint8_t input, uint8_t pin, uint8_t level, uint8_t axes, int8_t direction)
+{
+	if (input >= STOP_INPUTS_COUNT)
+	{
+		return false;
+	}
+
+	m_pin[input] = pin;
+	m_level[input] = level;
+	m_axes[input] = axes;
+	m_direction[input] = direction;
+	m_attached |= (1U << input);
+
+	return true;
+}
+
+/** @brief Latch an edge of an attached input and keep it active, call it from the ISR.
+ *  @param input uint8_t, Input.
+ *  @return Void.
+ */
+void StopInputsClass::latch_input(uint8_t input)
+{
+	if ((input >= STOP_INPUTS_COUNT) || (bitRead(m_attached, input) == 0))
+	{
+		return;
+	}
+
+	__atomic_fetch_or(&m_active, (uint8_t)(1U << input), __ATOMIC_RELEASE);
+	latch(m_axes[input]);
+}
+
+/** @brief Read the attached inputs, the released ones stop being active.
+ *  @param direction int8_t, Direction of the move, 0 for any.
+ *  @return uint8_t, Axes that must not move in the direction.
+ */
+uint8_t StopInputsClass::inhibited(int8_t direction)
+{
+	uint8_t AxesL = 0;
+
+	for (uint8_t input = 0; input < STOP_INPUTS_COUNT; input++)
+	{
+		if (bitRead(m_attached, input) == 0)
+		{
+			continue;
+		}
+
+		// Held at the start or between edges counts as well as a latched edge.
+		if (digitalRead(m_pin[input]) == m_level[input])
+		{
+			__atomic_fetch_or(&m_active, (uint8_t)(1U << input), __ATOMIC_RELEASE);
+		}
+		else
+		{
+			__atomic_fetch_and(&m_active, (uint8_t)~(1U << input), __ATOMIC_ACQ_REL);
+			continue;
+		}
+
+		if ((m_direction[input] == 0) || (direction == 0) || (m_direction[input] == direction))
+		{
+			AxesL |= m_axes[input];
+		}
+	}
+
+	return AxesL;
+}
+
+/** @brief Axes waiting to be stopped.
+ *  @return uint8_t, Mask.
+ */
+uint8_t StopInputsClass::pending()
+{
+	return __atomic_load_n(&m_pending, __ATOMIC_ACQUIRE);
+}
+
+/** @brief The axis has stopped, the last one of the trigger takes the latency.
+ *  @param axis uint8_t, Axis.
+ *  @return Void.
+ */
+void StopInputsClass::served(uint8_t axis)
+{
+	// Read before the bit goes, a new edge may time the next trigger then.
+	unsigned long AtL = m_at;
+
+	m_served |= (1U << axis);
+	if (__atomic_and_fetch(&m_pending, (uint8_t)~(1U << axis), __ATOMIC_ACQ_REL) != 0)
+	{
+		return;
+	}
+
+	uint32_t LatencyL = (uint32_t)(micros() - AtL);
+	m_stats.Count++;
+	m_stats.Axes = m_served;
+	m_stats.LastLatency = LatencyL;
+	if (LatencyL > m_stats.MaxLatency)
+	{
+		m_stats.MaxLatency = LatencyL;
+	}
+	m_served = 0;
+}
+
+/** @brief Latency counters.
+ *  @return StopStats_t, Counters since the last reset.
+ */
+StopStats_t StopInputsClass::get_stats()
+{
+	return m_stats;
+}
+
+/** @brief Reset the latency counters.
+ *  @return Void.
+ */
+void StopInputsClass::reset_stats()
+{
+	memset(&m_stats, 0, sizeof(StopStats_t));
+}
+
+#pragma endregion
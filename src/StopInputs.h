@@ -0,0 +1,187 @@
+/*
+	Copyright (c) [2019] [Orlin Dimitrov]
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+*/
+
+// StopInputs.h
+
+#ifndef _STOPINPUTS_h
+#define _STOPINPUTS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Definitions
+
+/**
+ * @brief Inputs attach() takes.
+ * 
+ */
+#ifndef STOP_INPUTS_COUNT
+#define STOP_INPUTS_COUNT 4
+#endif
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Trigger to stop latency of the stop inputs, as sent by the Stats opcode. */
+typedef struct __attribute__((packed))
+{
+	uint16_t Count; ///< Triggers served since the reset.
+	uint8_t Axes; ///< Axes stopped by the last trigger.
+	uint32_t LastLatency; ///< Edge to the last axis stopped of the last trigger in us.
+	uint32_t MaxLatency; ///< Longest latency since the reset in us.
+} StopStats_t;
+
+#pragma endregion
+
+class StopInputsClass
+{
+
+	protected:
+
+#pragma region Variables
+
+	/**
+	 * @brief Axes to stop, the ISR sets the bits, the motion context clears them.
+	 * 
+	 */
+	volatile uint8_t m_pending;
+
+	/**
+	 * @brief Time of the first edge of the pending trigger.
+	 * 
+	 */
+	volatile unsigned long m_at;
+
+	/**
+	 * @brief Axes served of the pending trigger.
+	 * 
+	 */
+	uint8_t m_served;
+
+	/**
+	 * @brief Latency counters.
+	 * 
+	 */
+	StopStats_t m_stats;
+
+	/**
+	 * @brief Inputs that stay active until a level read finds them released, bit N is input N.
+	 * 
+	 */
+	volatile uint8_t m_active;
+
+	/**
+	 * @brief Attached inputs, bit N is input N.
+	 * 
+	 */
+	uint8_t m_attached;
+
+	/**
+	 * @brief Pin of every input.
+	 * 
+	 */
+	uint8_t m_pin[STOP_INPUTS_COUNT];
+
+	/**
+	 * @brief Level of the pressed input.
+	 * 
+	 */
+	uint8_t m_level[STOP_INPUTS_COUNT];
+
+	/**
+	 * @brief Axes every input stops.
+	 * 
+	 */
+	uint8_t m_axes[STOP_INPUTS_COUNT];
+
+	/**
+	 * @brief Direction of the moves an input refuses, 0 refuses both.
+	 * 
+	 */
+	int8_t m_direction[STOP_INPUTS_COUNT];
+
+#pragma endregion
+
+	public:
+
+#pragma region Methods
+
+	StopInputsClass();
+
+	/** @brief Latch an edge, call it from the ISR of the input.
+	 *  @param axes uint8_t, Axes the input stops.
+	 *  @return Void.
+	 */
+	void latch(uint8_t axes);
+
+	/** @brief Attach an input, its moves stay refused while it is pressed.
+	 *  An e-stop refuses both directions, a limit switch only the moves toward it.
+	 *  @param input uint8_t, Input, below STOP_INPUTS_COUNT.
+	 *  @param pin uint8_t, Pin of the input.
+	 *  @param level uint8_t, Level of the pressed input.
+	 *  @param axes uint8_t, Axes the input stops.
+	 *  @param direction int8_t, Direction of the refused moves, 0 for both.
+	 *  @return bool, False on a wrong input.
+	 */
+	bool attach(uint8_t input, uint8_t pin, uint8_t level, uint8_t axes, int8_t direction = 0);
+
+	/** @brief Latch an edge of an attached input and keep it active, call it from the ISR.
+	 *  @param input uint8_t, Input.
+	 *  @return Void.
+	 */
+	void latch_input(uint8_t input);
+
+	/** @brief Read the attached inputs, the released ones stop being active.
+	 *  @param direction int8_t, Direction of the move, 0 for any.
+	 *  @return uint8_t, Axes that must not move in the direction.
+	 */
+	uint8_t inhibited(int8_t direction);
+
+	/** @brief Axes waiting to be stopped.
+	 *  @return uint8_t, Mask.
+	 */
+	uint8_t pending();
+
+	/** @brief The axis has stopped, the last one of the trigger takes the latency.
+	 *  @param axis uint8_t, Axis.
+	 *  @return Void.
+	 */
+	void served(uint8_t axis);
+
+	/** @brief Latency counters.
+	 *  @return StopStats_t, Counters since the last reset.
+	 */
+	StopStats_t get_stats();
+
+	/** @brief Reset the latency counters.
+	 *  @return Void.
+	 */
+	void reset_stats();
+
+#pragma endregion
+
+};
+
+#endif